@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rgb2yuv.dir/rgb2yuv_main.cpp.o"
+  "CMakeFiles/rgb2yuv.dir/rgb2yuv_main.cpp.o.d"
+  "rgb2yuv"
+  "rgb2yuv.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rgb2yuv.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rgb2yuv_converter_test.dir/rgb2yuv_converter_test.cpp.o"
+  "CMakeFiles/rgb2yuv_converter_test.dir/rgb2yuv_converter_test.cpp.o.d"
+  "rgb2yuv_converter_test"
+  "rgb2yuv_converter_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rgb2yuv_converter_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
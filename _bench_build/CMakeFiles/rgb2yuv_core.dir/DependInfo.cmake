@@ -0,0 +1,34 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/rgb2yuv.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv.cpp.o.d"
+  "/root/repo/rgb2yuv_async.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_async.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_async.cpp.o.d"
+  "/root/repo/rgb2yuv_cache.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_cache.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_cache.cpp.o.d"
+  "/root/repo/rgb2yuv_converter.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter.cpp.o.d"
+  "/root/repo/rgb2yuv_converter_avx2.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx2.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx2.cpp.o.d"
+  "/root/repo/rgb2yuv_converter_avx512.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx512.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx512.cpp.o.d"
+  "/root/repo/rgb2yuv_converter_scalar.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_scalar.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_scalar.cpp.o.d"
+  "/root/repo/rgb2yuv_converter_sse41.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_sse41.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_sse41.cpp.o.d"
+  "/root/repo/rgb2yuv_decoder.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_decoder.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_decoder.cpp.o.d"
+  "/root/repo/rgb2yuv_encoder.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_encoder.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_encoder.cpp.o.d"
+  "/root/repo/rgb2yuv_executor.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_executor.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_executor.cpp.o.d"
+  "/root/repo/rgb2yuv_frame_buffer.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_frame_buffer.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_frame_buffer.cpp.o.d"
+  "/root/repo/rgb2yuv_stats.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_stats.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_stats.cpp.o.d"
+  "/root/repo/rgb2yuv_thread_pool.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_thread_pool.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_thread_pool.cpp.o.d"
+  "/root/repo/rgb2yuv_utils.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils.cpp.o.d"
+  "/root/repo/rgb2yuv_utils_asm_gcc.cpp" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils_asm_gcc.cpp.o" "gcc" "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils_asm_gcc.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,41 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_async.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_async.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_cache.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_cache.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx2.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx2.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx512.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_avx512.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_scalar.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_scalar.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_sse41.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_converter_sse41.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_decoder.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_decoder.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_encoder.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_encoder.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_executor.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_executor.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_frame_buffer.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_frame_buffer.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_stats.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_stats.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_thread_pool.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_thread_pool.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils.cpp.o.d"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils_asm_gcc.cpp.o"
+  "CMakeFiles/rgb2yuv_core.dir/rgb2yuv_utils_asm_gcc.cpp.o.d"
+  "librgb2yuv_core.a"
+  "librgb2yuv_core.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rgb2yuv_core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
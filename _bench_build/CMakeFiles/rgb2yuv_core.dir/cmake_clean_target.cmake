@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "librgb2yuv_core.a"
+)
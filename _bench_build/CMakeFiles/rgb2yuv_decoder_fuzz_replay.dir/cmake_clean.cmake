@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rgb2yuv_decoder_fuzz_replay.dir/rgb2yuv_decoder_fuzz.cpp.o"
+  "CMakeFiles/rgb2yuv_decoder_fuzz_replay.dir/rgb2yuv_decoder_fuzz.cpp.o.d"
+  "rgb2yuv_decoder_fuzz_replay"
+  "rgb2yuv_decoder_fuzz_replay.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rgb2yuv_decoder_fuzz_replay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
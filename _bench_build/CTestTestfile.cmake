@@ -0,0 +1,10 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_bench_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(rgb2yuv_converter_test "/root/repo/_bench_build/rgb2yuv_converter_test")
+set_tests_properties(rgb2yuv_converter_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;97;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(rgb2yuv_decoder_fuzz_replay "/root/repo/_bench_build/rgb2yuv_decoder_fuzz_replay")
+set_tests_properties(rgb2yuv_decoder_fuzz_replay PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;102;add_test;/root/repo/CMakeLists.txt;0;")
@@ -18,61 +18,301 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <thread>
 
 #include "rgb2yuv.hpp"
+#include "rgb2yuv_cache.hpp"
+#include "rgb2yuv_converter.hpp"
 #include "rgb2yuv_decoder.hpp"
+#include "rgb2yuv_encoder.hpp"
+#include "rgb2yuv_metrics.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+#include "rgb2yuv_tuner.hpp"
 #include "rgb2yuv_utils.hpp"
 #include "rgb2yuv_utils_asm.hpp"
 
 namespace rgb2yuv
 {
 
-void Context::init()
+void Context::querySimdSupport() noexcept
 {
-    // TODO
+    constexpr std::uint32_t leafFeatures { 1U };
+    constexpr std::uint32_t leafExtendedFeatures { 7U };
+    constexpr std::uint64_t xcr0YmmState { 0x6U }; // XMM | YMM
+    constexpr std::uint64_t xcr0ZmmState { 0xE6U }; // XMM | YMM | opmask | ZMM_Hi256 | Hi16_ZMM
+    std::array<std::uint32_t, utils_asm::ct_numCpuIdRegisters> regs { };
+
+    utils_asm::cpuId(0U, 0U, regs);
+    const std::uint32_t maxLeaf { regs[utils_asm::ct_eax] };
+    if (maxLeaf < leafFeatures) {
+        return;
+    }
+
+    utils_asm::cpuId(leafFeatures, 0U, regs);
+    const std::uint32_t ecx { regs[utils_asm::ct_ecx] };
+    const std::uint32_t edx { regs[utils_asm::ct_edx] };
+    m_supportsMMX = (edx & (1U << 23U)) != 0U;
+    m_supportsSSE = ((ecx & (1U << 9U)) != 0U) && ((ecx & (1U << 19U)) != 0U);
+
+    const bool osxsave { (ecx & (1U << 27U)) != 0U };
+    const std::uint64_t xcr0 { osxsave ? utils_asm::getXcr0() : 0U };
+    m_supportsAVX = ((ecx & (1U << 28U)) != 0U) && ((xcr0 & xcr0YmmState) == xcr0YmmState);
+    if (!m_supportsAVX || (maxLeaf < leafExtendedFeatures)) {
+        return;
+    }
+
+    utils_asm::cpuId(leafExtendedFeatures, 0U, regs);
+    const std::uint32_t ebx { regs[utils_asm::ct_ebx] };
+    m_supportsAVX2 = (ebx & (1U << 5U)) != 0U;
+    m_supportsAVX512 = ((ebx & (1U << 16U)) != 0U) && ((ebx & (1U << 30U)) != 0U) &&
+                       ((xcr0 & xcr0ZmmState) == xcr0ZmmState);
 }
 
-Context::~Context()
+void Context::queryCacheSize() noexcept
 {
-    // TODO
+    constexpr std::uint32_t leafCacheParameters { 4U };
+    constexpr std::uint32_t leafExtendedCacheParameters { 0x8000001DU };
+    constexpr std::uint32_t maxSubleaves { 16U };
+    std::array<std::uint32_t, utils_asm::ct_numCpuIdRegisters> regs { };
+    std::uint32_t maxLevel { 0U };
+
+    // Both leaves share the layout of the deterministic cache parameters
+    const auto enumerateCaches = [&](const std::uint32_t leaf)
+    {
+        for (std::uint32_t subleaf { 0U }; subleaf < maxSubleaves; ++subleaf)
+        {
+            utils_asm::cpuId(leaf, subleaf, regs);
+            const std::uint32_t type { regs[utils_asm::ct_eax] & 0x1FU };
+            if (type == 0U) {
+                break;
+            }
+
+            // Skip instruction caches
+            const std::uint32_t level { (regs[utils_asm::ct_eax] >> 5U) & 0x7U };
+            if ((type == 2U) || (level < maxLevel)) {
+                continue;
+            }
+
+            const std::uint32_t ebx { regs[utils_asm::ct_ebx] };
+            const std::size_t ways { ((ebx >> 22U) & 0x3FFU) + 1U };
+            const std::size_t partitions { ((ebx >> 12U) & 0x3FFU) + 1U };
+            const std::size_t lineSize { (ebx & 0xFFFU) + 1U };
+            const std::size_t sets { static_cast<std::size_t>(regs[utils_asm::ct_ecx]) + 1U };
+            maxLevel = level;
+            m_lastLevelCacheSize = ways * partitions * lineSize * sets;
+        }
+    };
+
+    utils_asm::cpuId(0U, 0U, regs);
+    if (regs[utils_asm::ct_eax] >= leafCacheParameters) {
+        enumerateCaches(leafCacheParameters);
+    }
+
+    if (m_lastLevelCacheSize == 0U) {
+        utils_asm::cpuId(0x80000000U, 0U, regs);
+        if (regs[utils_asm::ct_eax] >= leafExtendedCacheParameters) {
+            enumerateCaches(leafExtendedCacheParameters);
+        }
+    }
 }
 
-void Context::deinit()
+void Context::init()
 {
-    // TODO
+    querySimdSupport();
+    queryCacheSize();
+    m_simdTier = m_inputArgs.disableSimd ? utils::SimdTier::scalar : getWidestSimdTier();
+    m_stats.setSimdTier(m_simdTier);
+
+    std::uint32_t numThreads { (m_inputArgs.numThreads > 0U) ? m_inputArgs.numThreads :
+                                                               std::thread::hardware_concurrency() };
+    // Without a known cache size the output is always written with regular stores
+    std::size_t streamingThreshold { (m_lastLevelCacheSize != 0U) ? m_lastLevelCacheSize :
+                                                                    std::numeric_limits<std::size_t>::max() };
+    std::uint32_t bandRows { 0U };
+    if (m_inputArgs.autoTune) {
+        const Tuner tuner(m_inputArgs.tuneFile.empty() ? Tuner::getDefaultTuneFile() : m_inputArgs.tuneFile, m_simdTier,
+                          m_inputArgs.inputColorFormat, m_inputArgs.outputColorFormat, m_lastLevelCacheSize);
+        const Tuner::Settings settings { tuner.getSettings() };
+        // An explicit -j still wins over the calibrated number of workers
+        numThreads = (m_inputArgs.numThreads > 0U) ? m_inputArgs.numThreads : settings.numThreads;
+        streamingThreshold = settings.streamingThreshold;
+        bandRows = settings.bandRows;
+    }
+    m_threadPool = new ThreadPool(numThreads, m_inputArgs.numaAware);
+
+    // Prefaulting would place every page on the NUMA node of this thread instead of the worker writing it
+    setFramePageConfig({ m_inputArgs.hugePages, m_inputArgs.hugePages && !m_inputArgs.numaAware });
+
+    m_decoder = new Decoder(m_inputArgs.inputFile, m_inputArgs.inputFileFormat, m_inputArgs.inputColorFormat,
+                            m_inputArgs.width, m_inputArgs.height, m_threadPool);
+    m_decoder->init();
+
+    m_converter = new Converter(m_inputArgs.inputColorFormat, m_inputArgs.outputColorFormat, m_inputArgs.colorMatrix,
+                                m_simdTier, *m_threadPool, streamingThreshold,
+                                std::max(1U, m_inputArgs.pyramidLevels), m_inputArgs.alphaMode,
+                                m_inputArgs.background, m_inputArgs.chromaFilter, bandRows);
+    m_converter->init();
+
+    if (!m_inputArgs.cacheDir.empty()) {
+        const std::uint64_t sizeLimit { (m_inputArgs.cacheSizeLimit != 0U) ? m_inputArgs.cacheSizeLimit :
+                                                                             ConversionCache::ct_defaultSizeLimit };
+        m_cache = new ConversionCache(m_inputArgs.cacheDir, sizeLimit);
+        m_cache->init();
+    }
+
+    m_encoder = new Encoder(m_inputArgs.outputFile, m_inputArgs.outputFileFormat, m_inputArgs.outputColorFormat);
+    m_encoder->init();
 }
 
-} // namespace rgb2yuv
+void Context::run()
+{
+    std::string cacheKey { };
+    bool isCacheHit { false };
+    if (m_cache != nullptr) {
+        Stats::ScopedStage stage(m_stats, Stage::decode);
+        const std::vector<std::uint8_t> &fileData { m_decoder->read() };
+        cacheKey = ConversionCache::makeKey(fileData.data(), fileData.size(), m_inputArgs);
+        m_encoder->deinit();
+        isCacheHit = m_cache->fetch(cacheKey, m_inputArgs.outputFile);
+        if (!isCacheHit) {
+            m_encoder->init();
+        }
+    }
+
+    if (!isCacheHit) {
+        if (m_inputArgs.sequence) {
+            convertSequence();
+        } else {
+            FrameBuffer *decodedData { nullptr };
+            {
+                Stats::ScopedStage stage(m_stats, Stage::decode);
+                const std::vector<std::uint8_t> &fileData { m_decoder->read() };
+                decodedData = &m_decoder->decode(fileData.data(), fileData.size());
+            }
+            m_stats.addVolume(Stage::decode, decodedData->size(),
+                              static_cast<std::uint64_t>(m_decoder->getWidth()) * m_decoder->getHeight());
+            convertAndEncode(*decodedData);
+        }
+
+        if (m_cache != nullptr) {
+            m_cache->store(cacheKey, m_inputArgs.outputFile);
+        }
+    }
+    m_stats.setThreadRecords(*m_threadPool);
+
+    if (m_inputArgs.enableStats) {
+        std::cerr << m_stats.format(m_inputArgs.statsFormat) << std::endl;
+    }
 
-int main(int argc, char **argv)
+    if (!m_inputArgs.metricsFile.empty()) {
+        Metrics::getInstance().dump(m_inputArgs.metricsFile);
+    }
+}
+
+void Context::convertSequence()
 {
+    std::uint32_t numFrames { 0U };
+    {
+        Stats::ScopedStage stage(m_stats, Stage::decode);
+        numFrames = m_decoder->decodeSequence();
+    }
+
+    const std::uint32_t width { m_decoder->getWidth() };
+    const std::uint32_t height { m_decoder->getHeight() };
+    const std::uint64_t numPixels { static_cast<std::uint64_t>(width) * height };
+    const std::size_t srcStride { static_cast<std::size_t>(width) *
+                                  Converter::getBytesPerPixel(m_inputArgs.inputColorFormat) };
+    const std::size_t frameSize { srcStride * height };
+    m_stats.addVolume(Stage::decode, frameSize * numFrames, numPixels * numFrames);
 
-    // Debug code for testing.
-    // TODO: Remove in final version
-#if 0
-    try
+    for (std::uint32_t frameIdx { 0U }; frameIdx < numFrames; ++frameIdx)
     {
-        const rgb2yuv::utils::InputArguments args { rgb2yuv::utils::InputParser::parseAndVerifyArgs(argc, argv) };
-        rgb2yuv::Decoder decoder(args.inputFile, args.inputFileFormat, args.inputColorFormat);
-        decoder.init();
-        auto decodedData { decoder.decode() };
-        auto outputStream { std::fstream(args.outputFile, std::ios::out | std::ios::binary) };
-        if (!outputStream.is_open()) {
-            throw std::invalid_argument("Failed to create output file");
+        FrameBuffer *convertedData { nullptr };
+        {
+            Stats::ScopedStage stage(m_stats, Stage::convert);
+            const std::uint8_t *frame { m_decoder->getFrame(frameIdx) };
+            convertedData = (frameIdx == 0U) ?
+                            &m_converter->convert(frame, srcStride, width, height) :
+                            &m_converter->convertDirty(frame, m_decoder->getFrame(frameIdx - 1U), srcStride, width, height);
         }
-        for (const uint8_t value : decodedData) {
-            outputStream << value;
+        m_stats.addVolume(Stage::convert, frameSize + convertedData->size(), numPixels);
+
+        {
+            Stats::ScopedStage stage(m_stats, Stage::encode);
+            m_encoder->encode(*convertedData, width, height);
         }
-        decoder.deinit();
+        m_stats.addVolume(Stage::encode, convertedData->size(), numPixels);
     }
-    catch (std::invalid_argument& e)
+}
+
+void Context::convertAndEncode(const FrameBuffer &decodedData)
+{
+    const std::uint32_t width { m_decoder->getWidth() };
+    const std::uint32_t height { m_decoder->getHeight() };
+    const std::uint64_t numPixels { static_cast<std::uint64_t>(width) * height };
+
+    // Prefaulted output pages are faulted in here rather than in the convert stage
+    m_converter->allocate(width, height);
+
+    FrameBuffer *convertedData { nullptr };
+    {
+        Stats::ScopedStage stage(m_stats, Stage::convert);
+        const std::size_t srcStride { static_cast<std::size_t>(width) *
+                                      Converter::getBytesPerPixel(m_inputArgs.inputColorFormat) };
+        convertedData = &m_converter->convert(decodedData.data(), srcStride, width, height);
+    }
+    m_stats.addVolume(Stage::convert, decodedData.size() + convertedData->size(), numPixels);
+
+    std::size_t encodedSize { convertedData->size() };
     {
-        std::cerr << "rgb2yuv: FATAL EXCEPTION: " << e.what() << std::endl;
-        return -1;
+        Stats::ScopedStage stage(m_stats, Stage::encode);
+        m_encoder->encode(*convertedData, width, height);
+        const std::vector<FrameBuffer> &pyramid { m_converter->getPyramid() };
+        if (!pyramid.empty()) {
+            m_encoder->encodeLevels(pyramid, width, height);
+        }
+        for (const FrameBuffer &level : pyramid)
+        {
+            encodedSize += level.size();
+        }
+    }
+    m_stats.addVolume(Stage::encode, encodedSize, numPixels);
+}
+
+Context::~Context()
+{
+    deinit();
+}
+
+void Context::deinit()
+{
+    if (m_encoder != nullptr) {
+        m_encoder->deinit();
+        delete m_encoder;
+        m_encoder = nullptr;
     }
-#endif
-    return 0;
+
+    if (m_converter != nullptr) {
+        m_converter->deinit();
+        delete m_converter;
+        m_converter = nullptr;
+    }
+
+    if (m_decoder != nullptr) {
+        m_decoder->deinit();
+        delete m_decoder;
+        m_decoder = nullptr;
+    }
+
+    delete m_threadPool;
+    m_threadPool = nullptr;
+
+    delete m_cache;
+    m_cache = nullptr;
 }
 
+} // namespace rgb2yuv
@@ -20,34 +20,119 @@
 
 #pragma once
 
+#include <cstddef>
+
+#include "rgb2yuv_frame_buffer.hpp"
+#include "rgb2yuv_stats.hpp"
 #include "rgb2yuv_utils.hpp"
 
 namespace rgb2yuv
 {
 
 // Forward declare few classes
+class ConversionCache;
 class Converter;
 class Decoder;
 class Encoder;
+class ThreadPool;
 
 class Context
 {
     private:
-    const bool m_supportsSSE { false }; ///< Status of SSE support on CPU (TODO)
-    const bool m_supportsMMX { false }; ///< Status of MMX support on CPU (TODO)
-    const bool m_supportsAVX { false }; ///< Status of AVX support on CPU (TODO)
-    const bool m_supportsAVX2 { false }; ///< Status of AVX2 support on CPU (TODO
-    const bool m_supportsAVX512 { false }; ///< Status of AVX512 support on CPU (TODO)
+    bool m_supportsSSE { false }; ///< Status of SSE4.1 (and SSSE3) support on CPU
+    bool m_supportsMMX { false }; ///< Status of MMX support on CPU
+    bool m_supportsAVX { false }; ///< Status of AVX support on CPU and OS
+    bool m_supportsAVX2 { false }; ///< Status of AVX2 support on CPU and OS
+    bool m_supportsAVX512 { false }; ///< Status of AVX512F and AVX512BW support on CPU and OS
+    utils::SimdTier m_simdTier { utils::SimdTier::scalar }; ///< SIMD tier selected for conversion
+    std::size_t m_lastLevelCacheSize { 0U }; ///< Size in bytes of the last level cache, 0 if unknown
     const utils::InputArguments m_inputArgs; ///< Input arguments to rgb2yuv
+    Stats m_stats { }; ///< Per-stage timing and throughput statistics
+    ThreadPool *m_threadPool { nullptr }; ///< Pointer to the @ref rgb2yuv::ThreadPool used for conversion
     Converter *m_converter { nullptr }; ///< Pointer to a @ref rgb2yuv::Converter instance
     Decoder *m_decoder { nullptr }; ///< Pointer to a @ref rgb2yuv::Decoder instance
     Encoder *m_encoder { nullptr }; ///< Pointer to a @ref rgb2yuv::Encoder instance
+    ConversionCache *m_cache { nullptr }; ///< Pointer to a @ref rgb2yuv::ConversionCache instance, if enabled
+
+    ///
+    /// @brief Converts and encodes the decoded image
+    ///
+    /// Design: Invoke @ref rgb2yuv::Converter::allocate, then run each of convert and encode within a
+    ///         @ref Stats::ScopedStage and record the bytes and pixels processed. Every pyramid level
+    ///         produced by @ref rgb2yuv::Converter::convert is encoded with @ref rgb2yuv::Encoder::encodeLevels
+    ///         in the same encode stage.
+    ///
+    void convertAndEncode(const FrameBuffer &decodedData);
+
+    ///
+    /// @brief Decodes, converts and encodes a sequence of frames
+    ///
+    /// Design:
+    /// -# Invoke @ref rgb2yuv::Decoder::decodeSequence within a @ref Stats::ScopedStage
+    /// -# Convert the first frame with @ref rgb2yuv::Converter::convert and every further frame with
+    ///    @ref rgb2yuv::Converter::convertDirty against its predecessor
+    /// -# Encode every converted frame, appending it to the output file
+    ///
+    void convertSequence();
 
     public:
+    ///
+    /// @brief Queries the SIMD extensions supported by the CPU and the OS
+    ///
+    /// Design:
+    /// -# Invoke @ref utils_asm::cpuId with leaf 1 and set @ref Context::m_supportsMMX and
+    ///    @ref Context::m_supportsSSE (SSSE3 and SSE4.1)
+    /// -# If OSXSAVE is reported, read XCR0 with @ref utils_asm::getXcr0 to check that the OS
+    ///    preserves YMM (and ZMM) state
+    /// -# Invoke @ref utils_asm::cpuId with leaf 7 and set @ref Context::m_supportsAVX2 and
+    ///    @ref Context::m_supportsAVX512 (AVX512F and AVX512BW)
+    ///
+    void querySimdSupport() noexcept;
+
+    ///
+    /// @brief Queries the size of the last level cache
+    ///
+    /// Design:
+    /// -# Enumerate the deterministic cache parameters with @ref utils_asm::cpuId leaf 4 (Intel), or
+    ///    leaf 0x8000001D if leaf 4 reports no caches (AMD)
+    /// -# Compute the size of every data or unified cache as ways * partitions * line size * sets
+    /// -# Store the size of the highest level cache in @ref Context::m_lastLevelCacheSize
+    ///
+    void queryCacheSize() noexcept;
+
+    ///
+    /// @brief Returns the size in bytes of the last level cache found by @ref Context::queryCacheSize
+    ///
+    std::size_t getLastLevelCacheSize() const noexcept
+    {
+        return m_lastLevelCacheSize;
+    }
+
+    ///
+    /// @brief Returns the widest @ref utils::SimdTier found by @ref Context::querySimdSupport
+    ///
+    /// Design: Return the first supported tier out of AVX512, AVX2 and SSE4.1, else scalar
+    ///
+    utils::SimdTier getWidestSimdTier() const noexcept
+    {
+        utils::SimdTier ret { utils::SimdTier::scalar };
+
+        if (m_supportsAVX512) {
+            ret = utils::SimdTier::avx512;
+        } else if (m_supportsAVX2) {
+            ret = utils::SimdTier::avx2;
+        } else if (m_supportsSSE) {
+            ret = utils::SimdTier::sse4_1;
+        }
+
+        return ret;
+    }
+
     ///
     /// @brief Sole parameterized constructor
     ///
-    /// Design: TODO
+    /// Design:
+    /// -# Assign @p inputArgs to @ref Context::m_inputArgs
     ///
     Context(const utils::InputArguments &inputArgs) : m_inputArgs(inputArgs)
     {
@@ -56,22 +141,66 @@ class Context
     ///
     /// @brief Performs initialization of @ref rgb2yuv::Context that may fail
     ///
-    /// Design: TODO
+    /// @throws std::invalid_argument (Indirectly via init of @ref rgb2yuv::Decoder, @ref rgb2yuv::Converter
+    ///         or @ref rgb2yuv::Encoder)
+    ///
+    /// Design:
+    /// -# Invoke @ref Context::querySimdSupport
+    /// -# Invoke @ref Context::queryCacheSize, the tuner and the store type depend on the last level cache size
+    /// -# Select @ref Context::getWidestSimdTier, or @ref utils::SimdTier::scalar
+    ///    if @ref utils::InputArguments::disableSimd is set, and record it in @ref Context::m_stats
+    /// -# If @ref utils::InputArguments::autoTune is set, take the number of workers (unless
+    ///    @ref utils::InputArguments::numThreads is set), the band height and the store type from
+    ///    @ref rgb2yuv::Tuner::getSettings, cached in @ref utils::InputArguments::tuneFile
+    /// -# Create a @ref rgb2yuv::ThreadPool with @ref utils::InputArguments::numThreads workers
+    ///    (number of logical processors if 0, or as tuned), pinned to cores of their NUMA node if
+    ///    @ref utils::InputArguments::numaAware is set
+    /// -# Invoke @ref setFramePageConfig to back frames with huge pages if @ref utils::InputArguments::hugePages
+    ///    is set, prefaulted unless @ref utils::InputArguments::numaAware relies on first-touch placement
+    /// -# Create and initialize @ref rgb2yuv::Decoder and @ref rgb2yuv::Converter.
+    ///    @ref rgb2yuv::Converter uses non-temporal stores for images whose input and output exceed
+    ///    the last level cache (or as tuned) and produces @ref utils::InputArguments::pyramidLevels levels
+    /// -# If @ref utils::InputArguments::cacheDir is set, create and initialize a @ref rgb2yuv::ConversionCache
+    /// -# Create and initialize @ref rgb2yuv::Encoder
     ///
     void init();
 
+    ///
+    /// @brief Decodes, converts and encodes the input file
+    ///
+    /// @throws std::invalid_argument or std::runtime_error (Indirectly via @ref rgb2yuv::Decoder,
+    ///         @ref rgb2yuv::Converter or @ref rgb2yuv::Encoder)
+    ///
+    /// Design:
+    /// -# If @ref Context::m_cache is present, within a @ref Stats::ScopedStage read the input file,
+    ///    compute its key with @ref ConversionCache::makeKey and try @ref ConversionCache::fetch.
+    ///    On a hit, close @ref rgb2yuv::Encoder and skip decoding, converting and encoding.
+    /// -# Invoke @ref Context::convertSequence if @ref utils::InputArguments::sequence is set, else
+    ///    decode the input file and invoke @ref Context::convertAndEncode
+    /// -# @ref ConversionCache::store the output if @ref Context::m_cache is present
+    /// -# Snapshot the busy and idle time of the @ref rgb2yuv::ThreadPool workers
+    /// -# If @ref utils::InputArguments::enableStats is set, print @ref Context::m_stats on stderr
+    /// -# If @ref utils::InputArguments::metricsFile is set, write the @ref rgb2yuv::Metrics to it
+    ///
+    void run();
+
     /// @brief Sole destructor
     ///
-    /// Design: TODO
+    /// Design: Invoke @ref Context::deinit
     ///
     ~Context();
 
     /// @brief Performs deinitialiazation of @ref rgb2yuv::Context that may fail
     ///
-    /// Design: TODO
+    /// Design: Deinitialize and destroy the @ref rgb2yuv::Encoder, @ref rgb2yuv::Converter,
+    ///         @ref rgb2yuv::Decoder, @ref rgb2yuv::ThreadPool and @ref rgb2yuv::ConversionCache
+    ///         instances, if present
     ///
     void deinit();
 
+    Context(const Context &) = delete;
+    Context &operator=(const Context &) = delete;
+
     ///
     /// @brief Returns @ref utils::InputArguments containing the input arguments specified.
     ///
@@ -83,6 +212,14 @@ class Context
     {
         return m_inputArgs;
     }
+
+    ///
+    /// @brief Returns the statistics collected by @ref Context::run
+    ///
+    const Stats &getStats() const noexcept
+    {
+        return m_stats;
+    }
 };
 
 } // namespace rgb2yuv
@@ -0,0 +1,334 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_async.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rgb2yuv.hpp"
+#include "rgb2yuv_converter.hpp"
+#include "rgb2yuv_decoder.hpp"
+#include "rgb2yuv_encoder.hpp"
+#include "rgb2yuv_executor.hpp"
+#include "rgb2yuv_metrics.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+
+namespace rgb2yuv
+{
+
+struct AsyncContext::Job
+{
+    ///
+    /// @brief Converter and encoder of one output of a job
+    ///
+    struct Output
+    {
+        Converter converter; ///< Converter of the decoded image
+        Encoder encoder; ///< Encoder of the output files
+
+        Output(const utils::InputArguments &inputArgs, const utils::OutputSpec &output, const utils::SimdTier simdTier,
+               ThreadPool &threadPool, const std::size_t lastLevelCacheSize) :
+            // Without a known cache size the output is always written with regular stores
+            converter(inputArgs.inputColorFormat, output.outputColorFormat, inputArgs.colorMatrix, simdTier, threadPool,
+                      (lastLevelCacheSize != 0U) ? lastLevelCacheSize : std::numeric_limits<std::size_t>::max(),
+                      std::max(1U, inputArgs.pyramidLevels), inputArgs.alphaMode, inputArgs.background,
+                      inputArgs.chromaFilter),
+            encoder(output.outputFile, output.outputFileFormat, output.outputColorFormat)
+        {
+        }
+    };
+
+    Decoder decoder; ///< Decoder of the input file
+    std::vector<std::unique_ptr<Output>> outputs { }; ///< Every output written from @ref Job::decoder
+    const FrameBuffer *decodedData { nullptr }; ///< Decoded image held by @ref Job::decoder
+    const std::uint32_t bytesPerPixel; ///< Number of bytes per pixel of the input color format
+    std::uint32_t width { 0U }; ///< Width of the image in pixels
+    std::uint32_t height { 0U }; ///< Height of the image in pixels
+    std::size_t srcStride { 0U }; ///< Distance in bytes between two consecutive rows of @ref Job::decodedData
+    std::uint32_t bandRows { 0U }; ///< Number of rows of every band but the last
+    std::chrono::steady_clock::time_point convertStartTime { }; ///< Time the band tasks were posted
+    std::atomic<std::uint32_t> numPendingBands { 0U }; ///< Number of bands not converted yet
+    std::atomic<std::size_t> numPendingOutputs { 0U }; ///< Number of outputs not encoded yet
+    std::mutex errorMutex { }; ///< Protects @ref Job::error
+    std::exception_ptr error { }; ///< First exception thrown by a band or an output
+    std::atomic<bool> hasFailed { false }; ///< Set once @ref Job::error is set
+    std::promise<void> promise { }; ///< Satisfied by @ref AsyncContext::complete
+    Callback onComplete { }; ///< Invoked by @ref AsyncContext::complete
+
+    Job(const utils::InputArguments &inputArgs, const std::vector<utils::OutputSpec> &outputSpecs,
+        const utils::SimdTier simdTier, ThreadPool &threadPool, const std::size_t lastLevelCacheSize) :
+        decoder(inputArgs.inputFile, inputArgs.inputFileFormat, inputArgs.inputColorFormat, inputArgs.width,
+                inputArgs.height, nullptr),
+        bytesPerPixel(Converter::getBytesPerPixel(inputArgs.inputColorFormat))
+    {
+        outputs.reserve(outputSpecs.size());
+        for (const utils::OutputSpec &outputSpec : outputSpecs)
+        {
+            outputs.push_back(std::make_unique<Output>(inputArgs, outputSpec, simdTier, threadPool, lastLevelCacheSize));
+        }
+    }
+
+    ///
+    /// @brief Records @p exception as the error of the job, unless an earlier one is recorded
+    ///
+    void fail(const std::exception_ptr &exception)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+            error = exception;
+        }
+        hasFailed.store(true);
+    }
+};
+
+void AsyncContext::init()
+{
+    Context probe({ });
+    probe.querySimdSupport();
+    probe.queryCacheSize();
+    m_simdTier = m_disableSimd ? utils::SimdTier::scalar : probe.getWidestSimdTier();
+    m_lastLevelCacheSize = probe.getLastLevelCacheSize();
+
+    const std::uint32_t numThreads { (m_numThreads > 0U) ? m_numThreads : std::thread::hardware_concurrency() };
+    m_threadPool = new ThreadPool(1U);
+    m_executor = new Executor(numThreads);
+    m_scratch.resize(m_executor->getNumThreads());
+}
+
+AsyncContext::~AsyncContext()
+{
+    deinit();
+}
+
+void AsyncContext::deinit()
+{
+    delete m_executor;
+    m_executor = nullptr;
+
+    delete m_threadPool;
+    m_threadPool = nullptr;
+
+    m_scratch.clear();
+}
+
+std::uint32_t AsyncContext::getNumThreads() const noexcept
+{
+    return (m_executor != nullptr) ? m_executor->getNumThreads() : 0U;
+}
+
+std::future<void> AsyncContext::submit(const utils::InputArguments &inputArgs, Callback onComplete)
+{
+    return submit(inputArgs, { { inputArgs.outputFile, inputArgs.outputColorFormat, inputArgs.outputFileFormat } }, { },
+                  std::move(onComplete));
+}
+
+std::future<void> AsyncContext::submit(const utils::InputArguments &inputArgs,
+                                       const std::vector<utils::OutputSpec> &outputs,
+                                       std::vector<std::uint8_t> &&fileData, Callback onComplete)
+{
+    if (m_executor == nullptr) {
+        throw std::invalid_argument("Asynchronous context is not initialized!");
+    }
+
+    if (outputs.empty()) {
+        throw std::invalid_argument("No outputs specified for the asynchronous conversion!");
+    }
+
+    if (inputArgs.sequence || !inputArgs.cacheDir.empty()) {
+        throw std::invalid_argument("Sequences and the conversion cache are not supported by asynchronous conversions!");
+    }
+
+    const std::shared_ptr<Job> job { std::make_shared<Job>(inputArgs, outputs, m_simdTier, *m_threadPool,
+                                                           m_lastLevelCacheSize) };
+    if (!fileData.empty()) {
+        job->decoder.setFileData(std::move(fileData));
+    }
+
+    job->onComplete = std::move(onComplete);
+    std::future<void> ret { job->promise.get_future() };
+    m_executor->post([this, job](const std::uint32_t)
+    {
+        decode(job);
+    });
+
+    return ret;
+}
+
+void AsyncContext::decode(const std::shared_ptr<Job> &job)
+{
+    std::uint32_t numBands { 0U };
+    try
+    {
+        job->decoder.init();
+        for (const std::unique_ptr<Job::Output> &output : job->outputs)
+        {
+            output->converter.init();
+            output->encoder.init();
+        }
+
+        {
+            Metrics::ScopedStage stage(Stage::decode);
+            const std::vector<std::uint8_t> &fileData { job->decoder.read() };
+            job->decodedData = &job->decoder.decode(fileData.data(), fileData.size());
+        }
+        Metrics::recordBytes(Stage::decode, job->decodedData->size());
+        job->width = job->decoder.getWidth();
+        job->height = job->decoder.getHeight();
+        job->srcStride = static_cast<std::size_t>(job->width) * job->bytesPerPixel;
+
+        // Band alignments are powers of two, so the largest one is a multiple of all the others
+        std::uint32_t bandAlignment { 1U };
+        for (const std::unique_ptr<Job::Output> &output : job->outputs)
+        {
+            output->converter.beginConvert(job->width, job->height);
+            bandAlignment = std::max(bandAlignment, output->converter.getBandAlignment());
+        }
+
+        // Small images are converted by a single task, large ones are spread over all workers
+        const std::uint64_t numPixels { static_cast<std::uint64_t>(job->width) * job->height };
+        numBands = static_cast<std::uint32_t>(std::min<std::uint64_t>(m_executor->getNumThreads(),
+                                                                      std::max<std::uint64_t>(1U, numPixels / ct_minBandPixels)));
+        job->bandRows = (job->height + numBands - 1U) / numBands;
+        job->bandRows = ((job->bandRows + bandAlignment - 1U) / bandAlignment) * bandAlignment;
+        numBands = (job->height + job->bandRows - 1U) / job->bandRows;
+    }
+    catch (...)
+    {
+        complete(job, std::current_exception());
+        return;
+    }
+
+    job->convertStartTime = std::chrono::steady_clock::now();
+    job->numPendingBands.store(numBands);
+    for (std::uint32_t bandIdx { 0U }; bandIdx < numBands; ++bandIdx)
+    {
+        m_executor->post([this, job, bandIdx](const std::uint32_t workerIdx)
+        {
+            convertBand(job, bandIdx, workerIdx);
+        }, Executor::Priority::continuation);
+    }
+}
+
+void AsyncContext::convertBand(const std::shared_ptr<Job> &job, const std::uint32_t bandIdx,
+                               const std::uint32_t workerIdx)
+{
+    if (!job->hasFailed.load()) {
+        try
+        {
+            const std::uint32_t firstRow { bandIdx * job->bandRows };
+            const std::uint32_t lastRow { std::min(job->height, firstRow + job->bandRows) };
+            for (const std::unique_ptr<Job::Output> &output : job->outputs)
+            {
+                output->converter.convertBand(job->decodedData->data(), job->srcStride, job->width, job->height,
+                                              firstRow, lastRow, m_scratch[workerIdx]);
+            }
+        }
+        catch (...)
+        {
+            job->fail(std::current_exception());
+        }
+    }
+
+    if (job->numPendingBands.fetch_sub(1U) == 1U) {
+        const auto elapsed { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                                   job->convertStartTime) };
+        Metrics::recordLatency(Stage::convert, static_cast<std::uint64_t>(elapsed.count()));
+        job->numPendingOutputs.store(job->outputs.size());
+        for (std::size_t outputIdx { 0U }; outputIdx < job->outputs.size(); ++outputIdx)
+        {
+            m_executor->post([this, job, outputIdx](const std::uint32_t)
+            {
+                encode(job, outputIdx);
+            }, Executor::Priority::continuation);
+        }
+    }
+}
+
+void AsyncContext::encode(const std::shared_ptr<Job> &job, const std::size_t outputIdx)
+{
+    Job::Output &output { *job->outputs[outputIdx] };
+    if (!job->hasFailed.load()) {
+        try
+        {
+            Metrics::ScopedStage stage(Stage::encode);
+            const FrameBuffer &convertedData { output.converter.endConvert(job->width, job->height) };
+            output.encoder.encode(convertedData, job->width, job->height);
+            const std::vector<FrameBuffer> &pyramid { output.converter.getPyramid() };
+            if (!pyramid.empty()) {
+                output.encoder.encodeLevels(pyramid, job->width, job->height);
+            }
+
+            std::size_t encodedSize { convertedData.size() };
+            for (const FrameBuffer &level : pyramid)
+            {
+                encodedSize += level.size();
+            }
+            Metrics::recordBytes(Stage::convert, job->decodedData->size() + convertedData.size());
+            Metrics::recordBytes(Stage::encode, encodedSize);
+        }
+        catch (...)
+        {
+            job->fail(std::current_exception());
+        }
+    }
+
+    output.encoder.deinit();
+    output.converter.deinit();
+
+    if (job->numPendingOutputs.fetch_sub(1U) == 1U) {
+        complete(job, job->error);
+    }
+}
+
+void AsyncContext::complete(const std::shared_ptr<Job> &job, const std::exception_ptr &error) noexcept
+{
+    for (const std::unique_ptr<Job::Output> &output : job->outputs)
+    {
+        output->encoder.deinit();
+        output->converter.deinit();
+    }
+    job->decoder.deinit();
+
+    if (job->onComplete) {
+        try
+        {
+            job->onComplete(error);
+        }
+        catch (...)
+        {
+            // A throwing callback must not leave the future unsatisfied
+        }
+    }
+
+    if (error) {
+        job->promise.set_exception(error);
+    } else {
+        job->promise.set_value();
+    }
+}
+
+} // namespace rgb2yuv
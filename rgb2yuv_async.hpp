@@ -0,0 +1,210 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+// Forward declare few classes
+class Executor;
+class ThreadPool;
+
+///
+/// @brief Runs many conversions concurrently on one shared @ref Executor
+///
+/// Every conversion submitted is split into tasks: decoding (including reading the input file), one
+/// task per band of rows for converting, and encoding (including writing the output files). No thread
+/// blocks on behalf of a conversion, so any number of conversions in flight share a fixed number of
+/// workers. Completion is signalled by a callback and a std::future; a coroutine scheduler can resume
+/// an awaiting coroutine from the callback. A conversion may write several outputs from a single decode,
+/// each band task then converts its rows into every output while they are hot in the cache. Stage latencies
+/// and volumes are recorded into @ref Metrics.
+///
+class AsyncContext
+{
+    public:
+        ///
+        /// @brief Signature of the completion callback of a conversion
+        ///
+        /// @param[in] error Exception that failed the conversion, nullptr on success
+        ///
+        /// The callback is invoked on a worker of the @ref Executor and must neither block nor throw.
+        ///
+        using Callback = std::function<void(std::exception_ptr error)>;
+
+        static constexpr std::uint32_t ct_minBandPixels { 1U << 16U }; ///< Minimum number of pixels converted by a band task
+
+    private:
+        struct Job;
+
+        const std::uint32_t m_numThreads; ///< Number of workers of @ref AsyncContext::m_executor, 0 for one per logical processor
+        const bool m_disableSimd; ///< Specifies if usage of SIMD extensions should be disabled
+        utils::SimdTier m_simdTier { utils::SimdTier::scalar }; ///< SIMD tier selected for conversion
+        std::size_t m_lastLevelCacheSize { 0U }; ///< Size in bytes of the last level cache, 0 if unknown
+        Executor *m_executor { nullptr }; ///< Pointer to the @ref rgb2yuv::Executor running every task
+        ThreadPool *m_threadPool { nullptr }; ///< Pointer to a @ref rgb2yuv::ThreadPool without background workers,
+                                             ///< required to construct a @ref rgb2yuv::Converter but never used
+        std::vector<std::vector<std::uint8_t>> m_scratch { }; ///< Scratch rows of every worker of @ref AsyncContext::m_executor
+
+        ///
+        /// @brief Decodes the input file of @p job and posts its band tasks
+        ///
+        /// Design:
+        /// -# Initialize the @ref rgb2yuv::Decoder, and the @ref rgb2yuv::Converter and @ref rgb2yuv::Encoder of
+        ///    every output of @p job
+        /// -# Read and decode the input file, unless its contents were submitted, and invoke
+        ///    @ref rgb2yuv::Converter::beginConvert for every output
+        /// -# Split the image into at most as many bands as there are workers, each of at least
+        ///    @ref AsyncContext::ct_minBandPixels pixels and aligned to the largest
+        ///    @ref rgb2yuv::Converter::getBandAlignment of the outputs
+        /// -# Post a @ref AsyncContext::convertBand task for every band as @ref Executor::Priority::continuation
+        /// -# On failure, invoke @ref AsyncContext::complete with the exception thrown
+        ///
+        void decode(const std::shared_ptr<Job> &job);
+
+        ///
+        /// @brief Converts band @p bandIdx of @p job into every output with @ref rgb2yuv::Converter::convertBand
+        ///
+        /// Design: Skip the band if another band failed. The last band to finish posts one
+        ///         @ref AsyncContext::encode task per output as @ref Executor::Priority::continuation.
+        ///
+        void convertBand(const std::shared_ptr<Job> &job, const std::uint32_t bandIdx, const std::uint32_t workerIdx);
+
+        ///
+        /// @brief Encodes the converted image and pyramid levels of output @p outputIdx of @p job
+        ///
+        /// Design: Skip the output if @p job failed and release its memory once written. The last output to
+        ///         finish invokes @ref AsyncContext::complete.
+        ///
+        void encode(const std::shared_ptr<Job> &job, const std::size_t outputIdx);
+
+        ///
+        /// @brief Completes @p job
+        ///
+        /// Design:
+        /// -# Deinitialize the @ref rgb2yuv::Encoder and @ref rgb2yuv::Converter of every output and the
+        ///    @ref rgb2yuv::Decoder of @p job, releasing its memory
+        /// -# Invoke the completion callback of @p job, if any
+        /// -# Satisfy the future of @p job with @p error, or with a value if @p error is nullptr
+        ///
+        void complete(const std::shared_ptr<Job> &job, const std::exception_ptr &error) noexcept;
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// @param[in] numThreads Number of workers shared by all conversions, 0 for one per logical processor
+        /// @param[in] disableSimd Disable any form of SIMD usage during conversions
+        ///
+        AsyncContext(const std::uint32_t numThreads, const bool disableSimd) : m_numThreads(numThreads),
+                                                                               m_disableSimd(disableSimd)
+        {
+        }
+
+        ///
+        /// @brief Performs initialization of @ref rgb2yuv::AsyncContext
+        ///
+        /// Design:
+        /// -# Query the SIMD support and cache sizes with @ref rgb2yuv::Context and select the widest SIMD tier,
+        ///    or @ref utils::SimdTier::scalar if @ref AsyncContext::m_disableSimd is set
+        /// -# Create the @ref rgb2yuv::Executor and one scratch buffer per worker
+        ///
+        void init();
+
+        ///
+        /// @brief Waits for every submitted conversion to complete and releases the workers
+        ///
+        /// Design: Destroy the @ref rgb2yuv::Executor, which executes every queued task first, and the
+        ///         @ref rgb2yuv::ThreadPool
+        ///
+        void deinit();
+
+        /// @brief Sole destructor
+        ///
+        /// Design: Invoke @ref AsyncContext::deinit
+        ///
+        ~AsyncContext();
+
+        AsyncContext(const AsyncContext &) = delete;
+        AsyncContext &operator=(const AsyncContext &) = delete;
+
+        ///
+        /// @brief Submits the conversion described by @p inputArgs and returns without waiting for it
+        ///
+        /// @param[in] inputArgs Files, formats and options of the conversion. The worker related options
+        ///            (numThreads, disableSimd, numaAware, hugePages) and the statistics options are
+        ///            ignored, they are shared by all conversions of @ref rgb2yuv::AsyncContext.
+        /// @param[in] onComplete Callback invoked once the conversion succeeded or failed, may be empty
+        ///
+        /// @throws std::invalid_argument if @ref rgb2yuv::AsyncContext is not initialized, or if
+        ///         @ref utils::InputArguments::sequence or @ref utils::InputArguments::cacheDir is set
+        ///
+        /// Design: Invoke the overload below with the single output described by @p inputArgs
+        ///
+        /// @returns Future satisfied once the conversion completed, holding its exception if it failed
+        ///
+        std::future<void> submit(const utils::InputArguments &inputArgs, Callback onComplete = { });
+
+        ///
+        /// @brief Submits the conversion of one input into several outputs and returns without waiting for it
+        ///
+        /// @param[in] inputArgs Input file, formats and options of the conversion, as above. The output file and
+        ///            formats are ignored.
+        /// @param[in] outputs Files and formats written from the single decode of the input file, at least one
+        /// @param[in] fileData Contents of the input file if the caller read them already, else empty
+        /// @param[in] onComplete Callback invoked once every output succeeded or the conversion failed, may be empty
+        ///
+        /// @throws std::invalid_argument if @ref rgb2yuv::AsyncContext is not initialized, if @p outputs is empty,
+        ///         or if @ref utils::InputArguments::sequence or @ref utils::InputArguments::cacheDir is set
+        ///
+        /// Design: Create the @ref rgb2yuv::Decoder of a new job, handing it @p fileData, and a
+        ///         @ref rgb2yuv::Converter and @ref rgb2yuv::Encoder per entry of @p outputs, then post its
+        ///         @ref AsyncContext::decode task as @ref Executor::Priority::start
+        ///
+        /// @returns Future satisfied once the conversion completed, holding its exception if it failed
+        ///
+        std::future<void> submit(const utils::InputArguments &inputArgs, const std::vector<utils::OutputSpec> &outputs,
+                                 std::vector<std::uint8_t> &&fileData, Callback onComplete = { });
+
+        ///
+        /// @brief Returns the SIMD tier selected by @ref AsyncContext::init
+        ///
+        utils::SimdTier getSimdTier() const noexcept
+        {
+            return m_simdTier;
+        }
+
+        ///
+        /// @brief Returns the number of workers shared by all conversions, 0 if not initialized
+        ///
+        std::uint32_t getNumThreads() const noexcept;
+};
+
+} // namespace rgb2yuv
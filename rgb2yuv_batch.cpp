@@ -0,0 +1,269 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_batch.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rgb2yuv_async.hpp"
+#include "rgb2yuv_metrics.hpp"
+
+namespace rgb2yuv
+{
+
+void Batch::init()
+{
+    m_entries = utils::InputParser::parseBatch(m_inputArgs);
+
+    if (!m_inputArgs.outputDir.empty()) {
+        // A failure surfaces as soon as the first output cannot be created
+        std::error_code errorCode { };
+        std::filesystem::create_directories(m_inputArgs.outputDir, errorCode);
+    }
+
+    m_asyncContext = new AsyncContext(m_inputArgs.numThreads, m_inputArgs.disableSimd);
+    m_asyncContext->init();
+}
+
+void Batch::deinit()
+{
+    delete m_asyncContext;
+    m_asyncContext = nullptr;
+
+    m_entries.clear();
+}
+
+Batch::~Batch()
+{
+    deinit();
+}
+
+std::vector<std::uint8_t> Batch::readFile(const std::string &inputFile)
+{
+    std::ifstream stream(inputFile, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!stream.is_open()) {
+        throw std::invalid_argument("Failed to open input file");
+    }
+
+    const std::streamoff fileSize { stream.tellg() };
+    if (fileSize < 0) {
+        throw std::invalid_argument("Failed to read input file");
+    }
+
+    std::vector<std::uint8_t> ret(static_cast<std::size_t>(fileSize));
+    stream.seekg(0, std::ios::beg);
+    if (!stream.read(reinterpret_cast<char *>(ret.data()), fileSize)) {
+        throw std::invalid_argument("Failed to read input file");
+    }
+
+    return ret;
+}
+
+void Batch::printError(const std::string &inputFile, const std::exception_ptr &error) noexcept
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "rgb2yuv: " << inputFile << ": " << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "rgb2yuv: " << inputFile << ": Unknown error" << std::endl;
+    }
+}
+
+std::uint32_t Batch::run()
+{
+    if (m_asyncContext == nullptr) {
+        throw std::invalid_argument("Batch is not initialized!");
+    }
+
+    // Input files read ahead, in the order of m_entries
+    struct Prefetched
+    {
+        std::vector<std::uint8_t> fileData { }; ///< Contents of the input file
+        std::exception_ptr error { }; ///< Exception thrown while reading the input file
+    };
+
+    const std::chrono::steady_clock::time_point startTime { std::chrono::steady_clock::now() };
+    const std::uint32_t maxInFlight { ct_jobsPerThread * m_asyncContext->getNumThreads() };
+    std::mutex mutex { };
+    std::condition_variable stateChanged { };
+    std::deque<Prefetched> prefetched { };
+    std::size_t prefetchedBytes { 0U };
+    std::uint64_t bytesRead { 0U };
+    std::uint32_t numInFlight { 0U };
+    std::uint32_t numFailed { 0U };
+    bool isDone { false };
+
+    std::thread metricsWriter { };
+    if (!m_inputArgs.metricsFile.empty()) {
+        metricsWriter = std::thread([&]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stateChanged.wait_for(lock, std::chrono::milliseconds(ct_metricsIntervalMs), [&]() { return isDone; }))
+            {
+                lock.unlock();
+                try
+                {
+                    Metrics::getInstance().dump(m_inputArgs.metricsFile);
+                }
+                catch (const std::exception &)
+                {
+                    // Retried at the next interval, the final write reports the failure
+                }
+                lock.lock();
+            }
+        });
+    }
+
+    std::thread reader([&]()
+    {
+        for (const utils::BatchEntry &entry : m_entries)
+        {
+            {
+                // Keep at least one input ready, whatever its size
+                std::unique_lock<std::mutex> lock(mutex);
+                stateChanged.wait(lock, [&]()
+                {
+                    return prefetched.empty() ||
+                           ((prefetched.size() < maxInFlight) && (prefetchedBytes < ct_maxPrefetchBytes));
+                });
+            }
+
+            Prefetched item { };
+            try
+            {
+                item.fileData = readFile(entry.inputFile);
+            }
+            catch (...)
+            {
+                item.error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            prefetchedBytes += item.fileData.size();
+            bytesRead += item.fileData.size();
+            prefetched.push_back(std::move(item));
+            stateChanged.notify_all();
+        }
+    });
+
+    std::size_t numOutputs { 0U };
+    for (const utils::BatchEntry &entry : m_entries)
+    {
+        Prefetched item { };
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stateChanged.wait(lock, [&]()
+            {
+                return !prefetched.empty() && (numInFlight < maxInFlight);
+            });
+            item = std::move(prefetched.front());
+            prefetched.pop_front();
+            prefetchedBytes -= item.fileData.size();
+            ++numInFlight;
+            stateChanged.notify_all();
+        }
+
+        numOutputs += entry.outputs.size();
+        std::exception_ptr error { item.error };
+        if (!error) {
+            try
+            {
+                utils::InputArguments inputArgs { m_inputArgs };
+                inputArgs.inputFile = entry.inputFile;
+                m_asyncContext->submit(inputArgs, entry.outputs, std::move(item.fileData),
+                                       [&, inputFile = entry.inputFile](const std::exception_ptr jobError)
+                {
+                    // Notify under the lock, run() may return as soon as it observes numInFlight drop to 0
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (jobError) {
+                        printError(inputFile, jobError);
+                        ++numFailed;
+                    }
+                    --numInFlight;
+                    stateChanged.notify_all();
+                });
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+        }
+
+        if (error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            printError(entry.inputFile, error);
+            ++numFailed;
+            --numInFlight;
+        }
+    }
+
+    reader.join();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stateChanged.wait(lock, [&]()
+        {
+            return numInFlight == 0U;
+        });
+        isDone = true;
+        stateChanged.notify_all();
+    }
+
+    if (metricsWriter.joinable()) {
+        metricsWriter.join();
+        Metrics::getInstance().dump(m_inputArgs.metricsFile);
+    }
+
+    if (m_inputArgs.enableStats) {
+        const double wallMs { std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() };
+        const double inputsPerS { (wallMs > 0.0) ? static_cast<double>(m_entries.size()) * 1e3 / wallMs : 0.0 };
+        const double mbPerS { (wallMs > 0.0) ? static_cast<double>(bytesRead) / (wallMs * 1e3) : 0.0 };
+        if (m_inputArgs.statsFormat == utils::StatsFormat::json) {
+            std::fprintf(stderr, "{\"simd\":\"%s\",\"batch\":{\"inputs\":%zu,\"outputs\":%zu,\"failed\":%u,"
+                         "\"bytes_read\":%llu,\"wall_ms\":%.3f,\"inputs_per_s\":%.2f,\"mb_per_s\":%.2f}}\n",
+                         utils::toString(m_asyncContext->getSimdTier()), m_entries.size(), numOutputs, numFailed,
+                         static_cast<unsigned long long>(bytesRead), wallMs, inputsPerS, mbPerS);
+        } else {
+            std::fprintf(stderr, "rgb2yuv stats: simd=%s | batch inputs=%zu outputs=%zu failed=%u bytes_read=%llu "
+                         "wall=%.3fms %.2finputs/s %.2fMB/s\n",
+                         utils::toString(m_asyncContext->getSimdTier()), m_entries.size(), numOutputs, numFailed,
+                         static_cast<unsigned long long>(bytesRead), wallMs, inputsPerS, mbPerS);
+        }
+    }
+
+    return numFailed;
+}
+
+} // namespace rgb2yuv
@@ -0,0 +1,126 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+// Forward declare few classes
+class AsyncContext;
+
+///
+/// @brief Converts a manifest or a glob of input files through one shared @ref AsyncContext
+///
+/// A reader thread reads the next input files ahead while the workers of the @ref AsyncContext decode,
+/// convert and encode the current ones, so storage and the processors are busy at the same time. Every
+/// input is decoded once and converted into each of its outputs.
+///
+class Batch
+{
+    public:
+        static constexpr std::size_t ct_maxPrefetchBytes { static_cast<std::size_t>(256U) << 20U }; ///< Maximum number of bytes read ahead
+        static constexpr std::uint32_t ct_jobsPerThread { 2U }; ///< Number of inputs in flight per worker
+        static constexpr std::uint32_t ct_metricsIntervalMs { 1000U }; ///< Interval between two writes of the metrics file
+
+    private:
+        const utils::InputArguments m_inputArgs; ///< Input arguments to rgb2yuv
+        std::vector<utils::BatchEntry> m_entries { }; ///< Input files and outputs of the batch
+        AsyncContext *m_asyncContext { nullptr }; ///< Pointer to the @ref rgb2yuv::AsyncContext running every conversion
+
+        ///
+        /// @brief Reads the whole of @p inputFile
+        ///
+        /// @throws std::invalid_argument if the file cannot be opened or read
+        ///
+        static std::vector<std::uint8_t> readFile(const std::string &inputFile);
+
+        ///
+        /// @brief Prints @p error of the conversion of @p inputFile on stderr
+        ///
+        static void printError(const std::string &inputFile, const std::exception_ptr &error) noexcept;
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// Design: Assign @p inputArgs to @ref Batch::m_inputArgs
+        ///
+        explicit Batch(const utils::InputArguments &inputArgs) : m_inputArgs(inputArgs)
+        {
+        }
+
+        ///
+        /// @brief Performs initialization steps of @ref Batch that may fail
+        ///
+        /// @throws std::invalid_argument (Indirectly via @ref utils::InputParser::parseBatch)
+        ///
+        /// Design:
+        /// -# List the input files and outputs with @ref utils::InputParser::parseBatch
+        /// -# Create @ref utils::InputArguments::outputDir if it is set
+        /// -# Create and initialize the @ref rgb2yuv::AsyncContext
+        ///
+        void init();
+
+        ///
+        /// @brief Waits for the batch to complete and releases the workers
+        ///
+        void deinit();
+
+        ///
+        /// @brief Sole destructor
+        ///
+        /// Design: Invoke @ref Batch::deinit
+        ///
+        ~Batch();
+
+        Batch(const Batch &) = delete;
+        Batch &operator=(const Batch &) = delete;
+
+        ///
+        /// @brief Converts every input file of the batch
+        ///
+        /// Design:
+        /// -# Start a reader thread that reads the input files in order with @ref Batch::readFile, as long as fewer
+        ///    than @ref Batch::ct_jobsPerThread inputs per worker and fewer than @ref Batch::ct_maxPrefetchBytes
+        ///    bytes are waiting to be submitted
+        /// -# Submit every input read to @ref rgb2yuv::AsyncContext with its outputs and contents, once fewer than
+        ///    @ref Batch::ct_jobsPerThread inputs per worker are in flight. Inflight inputs bound the memory held
+        ///    by decoded and converted images.
+        /// -# Print the error of every input that failed with @ref Batch::printError and carry on with the others
+        /// -# If @ref utils::InputArguments::metricsFile is set, write the @ref rgb2yuv::Metrics to it every
+        ///    @ref Batch::ct_metricsIntervalMs and once the batch completed
+        /// -# Wait for every conversion to complete and print the batch statistics if
+        ///    @ref utils::InputArguments::enableStats is set
+        ///
+        /// @returns Number of input files whose conversion failed
+        ///
+        std::uint32_t run();
+};
+
+} // namespace rgb2yuv
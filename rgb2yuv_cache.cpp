@@ -0,0 +1,302 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+// Bumped whenever the output of a conversion changes, so that stale entries are never hit
+constexpr std::uint64_t ct_cacheVersion { 1U };
+const char *const ct_entryExtension { ".bin" };
+
+// Entries are read-only, so that no writer can modify them in place
+constexpr std::filesystem::perms ct_entryPermissions { std::filesystem::perms::owner_read |
+                                                       std::filesystem::perms::group_read |
+                                                       std::filesystem::perms::others_read };
+constexpr std::filesystem::perms ct_outputPermissions { ct_entryPermissions | std::filesystem::perms::owner_write };
+
+constexpr std::uint64_t ct_prime1 { 11400714785074694791ULL };
+constexpr std::uint64_t ct_prime2 { 14029467366897019727ULL };
+constexpr std::uint64_t ct_prime3 { 1609587929392839161ULL };
+constexpr std::uint64_t ct_prime4 { 9650029242287828579ULL };
+constexpr std::uint64_t ct_prime5 { 2870177450012600261ULL };
+
+inline std::uint64_t rotateLeft(const std::uint64_t value, const std::uint32_t bits) noexcept
+{
+    return (value << bits) | (value >> (64U - bits));
+}
+
+inline std::uint64_t read64(const std::uint8_t *data) noexcept
+{
+    std::uint64_t ret { 0U };
+    std::memcpy(&ret, data, sizeof(ret));
+    return ret;
+}
+
+inline std::uint32_t read32(const std::uint8_t *data) noexcept
+{
+    std::uint32_t ret { 0U };
+    std::memcpy(&ret, data, sizeof(ret));
+    return ret;
+}
+
+inline std::uint64_t mixRound(std::uint64_t acc, const std::uint64_t input) noexcept
+{
+    acc += input * ct_prime2;
+    return rotateLeft(acc, 31U) * ct_prime1;
+}
+
+inline std::uint64_t mergeRound(const std::uint64_t acc, const std::uint64_t value) noexcept
+{
+    return (acc ^ mixRound(0U, value)) * ct_prime1 + ct_prime4;
+}
+
+// XXH64 of a little endian byte stream
+std::uint64_t hash64(const std::uint8_t *data, const std::size_t size, const std::uint64_t seed) noexcept
+{
+    const std::uint8_t *pos { data };
+    const std::uint8_t *end { data + size };
+    std::uint64_t hash { 0U };
+
+    if (size >= 32U) {
+        std::array<std::uint64_t, 4U> acc { seed + ct_prime1 + ct_prime2, seed + ct_prime2, seed, seed - ct_prime1 };
+        for (; pos + 32U <= end; pos += 32U)
+        {
+            for (std::uint32_t lane { 0U }; lane < 4U; ++lane)
+            {
+                acc[lane] = mixRound(acc[lane], read64(pos + 8U * lane));
+            }
+        }
+        hash = rotateLeft(acc[0U], 1U) + rotateLeft(acc[1U], 7U) + rotateLeft(acc[2U], 12U) + rotateLeft(acc[3U], 18U);
+        for (const std::uint64_t value : acc)
+        {
+            hash = mergeRound(hash, value);
+        }
+    } else {
+        hash = seed + ct_prime5;
+    }
+
+    hash += size;
+    for (; pos + 8U <= end; pos += 8U)
+    {
+        hash = rotateLeft(hash ^ mixRound(0U, read64(pos)), 27U) * ct_prime1 + ct_prime4;
+    }
+    if (pos + 4U <= end) {
+        hash = rotateLeft(hash ^ (read32(pos) * ct_prime1), 23U) * ct_prime2 + ct_prime3;
+        pos += 4U;
+    }
+    for (; pos != end; ++pos)
+    {
+        hash = rotateLeft(hash ^ (*pos * ct_prime5), 11U) * ct_prime1;
+    }
+
+    hash ^= hash >> 33U;
+    hash *= ct_prime2;
+    hash ^= hash >> 29U;
+    hash *= ct_prime3;
+    hash ^= hash >> 32U;
+
+    return hash;
+}
+
+bool reflinkFile(const std::filesystem::path &from, const std::filesystem::path &to) noexcept
+{
+    bool ret { false };
+
+#ifdef __linux__
+    const int src { ::open(from.c_str(), O_RDONLY) };
+    if (src < 0) {
+        return false;
+    }
+
+    const int dst { ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644) };
+    if (dst >= 0) {
+        ret = (::ioctl(dst, FICLONE, src) == 0);
+        ::close(dst);
+        if (!ret) {
+            std::error_code error { };
+            std::filesystem::remove(to, error);
+        }
+    }
+    ::close(src);
+#else
+    static_cast<void>(from);
+    static_cast<void>(to);
+#endif
+
+    return ret;
+}
+
+} // namespace
+
+void ConversionCache::init()
+{
+    std::error_code error { };
+    std::filesystem::create_directories(m_directory, error);
+    if (error || !std::filesystem::is_directory(m_directory, error)) {
+        throw std::invalid_argument("Failed to create cache directory");
+    }
+}
+
+std::filesystem::path ConversionCache::getEntryPath(const std::string &key) const
+{
+    return m_directory / (key + ct_entryExtension);
+}
+
+std::string ConversionCache::makeKey(const std::uint8_t *data, const std::size_t size,
+                                     const utils::InputArguments &args) noexcept
+{
+    const std::array<std::uint64_t, 11U> conversion
+    {
+        ct_cacheVersion,
+        static_cast<std::uint64_t>(args.inputFileFormat),
+        static_cast<std::uint64_t>(args.inputColorFormat),
+        static_cast<std::uint64_t>(args.outputFileFormat),
+        static_cast<std::uint64_t>(args.outputColorFormat),
+        static_cast<std::uint64_t>(args.colorMatrix),
+        args.width,
+        args.height,
+        static_cast<std::uint64_t>(args.alphaMode),
+        args.background,
+        static_cast<std::uint64_t>(args.chromaFilter)
+    };
+    const std::uint64_t seed { hash64(reinterpret_cast<const std::uint8_t *>(conversion.data()),
+                                      conversion.size() * sizeof(std::uint64_t), 0U) };
+    const std::uint64_t hash { hash64(data, size, seed) };
+
+    constexpr char digits[] { "0123456789abcdef" };
+    std::string ret(16U, '0');
+    for (std::uint32_t idx { 0U }; idx < 16U; ++idx)
+    {
+        ret[idx] = digits[(hash >> (60U - 4U * idx)) & 0xFU];
+    }
+
+    return ret;
+}
+
+bool ConversionCache::cloneFile(const std::filesystem::path &from, const std::filesystem::path &to,
+                                const std::filesystem::perms permissions) noexcept
+{
+    std::error_code error { };
+    if (!reflinkFile(from, to) &&
+        !(std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, error) && !error)) {
+        return false;
+    }
+
+    std::filesystem::permissions(to, permissions, error);
+    return true;
+}
+
+bool ConversionCache::fetch(const std::string &key, const std::string &outputFile) noexcept
+{
+    const std::filesystem::path entry { getEntryPath(key) };
+    std::error_code error { };
+
+    if (!std::filesystem::is_regular_file(entry, error)) {
+        return false;
+    }
+
+    std::filesystem::remove(outputFile, error);
+    if (!cloneFile(entry, outputFile, ct_outputPermissions)) {
+        return false;
+    }
+
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error);
+    return true;
+}
+
+void ConversionCache::store(const std::string &key, const std::string &outputFile) noexcept
+{
+    std::error_code error { };
+    std::random_device random { };
+    const std::filesystem::path temporary { m_directory / (key + ".tmp" + std::to_string(random())) };
+
+    if (!cloneFile(outputFile, temporary, ct_entryPermissions)) {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+
+    std::filesystem::rename(temporary, getEntryPath(key), error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+
+    evict();
+}
+
+void ConversionCache::evict() noexcept
+{
+    struct Entry
+    {
+        std::filesystem::file_time_type lastUse;
+        std::uint64_t size;
+        std::filesystem::path path;
+    };
+    std::vector<Entry> entries { };
+    std::uint64_t totalSize { 0U };
+    std::error_code error { };
+
+    for (std::filesystem::directory_iterator it(m_directory, error), end; !error && (it != end); it.increment(error))
+    {
+        if (it->path().extension() != ct_entryExtension) {
+            continue;
+        }
+        std::error_code entryError { };
+        const std::uint64_t size { it->file_size(entryError) };
+        const std::filesystem::file_time_type lastUse { it->last_write_time(entryError) };
+        if (!entryError) {
+            entries.push_back({ lastUse, size, it->path() });
+            totalSize += size;
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs) { return lhs.lastUse < rhs.lastUse; });
+    for (const Entry &entry : entries)
+    {
+        if (totalSize <= m_sizeLimit) {
+            break;
+        }
+        if (std::filesystem::remove(entry.path, error)) {
+            totalSize -= entry.size;
+        }
+    }
+}
+
+} // namespace rgb2yuv
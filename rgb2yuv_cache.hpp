@@ -0,0 +1,143 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+///
+/// @brief On-disk cache of converted output files, keyed by a hash of the input file and the conversion parameters
+///
+/// Entries are stored as read-only <key>.bin files in the cache directory. The modification time of an entry is
+/// refreshed on every hit and used as its LRU timestamp.
+///
+class ConversionCache
+{
+    private:
+        const std::filesystem::path m_directory; ///< Directory holding the cache entries
+        const std::uint64_t m_sizeLimit; ///< Maximum total size in bytes of all entries
+
+        ///
+        /// @brief Returns the path of the entry of @p key
+        ///
+        std::filesystem::path getEntryPath(const std::string &key) const;
+
+        ///
+        /// @brief Makes @p to an independent copy of @p from that is cheap to create
+        ///
+        /// Note: Hardlinks are never used, @p from and @p to must not share data that a later write of
+        ///       either file could modify
+        ///
+        /// Design:
+        /// -# Try to reflink @p from to @p to (copy-on-write clone, Linux only)
+        /// -# Else copy @p from to @p to
+        /// -# Set the permissions of @p to to @p permissions
+        ///
+        /// @returns @true on success, else @false
+        ///
+        static bool cloneFile(const std::filesystem::path &from, const std::filesystem::path &to,
+                              const std::filesystem::perms permissions) noexcept;
+
+        ///
+        /// @brief Removes least recently used entries until the cache fits @ref ConversionCache::m_sizeLimit
+        ///
+        /// Design:
+        /// -# Collect size and modification time of all entries
+        /// -# Remove the entries with the oldest modification time until the total size is within the limit
+        ///
+        void evict() noexcept;
+
+    public:
+        static constexpr std::uint64_t ct_defaultSizeLimit { 1024ULL << 20U }; ///< Default cache size limit (1 GiB)
+
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// Design:
+        /// -# Assign the input parameters as below:
+        ///    -# @p directory - @ref ConversionCache::m_directory
+        ///    -# @p sizeLimit - @ref ConversionCache::m_sizeLimit
+        ///
+        ConversionCache(const std::string &directory, const std::uint64_t sizeLimit) : m_directory(directory),
+                                                                                       m_sizeLimit(sizeLimit)
+        {
+        }
+
+        ///
+        /// @brief Performs initialization steps of @ref ConversionCache that may fail
+        ///
+        /// @throws std::invalid_argument if @ref ConversionCache::m_directory cannot be created
+        ///
+        /// Design: Create @ref ConversionCache::m_directory if it does not exist
+        ///
+        void init();
+
+        ///
+        /// @brief Computes the cache key of a conversion
+        ///
+        /// @param[in] data Contents of the input file
+        /// @param[in] size Size of @p data in bytes
+        /// @param[in] args Arguments of the conversion
+        ///
+        /// Design:
+        /// -# Hash the conversion tuple of @p args (file and color formats, color matrix, raw dimensions,
+        ///    alpha handling and chroma filter) and a cache version with a 64bit xxHash
+        /// -# Hash @p data with the result as seed and return it as 16 hexadecimal digits
+        ///
+        /// @returns Cache key
+        ///
+        static std::string makeKey(const std::uint8_t *data, const std::size_t size,
+                                   const utils::InputArguments &args) noexcept;
+
+        ///
+        /// @brief Recreates @p outputFile from the entry of @p key, if present
+        ///
+        /// Design:
+        /// -# Return @false if there is no entry for @p key
+        /// -# Remove @p outputFile and invoke @ref ConversionCache::cloneFile from the entry
+        /// -# Refresh the modification time of the entry
+        ///
+        /// @returns @true on a cache hit, else @false
+        ///
+        bool fetch(const std::string &key, const std::string &outputFile) noexcept;
+
+        ///
+        /// @brief Adds @p outputFile as the entry of @p key
+        ///
+        /// Note: Failures are ignored, the cache is an optimization only
+        ///
+        /// Design:
+        /// -# Invoke @ref ConversionCache::cloneFile from @p outputFile to a read-only temporary file in
+        ///    @ref ConversionCache::m_directory and rename it to the entry, so that concurrent
+        ///    processes never see partial entries
+        /// -# Invoke @ref ConversionCache::evict
+        ///
+        void store(const std::string &key, const std::string &outputFile) noexcept;
+};
+
+} // namespace rgb2yuv
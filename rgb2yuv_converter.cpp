@@ -18,4 +18,533 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-// TODO
+#include "rgb2yuv_converter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <xmmintrin.h>
+
+#include "rgb2yuv_converter_kernels.hpp"
+#include "rgb2yuv_metrics.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+
+namespace rgb2yuv
+{
+
+bool Converter::isSupported(const utils::ColorFormat inputColorFormat,
+                            const utils::ColorFormat outputColorFormat) noexcept
+{
+    bool ret { false };
+
+    switch (outputColorFormat)
+    {
+        case(utils::ColorFormat::uyvy):
+        case(utils::ColorFormat::yuv420_nv12):
+        case(utils::ColorFormat::yuv444_packed):
+        case(utils::ColorFormat::yuv444_planar):
+        case(utils::ColorFormat::yuyv):
+            ret = (inputColorFormat == utils::ColorFormat::rgb888) || (inputColorFormat == utils::ColorFormat::rgba8888);
+            break;
+        case(utils::ColorFormat::yuv420_p010):
+        case(utils::ColorFormat::yuv420_p016):
+            ret = (inputColorFormat == utils::ColorFormat::rgb161616);
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+std::uint32_t Converter::getBytesPerPixel(const utils::ColorFormat colorFormat) noexcept
+{
+    std::uint32_t ret { 0U };
+
+    switch (colorFormat)
+    {
+        case(utils::ColorFormat::rgb888):
+            ret = 3U;
+            break;
+        case(utils::ColorFormat::rgba8888):
+            ret = 4U;
+            break;
+        case(utils::ColorFormat::rgb161616):
+            ret = 6U;
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+std::size_t Converter::getOutputSize(const utils::ColorFormat colorFormat, const std::uint32_t width,
+                                     const std::uint32_t height) noexcept
+{
+    const std::size_t numPixels { static_cast<std::size_t>(width) * height };
+    std::size_t ret { 0U };
+
+    switch (colorFormat)
+    {
+        case(utils::ColorFormat::rgb888):
+        case(utils::ColorFormat::yuv444_packed):
+        case(utils::ColorFormat::yuv444_planar):
+        case(utils::ColorFormat::yuv420_p010):
+        case(utils::ColorFormat::yuv420_p016):
+            // 4:2:0 with 16bit samples takes 2 * 1.5 bytes per pixel
+            ret = numPixels * 3U;
+            break;
+        case(utils::ColorFormat::rgb161616):
+            ret = numPixels * 6U;
+            break;
+        case(utils::ColorFormat::rgba8888):
+            ret = numPixels * 4U;
+            break;
+        case(utils::ColorFormat::uyvy):
+        case(utils::ColorFormat::yuyv):
+            ret = numPixels * 2U;
+            break;
+        case(utils::ColorFormat::yuv420_nv12):
+            ret = numPixels + numPixels / 2U;
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+void Converter::init()
+{
+    if (!isSupported(m_inputColorFormat, m_outputColorFormat)) {
+        throw std::invalid_argument("Conversion between the specified color formats is not supported!");
+    }
+
+    if ((m_numPyramidLevels == 0U) || (m_numPyramidLevels > ct_maxPyramidLevels)) {
+        throw std::invalid_argument("Unsupported number of pyramid levels!");
+    }
+
+    if ((m_numPyramidLevels > 1U) && (m_outputColorFormat != utils::ColorFormat::yuv420_nv12)) {
+        throw std::invalid_argument("Pyramids are only supported for yuv420_nv12 output!");
+    }
+
+    if ((m_alphaMode != utils::AlphaMode::drop) && (m_inputColorFormat != utils::ColorFormat::rgba8888)) {
+        throw std::invalid_argument("Alpha modes other than drop require rgba8888 input!");
+    }
+
+    if ((m_alphaMode == utils::AlphaMode::plane) && (m_numPyramidLevels > 1U)) {
+        throw std::invalid_argument("Alpha planes cannot be combined with pyramids!");
+    }
+
+    if (m_chromaFilter >= utils::ChromaFilter::unrecognized) {
+        throw std::invalid_argument("Unrecognized chroma filter!");
+    }
+
+    if ((m_chromaFilter != utils::ChromaFilter::box) && (m_numPyramidLevels > 1U)) {
+        throw std::invalid_argument("Chroma filters other than box cannot be combined with pyramids!");
+    }
+
+    const kernels::KernelEntry &kernels { kernels::getKernels(m_simdTier) };
+    m_convertRow = kernels.convertRow;
+    m_convertRowStream = kernels.convertRowStream;
+    m_convertRowStreamLuma = kernels.convertRowStreamLuma;
+    m_convertRow16 = kernels.convertRow16;
+    m_convertRowAlpha = kernels.convertRowAlpha;
+    m_subsampleChroma = kernels.subsampleChroma;
+    m_subsampleChroma16 = kernels.subsampleChroma16;
+    m_scratch.resize(m_threadPool.getNumThreads());
+}
+
+std::size_t Converter::getScratchRowSize(const std::uint32_t width) const noexcept
+{
+    constexpr std::size_t cacheLineSize { 64U };
+    const bool isHighBitDepth { (m_outputColorFormat == utils::ColorFormat::yuv420_p010) ||
+                                (m_outputColorFormat == utils::ColorFormat::yuv420_p016) };
+    const std::size_t rowSize { (isHighBitDepth ? 2U : 1U) * static_cast<std::size_t>(width) };
+    return (rowSize + cacheLineSize - 1U) / cacheLineSize * cacheLineSize;
+}
+
+std::size_t Converter::getScratchSize(const std::uint32_t width) const noexcept
+{
+    return (2U + 2U * ct_chromaRingRows) * getScratchRowSize(width) +
+           kernels::getChromaFilterScratchSize(width) * sizeof(std::int32_t);
+}
+
+void Converter::deinit() noexcept
+{
+    m_convertedData.clear();
+    m_convertedData.shrink_to_fit();
+    m_pyramid.clear();
+    m_scratch.clear();
+    m_convertedWidth = 0U;
+    m_convertedHeight = 0U;
+}
+
+void Converter::convertRows(const std::uint8_t *src, const std::size_t srcStride,
+                            const std::uint32_t width, const std::uint32_t height,
+                            const std::uint32_t firstRow, const std::uint32_t lastRow,
+                            const std::uint32_t firstColumn, const std::uint32_t lastColumn,
+                            std::vector<std::uint8_t> &scratch) noexcept
+{
+    const std::uint32_t bytesPerPixel { getBytesPerPixel(m_inputColorFormat) };
+    const std::uint32_t regionWidth { lastColumn - firstColumn };
+    const std::size_t planeSize { static_cast<std::size_t>(width) * height };
+    const std::size_t rowSize { getScratchRowSize(width) };
+    std::uint8_t *dst { m_convertedData.data() };
+    std::uint8_t *scratchY { scratch.data() };
+    std::uint8_t *scratchUv { scratchY + rowSize };
+    std::uint8_t *ringU { scratchUv + rowSize };
+    std::uint8_t *ringV { ringU + ct_chromaRingRows * rowSize };
+    std::uint8_t *filterScratch { ringV + ct_chromaRingRows * rowSize };
+    const kernels::ConvertRowFn planarRow { m_useStreamingStores ? m_convertRowStream : m_convertRow };
+    const kernels::ConvertRowFn lumaRow { m_useStreamingStores ? m_convertRowStreamLuma : m_convertRow };
+    std::uint8_t *alphaPlane { dst + getOutputSize(m_outputColorFormat, width, height) };
+    const std::uint32_t numFilterRows { kernels::getChromaFilterRows(m_chromaFilter, true) };
+    std::array<std::uint32_t, ct_chromaRingRows> ringRows { };
+    ringRows.fill(std::numeric_limits<std::uint32_t>::max());
+
+    // Converts a row with kernel, or with the alpha kernel (which has no non-temporal variants) if alpha is
+    // composited or extracted into a
+    const auto convertRow = [&](const kernels::ConvertRowFn kernel, const std::uint8_t *srcRow, std::uint8_t *y,
+                                std::uint8_t *u, std::uint8_t *v, std::uint8_t *a)
+    {
+        if (m_alphaMode == utils::AlphaMode::drop) {
+            kernel(srcRow, regionWidth, bytesPerPixel, m_colorMatrix, y, u, v);
+        } else {
+            m_convertRowAlpha(srcRow, regionWidth, m_alphaMode, m_background, m_colorMatrix, y, u, v, a);
+        }
+    };
+
+    // Returns the ring slots of the rows chroma row row / 2 is filtered from, top to bottom. Rows missing from
+    // the ring are converted by convertRingRow(row, slot, isInBand) first, rows outside the image are clamped.
+    const auto getFilterSlots = [&](const std::uint32_t row, const auto &convertRingRow)
+    {
+        std::array<std::uint32_t, kernels::ct_lanczosVerticalTaps.size()> slots { };
+        const std::int64_t firstFilterRow { static_cast<std::int64_t>(row) + 1 - numFilterRows / 2U };
+        for (std::uint32_t idx { 0U }; idx < numFilterRows; ++idx)
+        {
+            const std::uint32_t filterRow { static_cast<std::uint32_t>(std::min<std::int64_t>(
+                std::max<std::int64_t>(firstFilterRow + idx, 0), height - 1U)) };
+            slots[idx] = filterRow % ct_chromaRingRows;
+            if (ringRows[slots[idx]] != filterRow) {
+                convertRingRow(filterRow, slots[idx], (filterRow >= firstRow) && (filterRow < lastRow));
+                ringRows[slots[idx]] = filterRow;
+            }
+        }
+        return slots;
+    };
+
+    for (std::uint32_t row { firstRow }; row < lastRow; ++row)
+    {
+        const std::uint8_t *srcRow { src + row * srcStride + firstColumn * bytesPerPixel };
+        const std::size_t rowOffset { static_cast<std::size_t>(row) * width + firstColumn };
+
+        switch (m_outputColorFormat)
+        {
+            case(utils::ColorFormat::yuv444_planar):
+                convertRow(planarRow, srcRow, dst + rowOffset, dst + planeSize + rowOffset,
+                           dst + 2U * planeSize + rowOffset, alphaPlane + rowOffset);
+                break;
+            case(utils::ColorFormat::yuv444_packed):
+            {
+                convertRow(m_convertRow, srcRow, scratchY, ringU, ringV, alphaPlane + rowOffset);
+                std::uint8_t *dstRow { dst + rowOffset * 3U };
+                for (std::uint32_t x { 0U }; x < regionWidth; ++x)
+                {
+                    dstRow[3U * x] = scratchY[x];
+                    dstRow[3U * x + 1U] = ringU[x];
+                    dstRow[3U * x + 2U] = ringV[x];
+                }
+                break;
+            }
+            case(utils::ColorFormat::uyvy):
+            case(utils::ColorFormat::yuyv):
+            {
+                convertRow(m_convertRow, srcRow, scratchY, ringU, ringV, alphaPlane + rowOffset);
+                const std::uint8_t *uRow { ringU };
+                const std::uint8_t *vRow { ringV };
+                m_subsampleChroma(&uRow, &vRow, regionWidth, m_chromaFilter, false,
+                                  reinterpret_cast<std::int16_t *>(filterScratch), scratchUv);
+                // UYVY interleaves the bytes of the U and V pairs with Y, YUYV Y with the pairs
+                const bool isUyvy { m_outputColorFormat == utils::ColorFormat::uyvy };
+                const std::uint8_t *even { isUyvy ? scratchUv : scratchY };
+                const std::uint8_t *odd { isUyvy ? scratchY : scratchUv };
+                std::uint8_t *dstRow { dst + rowOffset * 2U };
+                for (std::uint32_t x { 0U }; x < regionWidth; ++x)
+                {
+                    dstRow[2U * x] = even[x];
+                    dstRow[2U * x + 1U] = odd[x];
+                }
+                break;
+            }
+            case(utils::ColorFormat::yuv420_nv12):
+            {
+                // Rows are processed in pairs, the second row of the pair is converted with the filter rows.
+                // Luma of rows outside the band goes to scratch.
+                const auto convertRingRow = [&](const std::uint32_t ringRow, const std::uint32_t slot, const bool isInBand)
+                {
+                    const std::size_t ringRowOffset { static_cast<std::size_t>(ringRow) * width + firstColumn };
+                    convertRow(lumaRow, src + ringRow * srcStride + firstColumn * bytesPerPixel,
+                               isInBand ? dst + ringRowOffset : scratchY, ringU + slot * rowSize, ringV + slot * rowSize,
+                               isInBand ? alphaPlane + ringRowOffset : scratchUv);
+                };
+                const auto slots { getFilterSlots(row, convertRingRow) };
+                std::array<const std::uint8_t *, kernels::ct_lanczosVerticalTaps.size()> uRows { };
+                std::array<const std::uint8_t *, kernels::ct_lanczosVerticalTaps.size()> vRows { };
+                for (std::uint32_t idx { 0U }; idx < numFilterRows; ++idx)
+                {
+                    uRows[idx] = ringU + slots[idx] * rowSize;
+                    vRows[idx] = ringV + slots[idx] * rowSize;
+                }
+                m_subsampleChroma(uRows.data(), vRows.data(), regionWidth, m_chromaFilter, true,
+                                  reinterpret_cast<std::int16_t *>(filterScratch),
+                                  dst + planeSize + (row / 2U) * width + firstColumn);
+                ++row;
+                break;
+            }
+            case(utils::ColorFormat::yuv420_p010):
+            case(utils::ColorFormat::yuv420_p016):
+            {
+                // As NV12, with 16bit samples. Chroma is filtered at the significant bits, so that P010
+                // rounds as a 10bit 4:2:0 subsampling would.
+                const std::uint32_t bitDepth { (m_outputColorFormat == utils::ColorFormat::yuv420_p010) ? 10U : 16U };
+                std::uint16_t *dst16 { reinterpret_cast<std::uint16_t *>(dst) };
+                const auto convertRingRow = [&](const std::uint32_t ringRow, const std::uint32_t slot, const bool isInBand)
+                {
+                    const std::size_t ringRowOffset { static_cast<std::size_t>(ringRow) * width + firstColumn };
+                    m_convertRow16(reinterpret_cast<const std::uint16_t *>(src + ringRow * srcStride + firstColumn * bytesPerPixel),
+                                   regionWidth, bitDepth, m_colorMatrix,
+                                   isInBand ? dst16 + ringRowOffset : reinterpret_cast<std::uint16_t *>(scratchY),
+                                   reinterpret_cast<std::uint16_t *>(ringU + slot * rowSize),
+                                   reinterpret_cast<std::uint16_t *>(ringV + slot * rowSize));
+                };
+                const auto slots { getFilterSlots(row, convertRingRow) };
+                std::array<const std::uint16_t *, kernels::ct_lanczosVerticalTaps.size()> uRows { };
+                std::array<const std::uint16_t *, kernels::ct_lanczosVerticalTaps.size()> vRows { };
+                for (std::uint32_t idx { 0U }; idx < numFilterRows; ++idx)
+                {
+                    uRows[idx] = reinterpret_cast<const std::uint16_t *>(ringU + slots[idx] * rowSize);
+                    vRows[idx] = reinterpret_cast<const std::uint16_t *>(ringV + slots[idx] * rowSize);
+                }
+                m_subsampleChroma16(uRows.data(), vRows.data(), regionWidth, m_chromaFilter, true, bitDepth,
+                                    reinterpret_cast<std::int32_t *>(filterScratch),
+                                    dst16 + planeSize + (row / 2U) * width + firstColumn);
+                ++row;
+                break;
+            }
+            default:
+                // Unreachable. Do nothing
+                break;
+        }
+    }
+
+    if (m_useStreamingStores) {
+        // Non-temporal stores are weakly ordered, make them globally visible before the band is reported done
+        _mm_sfence();
+    }
+}
+
+void Converter::downscaleRows(const std::uint32_t level, const std::uint32_t width, const std::uint32_t height,
+                              const std::uint32_t firstRow, const std::uint32_t lastRow) noexcept
+{
+    const std::uint32_t srcWidth { width >> (level - 1U) };
+    const std::uint32_t srcHeight { height >> (level - 1U) };
+    const std::uint32_t dstWidth { width >> level };
+    const std::uint32_t dstHeight { height >> level };
+    const std::uint8_t *src { (level == 1U) ? m_convertedData.data() : m_pyramid[level - 2U].data() };
+    std::uint8_t *dst { m_pyramid[level - 1U].data() };
+
+    for (std::uint32_t row { firstRow }; row < lastRow; ++row)
+    {
+        const std::uint8_t *srcRow { src + 2U * static_cast<std::size_t>(row) * srcWidth };
+        std::uint8_t *dstRow { dst + static_cast<std::size_t>(row) * dstWidth };
+        for (std::uint32_t x { 0U }; x < dstWidth; ++x)
+        {
+            dstRow[x] = static_cast<std::uint8_t>((srcRow[2U * x] + srcRow[2U * x + 1U] + srcRow[srcWidth + 2U * x] +
+                                                   srcRow[srcWidth + 2U * x + 1U] + 2U) >> 2U);
+        }
+    }
+
+    // Chroma rows hold interleaved U and V samples, so neighbouring samples of a plane are 2 bytes apart
+    const std::uint8_t *srcChroma { src + static_cast<std::size_t>(srcWidth) * srcHeight };
+    std::uint8_t *dstChroma { dst + static_cast<std::size_t>(dstWidth) * dstHeight };
+    for (std::uint32_t row { firstRow / 2U }; row < lastRow / 2U; ++row)
+    {
+        const std::uint8_t *srcRow { srcChroma + 2U * static_cast<std::size_t>(row) * srcWidth };
+        std::uint8_t *dstRow { dstChroma + static_cast<std::size_t>(row) * dstWidth };
+        for (std::uint32_t x { 0U }; x < dstWidth; x += 2U)
+        {
+            for (std::uint32_t plane { 0U }; plane < 2U; ++plane)
+            {
+                const std::uint32_t srcX { 2U * x + plane };
+                dstRow[x + plane] = static_cast<std::uint8_t>((srcRow[srcX] + srcRow[srcX + 2U] + srcRow[srcWidth + srcX] +
+                                                               srcRow[srcWidth + srcX + 2U] + 2U) >> 2U);
+            }
+        }
+    }
+}
+
+void Converter::verifyDimensions(const std::uint32_t width, const std::uint32_t height) const
+{
+    const bool isSubsampledVertically { (m_outputColorFormat == utils::ColorFormat::yuv420_nv12) ||
+                                        (m_outputColorFormat == utils::ColorFormat::yuv420_p010) ||
+                                        (m_outputColorFormat == utils::ColorFormat::yuv420_p016) };
+    const bool isSubsampledHorizontally { (m_outputColorFormat == utils::ColorFormat::uyvy) ||
+                                          (m_outputColorFormat == utils::ColorFormat::yuyv) || isSubsampledVertically };
+
+    if ((width == 0U) || (height == 0U)) {
+        throw std::invalid_argument("Cannot convert an empty image!");
+    }
+
+    if ((isSubsampledHorizontally && ((width % 2U) != 0U)) || (isSubsampledVertically && ((height % 2U) != 0U))) {
+        throw std::invalid_argument("Image dimensions must be even for chroma subsampled output color formats!");
+    }
+
+    const std::uint32_t pyramidAlignment { 1U << m_numPyramidLevels };
+    if ((m_numPyramidLevels > 1U) && (((width % pyramidAlignment) != 0U) || ((height % pyramidAlignment) != 0U))) {
+        throw std::invalid_argument("Image dimensions must be divisible by 2 ^ number of pyramid levels!");
+    }
+}
+
+void Converter::allocate(const std::uint32_t width, const std::uint32_t height)
+{
+    // FrameBuffer does not zero fill, so unless prefaulted the output pages are first-touched by the
+    // worker that writes them
+    const std::size_t alphaPlaneSize { (m_alphaMode == utils::AlphaMode::plane) ? static_cast<std::size_t>(width) * height : 0U };
+    m_convertedData.resize(getOutputSize(m_outputColorFormat, width, height) + alphaPlaneSize);
+    m_pyramid.resize(m_numPyramidLevels - 1U);
+    for (std::uint32_t level { 1U }; level < m_numPyramidLevels; ++level)
+    {
+        m_pyramid[level - 1U].resize(getOutputSize(m_outputColorFormat, width >> level, height >> level));
+    }
+}
+
+void Converter::beginConvert(const std::uint32_t width, const std::uint32_t height)
+{
+    verifyDimensions(width, height);
+
+    allocate(width, height);
+    const std::size_t outputSize { m_convertedData.size() };
+    const std::size_t inputSize { static_cast<std::size_t>(width) * height * getBytesPerPixel(m_inputColorFormat) };
+    m_useStreamingStores = (m_numPyramidLevels == 1U) && ((inputSize + outputSize) >= m_streamingThreshold);
+}
+
+void Converter::convertBand(const std::uint8_t *src, const std::size_t srcStride, const std::uint32_t width,
+                            const std::uint32_t height, const std::uint32_t firstRow, const std::uint32_t lastRow,
+                            std::vector<std::uint8_t> &scratch)
+{
+    scratch.resize(getScratchSize(width));
+    convertRows(src, srcStride, width, height, firstRow, lastRow, 0U, width, scratch);
+    for (std::uint32_t level { 1U }; level < m_numPyramidLevels; ++level)
+    {
+        downscaleRows(level, width, height, firstRow >> level, lastRow >> level);
+    }
+}
+
+FrameBuffer &Converter::endConvert(const std::uint32_t width, const std::uint32_t height) noexcept
+{
+    m_convertedWidth = width;
+    m_convertedHeight = height;
+    m_numDirtyTiles = 0U;
+    Metrics::recordFrame(m_simdTier, static_cast<std::uint64_t>(width) * height);
+    return m_convertedData;
+}
+
+FrameBuffer &Converter::convert(const std::uint8_t *src, const std::size_t srcStride,
+                                const std::uint32_t width, const std::uint32_t height)
+{
+    beginConvert(width, height);
+    const std::uint32_t numThreads { m_threadPool.getNumThreads() };
+    const std::uint32_t bandAlignment { getBandAlignment() };
+
+    if (m_threadPool.isPinned()) {
+        // One band per pinned worker, matching the bands first-touched by rgb2yuv::Decoder, so that
+        // every worker reads and writes memory on its own NUMA node
+        m_threadPool.parallelFor(numThreads, [&](const std::uint32_t bandIdx, const std::uint32_t workerIdx)
+        {
+            const auto band { ThreadPool::getBand(height, numThreads, bandIdx, bandAlignment) };
+            convertBand(src, srcStride, width, height, band.first, band.second, m_scratch[workerIdx]);
+        }, ThreadPool::Schedule::fixed);
+    } else {
+        // Split the image into a few bands per worker so that uneven bands balance out, unless tuned
+        std::uint32_t bandRows { (m_bandRows != 0U) ? m_bandRows : std::max(1U, height / (numThreads * 4U)) };
+        bandRows = ((bandRows + bandAlignment - 1U) / bandAlignment) * bandAlignment;
+        const std::uint32_t numBands { (height + bandRows - 1U) / bandRows };
+
+        m_threadPool.parallelFor(numBands, [&](const std::uint32_t bandIdx, const std::uint32_t workerIdx)
+        {
+            const std::uint32_t firstRow { bandIdx * bandRows };
+            convertBand(src, srcStride, width, height, firstRow, std::min(height, firstRow + bandRows),
+                        m_scratch[workerIdx]);
+        });
+    }
+
+    return endConvert(width, height);
+}
+
+FrameBuffer &Converter::convertDirty(const std::uint8_t *src, const std::uint8_t *previousSrc,
+                                     const std::size_t srcStride, const std::uint32_t width,
+                                     const std::uint32_t height)
+{
+    if ((width != m_convertedWidth) || (height != m_convertedHeight) || (m_numPyramidLevels > 1U) ||
+        (m_chromaFilter != utils::ChromaFilter::box)) {
+        return convert(src, srcStride, width, height);
+    }
+
+    // Tiles patch the retained output, which is read again by the encoder and the next frame
+    m_useStreamingStores = false;
+    const std::size_t bytesPerPixel { getBytesPerPixel(m_inputColorFormat) };
+    const std::size_t scratchSize { getScratchSize(width) };
+    const std::uint32_t numTileRows { (height + ct_tileHeight - 1U) / ct_tileHeight };
+    const std::uint32_t numTileColumns { (width + ct_tileWidth - 1U) / ct_tileWidth };
+    std::atomic<std::uint32_t> numDirtyTiles { 0U };
+
+    m_threadPool.parallelFor(numTileRows, [&](const std::uint32_t tileRow, const std::uint32_t workerIdx)
+    {
+        const std::uint32_t firstRow { tileRow * ct_tileHeight };
+        const std::uint32_t lastRow { std::min(height, firstRow + ct_tileHeight) };
+        std::uint32_t numDirtyTilesInRow { 0U };
+        std::uint32_t dirtyColumn { 0U };
+        bool isPreviousDirty { false };
+        m_scratch[workerIdx].resize(scratchSize);
+
+        // Runs of dirty tiles within the row of tiles are converted at once
+        for (std::uint32_t tileColumn { 0U }; tileColumn <= numTileColumns; ++tileColumn)
+        {
+            const std::uint32_t firstColumn { std::min(width, tileColumn * ct_tileWidth) };
+            const std::uint32_t lastColumn { std::min(width, firstColumn + ct_tileWidth) };
+            const std::size_t offset { firstColumn * bytesPerPixel };
+            const std::size_t tileBytes { (lastColumn - firstColumn) * bytesPerPixel };
+            bool isDirty { false };
+            for (std::uint32_t row { firstRow }; !isDirty && (row < lastRow) && (tileBytes != 0U); ++row)
+            {
+                isDirty = std::memcmp(src + row * srcStride + offset, previousSrc + row * srcStride + offset,
+                                      tileBytes) != 0;
+            }
+
+            if (isDirty && !isPreviousDirty) {
+                dirtyColumn = firstColumn;
+            } else if (!isDirty && isPreviousDirty) {
+                convertRows(src, srcStride, width, height, firstRow, lastRow, dirtyColumn, firstColumn,
+                            m_scratch[workerIdx]);
+            }
+            numDirtyTilesInRow += isDirty ? 1U : 0U;
+            isPreviousDirty = isDirty;
+        }
+        numDirtyTiles += numDirtyTilesInRow;
+    });
+
+    m_numDirtyTiles = numDirtyTiles.load();
+    Metrics::recordFrame(m_simdTier, static_cast<std::uint64_t>(width) * height);
+    return m_convertedData;
+}
+
+} // namespace rgb2yuv
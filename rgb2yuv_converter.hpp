@@ -20,12 +20,375 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "rgb2yuv_converter_kernels.hpp"
+#include "rgb2yuv_frame_buffer.hpp"
+#include "rgb2yuv_utils.hpp"
+
 namespace rgb2yuv
 {
 
+class ThreadPool;
+
 class Converter
 {
-    // TODO;
+    private:
+        const utils::ColorFormat m_inputColorFormat; ///< Format of the color data to be converted
+        const utils::ColorFormat m_outputColorFormat; ///< Format of the converted color data
+        const utils::ColorMatrix m_colorMatrix; ///< Matrix used for conversion
+        const utils::SimdTier m_simdTier; ///< SIMD tier of the kernels used for conversion
+        ThreadPool &m_threadPool; ///< Workers the conversion is distributed on
+        const std::size_t m_streamingThreshold; ///< Working set size in bytes from which non-temporal stores are used
+        const std::uint32_t m_numPyramidLevels; ///< Number of resolution levels produced by @ref Converter::convert, 1 for none
+        const utils::AlphaMode m_alphaMode; ///< Handling of the alpha component of @ref utils::ColorFormat::rgba8888 input
+        const std::uint32_t m_background; ///< Background color 0xRRGGBB for @ref utils::AlphaMode::composite
+        const utils::ChromaFilter m_chromaFilter; ///< Filter subsampling chroma for 4:2:2 and 4:2:0 outputs
+        const std::uint32_t m_bandRows; ///< Rows per band of @ref Converter::convert, 0 for a few bands per worker
+        kernels::ConvertRowFn m_convertRow { nullptr }; ///< Row kernel selected from @ref kernels::ct_dispatchTable
+        kernels::ConvertRowFn m_convertRowStream { nullptr }; ///< Non-temporal variant of @ref Converter::m_convertRow
+        kernels::ConvertRowFn m_convertRowStreamLuma { nullptr }; ///< Luma only non-temporal variant of @ref Converter::m_convertRow
+        kernels::ConvertRow16Fn m_convertRow16 { nullptr }; ///< 16bit row kernel selected from @ref kernels::ct_dispatchTable
+        kernels::ConvertRowAlphaFn m_convertRowAlpha { nullptr }; ///< Alpha row kernel selected from @ref kernels::ct_dispatchTable
+        kernels::SubsampleChromaFn m_subsampleChroma { nullptr }; ///< Chroma subsampling kernel selected from @ref kernels::ct_dispatchTable
+        kernels::SubsampleChroma16Fn m_subsampleChroma16 { nullptr }; ///< 16bit chroma subsampling kernel selected from @ref kernels::ct_dispatchTable
+        bool m_useStreamingStores { false }; ///< Specifies if the current @ref Converter::convert uses non-temporal stores
+        std::uint32_t m_convertedWidth { 0U }; ///< Width of the image in @ref Converter::m_convertedData
+        std::uint32_t m_convertedHeight { 0U }; ///< Height of the image in @ref Converter::m_convertedData
+        std::uint32_t m_numDirtyTiles { 0U }; ///< Number of tiles converted by the last @ref Converter::convertDirty
+        FrameBuffer m_convertedData { }; ///< Container for the converted color data
+        std::vector<FrameBuffer> m_pyramid { }; ///< Containers for the pyramid levels 1, 2, ... of @ref Converter::m_convertedData
+        std::vector<std::vector<std::uint8_t>> m_scratch { }; ///< Per worker scratch rows holding full resolution Y, U and V
+
+        static constexpr std::uint32_t ct_chromaRingRows { 8U }; ///< Full resolution chroma rows cached by @ref Converter::convertRows,
+                                                                 ///< a power of 2 above the rows of the vertical chroma filter
+
+        ///
+        /// @brief Returns the size in bytes of a scratch row of @p width samples, rounded up to a cache line
+        ///
+        /// Design: 16bit samples for @ref utils::ColorFormat::yuv420_p010 and @ref utils::ColorFormat::yuv420_p016,
+        ///         else 8bit samples
+        ///
+        std::size_t getScratchRowSize(const std::uint32_t width) const noexcept;
+
+        ///
+        /// @brief Returns the size in bytes of the scratch @ref Converter::convertRows needs for @p width pixels
+        ///
+        /// Design: In this order, a Y row, a row of subsampled U and V pairs, @ref Converter::ct_chromaRingRows U rows,
+        ///         as many V rows (see @ref Converter::getScratchRowSize) and the 32bit scratch of the chroma
+        ///         subsampling kernels
+        ///
+        std::size_t getScratchSize(const std::uint32_t width) const noexcept;
+
+        ///
+        /// @brief Check if the conversion from @p inputColorFormat to @p outputColorFormat is supported
+        ///
+        /// Design:
+        /// -# Return true if @p inputColorFormat is one of the following:
+        ///    -# @ref utils::ColorFormat::rgb888
+        ///    -# @ref utils::ColorFormat::rgba8888
+        /// -# and @p outputColorFormat is one of the following:
+        ///    -# @ref utils::ColorFormat::uyvy
+        ///    -# @ref utils::ColorFormat::yuv420_nv12
+        ///    -# @ref utils::ColorFormat::yuv444_packed
+        ///    -# @ref utils::ColorFormat::yuv444_planar
+        ///    -# @ref utils::ColorFormat::yuyv
+        /// -# Return true if @p inputColorFormat is @ref utils::ColorFormat::rgb161616 and @p outputColorFormat
+        ///    is @ref utils::ColorFormat::yuv420_p010 or @ref utils::ColorFormat::yuv420_p016
+        /// -# Return false otherwise
+        ///
+        /// @returns @true if the conversion is supported, else @false
+        ///
+        static bool isSupported(const utils::ColorFormat inputColorFormat,
+                                const utils::ColorFormat outputColorFormat) noexcept;
+
+        ///
+        /// @brief Verifies that the image dimensions are supported by @ref Converter::m_outputColorFormat
+        ///
+        /// @throws std::invalid_argument if @p width or @p height is 0, if @p width is odd for 4:2:2 and
+        ///         4:2:0 outputs (NV12, P010 and P016), if @p height is odd for 4:2:0 outputs or if the smallest pyramid level
+        ///         would have odd dimensions
+        ///
+        void verifyDimensions(const std::uint32_t width, const std::uint32_t height) const;
+
+        ///
+        /// @brief Converts the columns [@p firstColumn, @p lastColumn) of the rows [@p firstRow, @p lastRow)
+        ///        of the input image
+        ///
+        /// @param[in] src Pointer to the first row of the input image
+        /// @param[in] srcStride Distance in bytes between two consecutive input rows
+        /// @param[in] width Width of the image in pixels
+        /// @param[in] height Height of the image in pixels
+        /// @param[in] firstRow First row to be converted (even for @ref utils::ColorFormat::yuv420_nv12)
+        /// @param[in] lastRow One past the last row to be converted
+        /// @param[in] firstColumn First column to be converted (even for chroma subsampled outputs)
+        /// @param[in] lastColumn One past the last column to be converted
+        /// @param[in, out] scratch Scratch buffer of at least @ref Converter::getScratchSize bytes
+        ///
+        /// Design:
+        /// -# For every row, compute full resolution Y, U and V with @ref Converter::m_convertRow
+        ///    -# Write them directly into the planes for @ref utils::ColorFormat::yuv444_planar
+        ///    -# Write Y directly into the luma plane and U and V into a ring of @ref Converter::ct_chromaRingRows
+        ///       rows in @p scratch for @ref utils::ColorFormat::yuv420_nv12, then subsample the rows of a chroma
+        ///       row from the ring into the chroma plane with @ref Converter::m_subsampleChroma. Rows above and below
+        ///       the band, read by the taps of the vertical filter, are converted into @p scratch only and clamped
+        ///       to the image.
+        ///    -# Use @ref Converter::m_convertRowAlpha instead of @ref Converter::m_convertRow (and its non-temporal
+        ///       variants) unless @ref Converter::m_alphaMode is @ref utils::AlphaMode::drop, which composites
+        ///       or extracts alpha in the same pass. The alpha plane follows the YUV data.
+        ///    -# Likewise with @ref Converter::m_convertRow16 and @ref Converter::m_subsampleChroma16 for
+        ///       @ref utils::ColorFormat::yuv420_p010 and @ref utils::ColorFormat::yuv420_p016, subsampling at the
+        ///       significant bits of the samples
+        ///    -# Else store them in @p scratch and pack them into @ref Converter::m_convertedData, subsampling
+        ///       chroma horizontally with @ref Converter::m_subsampleChroma for 4:2:2 outputs
+        /// -# If @ref Converter::m_useStreamingStores is set, use @ref Converter::m_convertRowStream for the planar
+        ///    rows and @ref Converter::m_convertRowStreamLuma for the NV12 luma rows, and issue a store fence at
+        ///    the end of the band so that its data is visible once the band completes
+        ///
+        void convertRows(const std::uint8_t *src, const std::size_t srcStride,
+                         const std::uint32_t width, const std::uint32_t height,
+                         const std::uint32_t firstRow, const std::uint32_t lastRow,
+                         const std::uint32_t firstColumn, const std::uint32_t lastColumn,
+                         std::vector<std::uint8_t> &scratch) noexcept;
+
+        ///
+        /// @brief Downscales the rows [@p firstRow, @p lastRow) of pyramid level @p level from level @p level - 1
+        ///
+        /// @param[in] level Pyramid level to be written, at least 1
+        /// @param[in] width Width of level 0 in pixels
+        /// @param[in] height Height of level 0 in pixels
+        /// @param[in] firstRow First row of level @p level to be written (even)
+        /// @param[in] lastRow One past the last row of level @p level to be written (even)
+        ///
+        /// Design: Average every 2x2 block of the luma plane and every 2x2 block of U and V samples of the
+        ///         interleaved chroma plane, rounding as the 4:2:0 subsampling in @ref Converter::convertRows
+        ///
+        void downscaleRows(const std::uint32_t level, const std::uint32_t width, const std::uint32_t height,
+                           const std::uint32_t firstRow, const std::uint32_t lastRow) noexcept;
+
+    public:
+        static constexpr std::uint32_t ct_tileWidth { 64U }; ///< Width in pixels of the tiles compared by @ref Converter::convertDirty
+        static constexpr std::uint32_t ct_tileHeight { 16U }; ///< Height in pixels of the tiles compared by @ref Converter::convertDirty
+        static constexpr std::uint32_t ct_maxPyramidLevels { 8U }; ///< Maximum number of pyramid levels, including full resolution
+
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// Design:
+        /// -# Assign the input parameters as below:
+        ///    -# @p inputColorFormat - @ref Converter::m_inputColorFormat
+        ///    -# @p outputColorFormat - @ref Converter::m_outputColorFormat
+        ///    -# @p colorMatrix - @ref Converter::m_colorMatrix
+        ///    -# @p simdTier - @ref Converter::m_simdTier
+        ///    -# @p threadPool - @ref Converter::m_threadPool
+        ///    -# @p streamingThreshold - @ref Converter::m_streamingThreshold
+        ///    -# @p numPyramidLevels - @ref Converter::m_numPyramidLevels
+        ///    -# @p alphaMode - @ref Converter::m_alphaMode
+        ///    -# @p background - @ref Converter::m_background
+        ///    -# @p chromaFilter - @ref Converter::m_chromaFilter
+        ///    -# @p bandRows - @ref Converter::m_bandRows
+        ///
+        Converter(const utils::ColorFormat inputColorFormat, const utils::ColorFormat outputColorFormat,
+                  const utils::ColorMatrix colorMatrix, const utils::SimdTier simdTier, ThreadPool &threadPool,
+                  const std::size_t streamingThreshold = std::numeric_limits<std::size_t>::max(),
+                  const std::uint32_t numPyramidLevels = 1U,
+                  const utils::AlphaMode alphaMode = utils::AlphaMode::drop, const std::uint32_t background = 0U,
+                  const utils::ChromaFilter chromaFilter = utils::ChromaFilter::box, const std::uint32_t bandRows = 0U) :
+                  m_inputColorFormat(inputColorFormat),
+                  m_outputColorFormat(outputColorFormat),
+                  m_colorMatrix(colorMatrix),
+                  m_simdTier(simdTier),
+                  m_threadPool(threadPool),
+                  m_streamingThreshold(streamingThreshold),
+                  m_numPyramidLevels(numPyramidLevels),
+                  m_alphaMode(alphaMode),
+                  m_background(background),
+                  m_chromaFilter(chromaFilter),
+                  m_bandRows(bandRows)
+        {
+        }
+
+        ///
+        /// @brief Performs initialization steps of @ref Converter that may fail
+        ///
+        /// @throws std::invalid_argument if the conversion from @ref Converter::m_inputColorFormat to
+        ///         @ref Converter::m_outputColorFormat is not supported, or if @ref Converter::m_numPyramidLevels
+        ///         is not in [1, @ref Converter::ct_maxPyramidLevels] or above 1 for outputs other than
+        ///         @ref utils::ColorFormat::yuv420_nv12, or if @ref Converter::m_alphaMode or
+        ///         @ref Converter::m_chromaFilter is not supported
+        ///
+        /// Design:
+        /// -# Invoke @ref Converter::isSupported
+        ///    -# Throw std::invalid_argument if @false is returned
+        /// -# Verify @ref Converter::m_numPyramidLevels
+        /// -# Verify that @ref Converter::m_alphaMode is @ref utils::AlphaMode::drop unless the input is
+        ///    @ref utils::ColorFormat::rgba8888, and not @ref utils::AlphaMode::plane for pyramids
+        /// -# Verify that @ref Converter::m_chromaFilter is recognized, and @ref utils::ChromaFilter::box for pyramids,
+        ///    whose levels are box filtered from level 0
+        /// -# Select the row kernels (8bit, 16bit and alpha) and the chroma subsampling kernels of
+        ///    @ref Converter::m_simdTier from @ref kernels::ct_dispatchTable
+        ///
+        void init();
+
+        ///
+        /// @brief Releases the memory held by @ref Converter
+        ///
+        void deinit() noexcept;
+
+        ///
+        /// @brief Allocates the output of an image of @p width x @p height pixels ahead of @ref Converter::convert
+        ///
+        /// Design: Resize @ref Converter::m_convertedData and every level of @ref Converter::m_pyramid to
+        ///         @ref Converter::getOutputSize, plus a @p width x @p height alpha plane for
+        ///         @ref utils::AlphaMode::plane. Invoking it before @ref Converter::convert keeps page faults
+        ///         of prefaulted allocations out of the conversion.
+        ///
+        void allocate(const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Converts an image from @ref Converter::m_inputColorFormat to @ref Converter::m_outputColorFormat
+        ///
+        /// @param[in] src Pointer to the first row of the input image
+        /// @param[in] srcStride Distance in bytes between two consecutive input rows
+        /// @param[in] width Width of the image in pixels
+        /// @param[in] height Height of the image in pixels
+        ///
+        /// @throws std::invalid_argument if @p width or @p height is not supported by @ref Converter::m_outputColorFormat
+        ///
+        /// Design:
+        /// -# Invoke @ref Converter::beginConvert
+        /// -# Split the image into bands of @ref Converter::getBandAlignment rows and invoke
+        ///    @ref Converter::convertBand for each band on @ref Converter::m_threadPool
+        ///    -# If the workers are pinned, use one band per worker from @ref ThreadPool::getBand with
+        ///       @ref ThreadPool::Schedule::fixed, so that the bands first-touched by the worker are the ones it converts
+        ///    -# Else use bands of @ref Converter::m_bandRows rows, or a few bands per worker if it is 0, with
+        ///       @ref ThreadPool::Schedule::dynamic
+        /// -# Invoke @ref Converter::endConvert
+        ///
+        /// @returns Reference to @ref Converter::m_convertedData
+        ///
+        FrameBuffer &convert(const std::uint8_t *src, const std::size_t srcStride,
+                             const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Prepares the conversion of an image whose bands are then converted by the caller
+        ///
+        /// @throws std::invalid_argument if @p width or @p height is not supported by @ref Converter::m_outputColorFormat
+        ///
+        /// Design:
+        /// -# Invoke @ref Converter::verifyDimensions
+        /// -# Invoke @ref Converter::allocate
+        /// -# Set @ref Converter::m_useStreamingStores if the input and output together take at least
+        ///    @ref Converter::m_streamingThreshold bytes, i.e. the output would be evicted from the
+        ///    cache before it is read again anyway. Never set it for pyramids, whose levels are read back.
+        ///
+        void beginConvert(const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Converts the rows [@p firstRow, @p lastRow) of an image prepared by @ref Converter::beginConvert
+        ///
+        /// @param[in] src Pointer to the first row of the input image
+        /// @param[in] srcStride Distance in bytes between two consecutive input rows
+        /// @param[in] width Width of the image in pixels
+        /// @param[in] height Height of the image in pixels
+        /// @param[in] firstRow First row of the band, a multiple of @ref Converter::getBandAlignment
+        /// @param[in] lastRow One past the last row of the band, a multiple of @ref Converter::getBandAlignment
+        ///            unless it is @p height
+        /// @param[in, out] scratch Scratch rows of the calling thread, resized as needed
+        ///
+        /// Design:
+        /// -# Invoke @ref Converter::convertRows on the band, followed by @ref Converter::downscaleRows for
+        ///    every further pyramid level while the band is still in cache
+        ///
+        /// Distinct bands may be converted concurrently.
+        ///
+        void convertBand(const std::uint8_t *src, const std::size_t srcStride, const std::uint32_t width,
+                         const std::uint32_t height, const std::uint32_t firstRow, const std::uint32_t lastRow,
+                         std::vector<std::uint8_t> &scratch);
+
+        ///
+        /// @brief Completes a conversion once every band has been converted by @ref Converter::convertBand
+        ///
+        /// Design: Record the frame with @ref rgb2yuv::Metrics::recordFrame, once per frame rather than per band
+        ///
+        /// @returns Reference to @ref Converter::m_convertedData
+        ///
+        FrameBuffer &endConvert(const std::uint32_t width, const std::uint32_t height) noexcept;
+
+        ///
+        /// @brief Returns the row alignment of the bands passed to @ref Converter::convertBand
+        ///
+        /// Design: 2 ^ @ref Converter::m_numPyramidLevels, so that every pyramid level of a band holds whole chroma rows
+        ///
+        std::uint32_t getBandAlignment() const noexcept
+        {
+            return 2U << (m_numPyramidLevels - 1U);
+        }
+
+        ///
+        /// @brief Converts the next frame of a sequence, reconverting only the tiles that differ from the previous frame
+        ///
+        /// @param[in] src Pointer to the first row of the input frame
+        /// @param[in] previousSrc Pointer to the first row of the previous input frame, whose conversion is
+        ///            held in @ref Converter::m_convertedData
+        /// @param[in] srcStride Distance in bytes between two consecutive rows of @p src and @p previousSrc
+        /// @param[in] width Width of the frame in pixels
+        /// @param[in] height Height of the frame in pixels
+        ///
+        /// @throws std::invalid_argument if @p width or @p height is not supported by @ref Converter::m_outputColorFormat
+        ///
+        /// Design:
+        /// -# Invoke @ref Converter::convert if the dimensions differ from the last converted image,
+        ///    if a pyramid is produced or if @ref Converter::m_chromaFilter is not @ref utils::ChromaFilter::box,
+        ///    whose taps would reach beyond the changed tiles
+        /// -# Split the frame into tiles of @ref Converter::ct_tileWidth x @ref Converter::ct_tileHeight pixels.
+        ///    Both are even, so that tiles never split a chroma block.
+        /// -# On @ref Converter::m_threadPool, compare every tile of a row of tiles with the previous frame
+        ///    (memcmp, vectorized by the C library) and invoke @ref Converter::convertRows on every run of
+        ///    consecutive changed tiles, patching @ref Converter::m_convertedData in place
+        /// -# Record the frame with @ref rgb2yuv::Metrics::recordFrame
+        ///
+        /// @returns Reference to @ref Converter::m_convertedData
+        ///
+        FrameBuffer &convertDirty(const std::uint8_t *src, const std::uint8_t *previousSrc, const std::size_t srcStride,
+                                  const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Returns the pyramid levels 1, 2, ... produced by the last @ref Converter::convert
+        ///
+        /// Design: Level k holds the image downscaled by 2 ^ k in both dimensions
+        ///
+        const std::vector<FrameBuffer> &getPyramid() const noexcept
+        {
+            return m_pyramid;
+        }
+
+        ///
+        /// @brief Returns the number of tiles reconverted by the last @ref Converter::convertDirty
+        ///
+        std::uint32_t getNumDirtyTiles() const noexcept
+        {
+            return m_numDirtyTiles;
+        }
+
+        ///
+        /// @brief Returns the number of bytes an image of @p width x @p height pixels occupies in @p colorFormat
+        ///
+        /// @returns Size in bytes, 0 for formats without a defined layout
+        ///
+        static std::size_t getOutputSize(const utils::ColorFormat colorFormat, const std::uint32_t width,
+                                         const std::uint32_t height) noexcept;
+
+        ///
+        /// @brief Returns the number of bytes per pixel of the packed RGB @p colorFormat
+        ///
+        /// @returns 3 for @ref utils::ColorFormat::rgb888, 4 for @ref utils::ColorFormat::rgba8888,
+        ///          6 for @ref utils::ColorFormat::rgb161616, else 0
+        ///
+        static std::uint32_t getBytesPerPixel(const utils::ColorFormat colorFormat) noexcept;
 };
 
 } // namespace rgb2yuv
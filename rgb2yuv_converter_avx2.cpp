@@ -0,0 +1,476 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "rgb2yuv_converter_kernels.hpp"
+
+namespace rgb2yuv
+{
+
+namespace kernels
+{
+
+namespace
+{
+
+// Coefficients of one output component laid out for _mm256_madd_epi16 on 32bit RGBX pixels
+// split into the 16bit pairs (R, B) and (G, X)
+struct PackedCoefficients
+{
+    __m256i rb;
+    __m256i gx;
+    __m256i bias;
+};
+
+inline PackedCoefficients makeCoefficients(const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                     const std::int32_t offset) noexcept
+{
+    return { _mm256_set1_epi32(static_cast<std::int32_t>((static_cast<std::uint32_t>(cB) << 16U) |
+                                                         (static_cast<std::uint32_t>(cR) & 0xFFFFU))),
+             _mm256_set1_epi32(cG & 0xFFFF),
+             _mm256_set1_epi32(128 + (offset << 8)) };
+}
+
+inline __m256i computeComponent(const __m256i rb, const __m256i gx, const PackedCoefficients &c) noexcept
+{
+    const __m256i sum { _mm256_add_epi32(_mm256_madd_epi16(rb, c.rb), _mm256_madd_epi16(gx, c.gx)) };
+    return _mm256_srai_epi32(_mm256_add_epi32(sum, c.bias), 8);
+}
+
+// Packs 4 x 8 32bit values to 32 bytes in pixel order
+inline __m256i pack(const __m256i *values, const __m256i order) noexcept
+{
+    const __m256i packed { _mm256_packus_epi16(_mm256_packs_epi32(values[0U], values[1U]),
+                                               _mm256_packs_epi32(values[2U], values[3U])) };
+    return _mm256_permutevar8x32_epi32(packed, order);
+}
+
+// Stores 32 bytes, bypassing the caches if stream is set (dst must then be 32 byte aligned)
+inline void store(std::uint8_t *dst, const __m256i value, const bool stream) noexcept
+{
+    if (stream) {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(dst), value);
+    } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), value);
+    }
+}
+
+inline bool isAligned(const std::uint8_t *pointer) noexcept
+{
+    return (reinterpret_cast<std::uintptr_t>(pointer) % 32U) == 0U;
+}
+
+template<bool streamLuma, bool streamChroma>
+void convertRow(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    constexpr std::uint32_t pixelsPerIteration { 32U };
+    const __m256i expandRgb { _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                               0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) };
+    const __m256i spreadRgb { _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0) };
+    const __m256i loadMaskRgb { _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0) };
+    const __m256i packOrder { _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7) };
+    const __m256i maskRb { _mm256_set1_epi32(0x00FF00FF) };
+    const Coefficients &matrix { getCoefficients(colorMatrix) };
+    const PackedCoefficients cY { makeCoefficients(matrix.yR, matrix.yG, matrix.yB, matrix.yOffset) };
+    const PackedCoefficients cU { makeCoefficients(matrix.uR, matrix.uG, matrix.uB, matrix.uvOffset) };
+    const PackedCoefficients cV { makeCoefficients(matrix.vR, matrix.vG, matrix.vB, matrix.uvOffset) };
+
+    std::uint32_t x { 0U };
+    bool streamY { false };
+    bool streamU { false };
+    bool streamV { false };
+    if (streamLuma) {
+        // Convert the pixels in front of the first aligned luma address with regular stores
+        x = std::min(width, static_cast<std::uint32_t>((0U - reinterpret_cast<std::uintptr_t>(y)) % 32U));
+        convertRowSse41(src, x, bytesPerPixel, colorMatrix, y, u, v);
+        streamY = true;
+        streamU = streamChroma && isAligned(u + x);
+        streamV = streamChroma && isAligned(v + x);
+    }
+
+    for (; x + pixelsPerIteration <= width; x += pixelsPerIteration)
+    {
+        __m256i yv[4U];
+        __m256i uv[4U];
+        __m256i vv[4U];
+        for (std::uint32_t idx { 0U }; idx < 4U; ++idx)
+        {
+            const std::uint8_t *pixels { src + (x + 8U * idx) * bytesPerPixel };
+            __m256i rgbx { };
+            if (bytesPerPixel == 3U) {
+                // Masked load of 24 bytes, then move each group of 4 pixels into its own 128bit lane
+                const __m256i rgb { _mm256_maskload_epi32(reinterpret_cast<const int *>(pixels), loadMaskRgb) };
+                rgbx = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(rgb, spreadRgb), expandRgb);
+            } else {
+                rgbx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels));
+            }
+            const __m256i rb { _mm256_and_si256(rgbx, maskRb) };
+            const __m256i gx { _mm256_srli_epi16(rgbx, 8) };
+            yv[idx] = computeComponent(rb, gx, cY);
+            uv[idx] = computeComponent(rb, gx, cU);
+            vv[idx] = computeComponent(rb, gx, cV);
+        }
+
+        store(y + x, pack(yv, packOrder), streamY);
+        store(u + x, pack(uv, packOrder), streamU);
+        store(v + x, pack(vv, packOrder), streamV);
+    }
+
+    convertRowSse41(src + x * bytesPerPixel, width - x, bytesPerPixel, colorMatrix, y + x, u + x, v + x);
+}
+
+// Coefficients of one output component laid out for _mm256_madd_epi16 on the 16bit pairs (R, G) and (B, 0)
+// of 16bit RGB pixels. The samples are biased to signed 16bit values, the bias is compensated in bias.
+struct PackedCoefficients16
+{
+    __m256i rg;
+    __m256i b;
+    __m256i bias;
+};
+
+inline PackedCoefficients16 makeCoefficients16(const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                               const std::int32_t offset) noexcept
+{
+    return { _mm256_set1_epi32(static_cast<std::int32_t>((static_cast<std::uint32_t>(cG) << 16U) |
+                                                         (static_cast<std::uint32_t>(cR) & 0xFFFFU))),
+             _mm256_set1_epi32(cB & 0xFFFF),
+             _mm256_set1_epi32(128 + (offset << 16) + (cR + cG + cB) * 32768) };
+}
+
+// Computes 16 samples of one component, saturated to [0, 65535]
+inline __m256i computeComponent16(const __m256i rgLow, const __m256i rgHigh, const __m256i bLow, const __m256i bHigh,
+                                  const PackedCoefficients16 &c) noexcept
+{
+    const __m256i low { _mm256_add_epi32(_mm256_madd_epi16(rgLow, c.rg), _mm256_madd_epi16(bLow, c.b)) };
+    const __m256i high { _mm256_add_epi32(_mm256_madd_epi16(rgHigh, c.rg), _mm256_madd_epi16(bHigh, c.b)) };
+    return _mm256_packus_epi32(_mm256_srai_epi32(_mm256_add_epi32(low, c.bias), 8),
+                               _mm256_srai_epi32(_mm256_add_epi32(high, c.bias), 8));
+}
+
+// Gathers the 16bit samples of one channel of 8 pixels held in three vectors per 128bit lane
+inline __m256i gatherChannel(const __m256i *pixels, const __m256i *masks) noexcept
+{
+    return _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(pixels[0U], masks[0U]),
+                                           _mm256_shuffle_epi8(pixels[1U], masks[1U])),
+                           _mm256_shuffle_epi8(pixels[2U], masks[2U]));
+}
+
+// Exactly rounded (c * a + background * (255 - a)) / 255 of 16bit words holding 8bit values
+inline __m256i blend(const __m256i c, const __m256i background, const __m256i a, const __m256i inverseA) noexcept
+{
+    const __m256i sum { _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_mullo_epi16(background, inverseA)),
+                                         _mm256_set1_epi16(128)) };
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)), 8);
+}
+
+template<utils::AlphaMode alphaMode>
+void convertRowAlpha(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t background,
+                     const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v,
+                     std::uint8_t *a)
+{
+    constexpr std::uint32_t pixelsPerIteration { 32U };
+    const __m256i packOrder { _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7) };
+    const __m256i maskRb { _mm256_set1_epi32(0x00FF00FF) };
+    // Alpha of every pixel in both of its 16bit words
+    const __m256i spreadAlpha { _mm256_setr_epi8(3, -1, 3, -1, 7, -1, 7, -1, 11, -1, 11, -1, 15, -1, 15, -1,
+                                                 3, -1, 3, -1, 7, -1, 7, -1, 11, -1, 11, -1, 15, -1, 15, -1) };
+    const __m256i maxAlpha { _mm256_set1_epi16(255) };
+    // Background in the word layout of (R, B) and (G, X)
+    const __m256i backgroundRb { _mm256_set1_epi32(static_cast<std::int32_t>(((background & 0xFFU) << 16U) |
+                                                                             ((background >> 16U) & 0xFFU))) };
+    const __m256i backgroundGx { _mm256_set1_epi32(static_cast<std::int32_t>((background >> 8U) & 0xFFU)) };
+    const Coefficients &matrix { getCoefficients(colorMatrix) };
+    const PackedCoefficients cY { makeCoefficients(matrix.yR, matrix.yG, matrix.yB, matrix.yOffset) };
+    const PackedCoefficients cU { makeCoefficients(matrix.uR, matrix.uG, matrix.uB, matrix.uvOffset) };
+    const PackedCoefficients cV { makeCoefficients(matrix.vR, matrix.vG, matrix.vB, matrix.uvOffset) };
+
+    std::uint32_t x { 0U };
+    for (; x + pixelsPerIteration <= width; x += pixelsPerIteration)
+    {
+        __m256i yv[4U];
+        __m256i uv[4U];
+        __m256i vv[4U];
+        __m256i av[4U];
+        for (std::uint32_t idx { 0U }; idx < 4U; ++idx)
+        {
+            const __m256i rgba { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + (x + 8U * idx) * 4U)) };
+            __m256i rb { _mm256_and_si256(rgba, maskRb) };
+            __m256i gx { _mm256_srli_epi16(rgba, 8) };
+            if (alphaMode == utils::AlphaMode::composite) {
+                const __m256i alpha { _mm256_shuffle_epi8(rgba, spreadAlpha) };
+                const __m256i inverseAlpha { _mm256_sub_epi16(maxAlpha, alpha) };
+                // The alpha word of gx is blended as well, its coefficient is 0
+                rb = blend(rb, backgroundRb, alpha, inverseAlpha);
+                gx = blend(gx, backgroundGx, alpha, inverseAlpha);
+            } else {
+                av[idx] = _mm256_srli_epi32(rgba, 24);
+            }
+            yv[idx] = computeComponent(rb, gx, cY);
+            uv[idx] = computeComponent(rb, gx, cU);
+            vv[idx] = computeComponent(rb, gx, cV);
+        }
+
+        store(y + x, pack(yv, packOrder), false);
+        store(u + x, pack(uv, packOrder), false);
+        store(v + x, pack(vv, packOrder), false);
+        if (alphaMode == utils::AlphaMode::plane) {
+            store(a + x, pack(av, packOrder), false);
+        }
+    }
+
+    convertRowAlphaScalar(src + x * 4U, width - x, alphaMode, background, colorMatrix, y + x, u + x, v + x,
+                          (alphaMode == utils::AlphaMode::plane) ? a + x : a);
+}
+
+// Filters numRows rows of a plane vertically into s and pads it
+template<std::uint32_t numRows>
+void filterChromaRows(const std::uint8_t *const *rows, const std::uint32_t width, std::int16_t *s) noexcept
+{
+    constexpr std::uint32_t samplesPerIteration { 16U };
+
+    std::uint32_t x { 0U };
+    for (; x + samplesPerIteration <= width; x += samplesPerIteration)
+    {
+        __m256i sum { _mm256_setzero_si256() };
+        for (std::uint32_t row { 0U }; row < numRows; ++row)
+        {
+            __m256i samples { _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[row] + x))) };
+            if (numRows == ct_lanczosVerticalTaps.size()) {
+                samples = _mm256_mullo_epi16(samples, _mm256_set1_epi16(static_cast<std::int16_t>(ct_lanczosVerticalTaps[row])));
+            }
+            sum = _mm256_add_epi16(sum, samples);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(s + x), sum);
+    }
+
+    for (; x < width; ++x)
+    {
+        std::int32_t sum { 0 };
+        for (std::uint32_t row { 0U }; row < numRows; ++row)
+        {
+            sum += ((numRows == ct_lanczosVerticalTaps.size()) ? ct_lanczosVerticalTaps[row] : 1) * rows[row][x];
+        }
+        s[x] = static_cast<std::int16_t>(sum);
+    }
+    padChromaRow(s, width);
+}
+
+// Filters the vertically filtered samples s horizontally for the 8 chroma samples at the columns 0, 2, ..., 14.
+// Each 32bit lane of a load at column 2k holds s[2k] in its low and s[2k + 1] in its high word, so the even and
+// odd columns around the 8 chroma samples are one shift away in 32bit lanes.
+template<utils::ChromaFilter chromaFilter>
+inline __m256i filterChromaColumns(const std::int16_t *s) noexcept
+{
+    const auto load = [&](const std::int32_t offset)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + offset));
+    };
+    const auto even = [](const __m256i pairs) { return _mm256_srai_epi32(_mm256_slli_epi32(pairs, 16), 16); };
+    const auto odd = [](const __m256i pairs) { return _mm256_srai_epi32(pairs, 16); };
+    const __m256i center { load(0) };
+    __m256i ret { };
+
+    if (chromaFilter == utils::ChromaFilter::box) {
+        ret = _mm256_add_epi32(even(center), odd(center));
+    } else if (chromaFilter == utils::ChromaFilter::cosited) {
+        ret = _mm256_add_epi32(_mm256_add_epi32(odd(load(-2)), odd(center)), _mm256_slli_epi32(even(center), 1));
+    } else {
+        const __m256i inner { _mm256_add_epi32(odd(load(-2)), odd(center)) };
+        const __m256i outer { _mm256_add_epi32(odd(load(-4)), odd(load(2))) };
+        ret = _mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(inner, _mm256_set1_epi32(9)),
+                                                _mm256_slli_epi32(even(center), 4)), outer);
+    }
+
+    return ret;
+}
+
+template<utils::ChromaFilter chromaFilter>
+void subsampleChromaRows(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows, const std::uint32_t width,
+                         const bool isVertical, std::int16_t *scratch, std::uint8_t *uv) noexcept
+{
+    // Full resolution columns per iteration, i.e. 8 chroma samples of each plane
+    constexpr std::uint32_t samplesPerIteration { 16U };
+    const std::uint32_t numRows { getChromaFilterRows(chromaFilter, isVertical) };
+    const std::uint32_t shift { getChromaFilterShift(chromaFilter, isVertical) };
+    const __m128i shiftCount { _mm_cvtsi32_si128(static_cast<std::int32_t>(shift)) };
+    const __m256i half { _mm256_set1_epi32(1 << (shift - 1U)) };
+    const __m256i maxValue { _mm256_set1_epi32(255) };
+    std::int16_t *sU { scratch + ct_chromaFilterPadding };
+    std::int16_t *sV { sU + width + 2U * ct_chromaFilterPadding };
+
+    const auto filterRows = [&](const std::uint8_t *const *rows, std::int16_t *s)
+    {
+        switch (numRows)
+        {
+            case(1U):
+                filterChromaRows<1U>(rows, width, s);
+                break;
+            case(2U):
+                filterChromaRows<2U>(rows, width, s);
+                break;
+            default:
+                filterChromaRows<ct_lanczosVerticalTaps.size()>(rows, width, s);
+                break;
+        }
+    };
+
+    filterRows(uRows, sU);
+    filterRows(vRows, sV);
+
+    const auto normalize = [&](const __m256i value)
+    {
+        const __m256i rounded { _mm256_sra_epi32(_mm256_add_epi32(value, half), shiftCount) };
+        return _mm256_min_epi32(_mm256_max_epi32(rounded, _mm256_setzero_si256()), maxValue);
+    };
+
+    std::uint32_t x { 0U };
+    for (; x + samplesPerIteration <= width; x += samplesPerIteration)
+    {
+        // U in the low and V in the high byte of every 16bit pair, packed to 8 pairs in the low 128bit lane
+        const __m256i pairs { _mm256_or_si256(normalize(filterChromaColumns<chromaFilter>(sU + x)),
+                                              _mm256_slli_epi32(normalize(filterChromaColumns<chromaFilter>(sV + x)), 8)) };
+        const __m256i packed { _mm256_permute4x64_epi64(_mm256_packus_epi32(pairs, pairs), 0x08) };
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(uv + x), _mm256_castsi256_si128(packed));
+    }
+
+    for (; x < width; x += 2U)
+    {
+        const std::int32_t u { (filterChromaColumn(sU + x, chromaFilter) + (1 << (shift - 1U))) >> shift };
+        const std::int32_t v { (filterChromaColumn(sV + x, chromaFilter) + (1 << (shift - 1U))) >> shift };
+        uv[x] = static_cast<std::uint8_t>(std::min(std::max(u, 0), 255));
+        uv[x + 1U] = static_cast<std::uint8_t>(std::min(std::max(v, 0), 255));
+    }
+}
+
+} // namespace
+
+void convertRowAvx2(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                    const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<false, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowAvx2Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                          const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, true>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowAvx2StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                              const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRow16Avx2(const std::uint16_t *src, const std::uint32_t width, const std::uint32_t bitDepth,
+                      const utils::ColorMatrix colorMatrix, std::uint16_t *y, std::uint16_t *u, std::uint16_t *v)
+{
+    constexpr std::uint32_t pixelsPerIteration { 16U };
+    // Pixels 0-7 go to the low and pixels 8-15 to the high 128bit lane, each spread over three vectors
+    // of 16 bytes. masks[channel][vector] moves the samples of a channel into pixel order.
+    const __m256i masks[3U][3U] {
+        { _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 6, 7, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 3, 8, 9, 14, 15, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 4, 5, 10, 11)) },
+        { _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 3, 8, 9, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, 4, 5, 10, 11, -1, -1, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 6, 7, 12, 13)) },
+        { _mm256_broadcastsi128_si256(_mm_setr_epi8(4, 5, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, 0, 1, 6, 7, 12, 13, -1, -1, -1, -1, -1, -1)),
+          _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 3, 8, 9, 14, 15)) },
+    };
+    const __m256i signBias { _mm256_set1_epi16(static_cast<std::int16_t>(0x8000)) };
+    const std::uint32_t shift { 16U - bitDepth };
+    const __m128i shiftCount { _mm_cvtsi32_si128(static_cast<std::int32_t>(shift)) };
+    const __m256i half { _mm256_set1_epi16(static_cast<std::int16_t>((1U << shift) >> 1U)) };
+    const Coefficients &matrix { getCoefficients(colorMatrix) };
+    const PackedCoefficients16 cY { makeCoefficients16(matrix.yR, matrix.yG, matrix.yB, matrix.yOffset) };
+    const PackedCoefficients16 cU { makeCoefficients16(matrix.uR, matrix.uG, matrix.uB, matrix.uvOffset) };
+    const PackedCoefficients16 cV { makeCoefficients16(matrix.vR, matrix.vG, matrix.vB, matrix.uvOffset) };
+
+    // Saturating the rounding term clamps to the largest value of bitDepth bits
+    const auto quantize = [&](const __m256i value)
+    {
+        return _mm256_sll_epi16(_mm256_srl_epi16(_mm256_adds_epu16(value, half), shiftCount), shiftCount);
+    };
+
+    std::uint32_t x { 0U };
+    for (; x + pixelsPerIteration <= width; x += pixelsPerIteration)
+    {
+        const std::uint16_t *pixels { src + 3U * x };
+        __m256i vectors[3U];
+        for (std::uint32_t idx { 0U }; idx < 3U; ++idx)
+        {
+            vectors[idx] = _mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(pixels + 24U + 8U * idx),
+                                               reinterpret_cast<const __m128i *>(pixels + 8U * idx));
+        }
+        const __m256i r { _mm256_xor_si256(gatherChannel(vectors, masks[0U]), signBias) };
+        const __m256i g { _mm256_xor_si256(gatherChannel(vectors, masks[1U]), signBias) };
+        const __m256i b { _mm256_xor_si256(gatherChannel(vectors, masks[2U]), signBias) };
+        const __m256i rgLow { _mm256_unpacklo_epi16(r, g) };
+        const __m256i rgHigh { _mm256_unpackhi_epi16(r, g) };
+        const __m256i bLow { _mm256_unpacklo_epi16(b, _mm256_setzero_si256()) };
+        const __m256i bHigh { _mm256_unpackhi_epi16(b, _mm256_setzero_si256()) };
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(y + x), quantize(computeComponent16(rgLow, rgHigh, bLow, bHigh, cY)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(u + x), quantize(computeComponent16(rgLow, rgHigh, bLow, bHigh, cU)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(v + x), quantize(computeComponent16(rgLow, rgHigh, bLow, bHigh, cV)));
+    }
+
+    convertRow16Scalar(src + 3U * x, width - x, bitDepth, colorMatrix, y + x, u + x, v + x);
+}
+
+void convertRowAlphaAvx2(const std::uint8_t *src, const std::uint32_t width, const utils::AlphaMode alphaMode,
+                         const std::uint32_t background, const utils::ColorMatrix colorMatrix,
+                         std::uint8_t *y, std::uint8_t *u, std::uint8_t *v, std::uint8_t *a)
+{
+    if (alphaMode == utils::AlphaMode::composite) {
+        convertRowAlpha<utils::AlphaMode::composite>(src, width, background, colorMatrix, y, u, v, a);
+    } else {
+        convertRowAlpha<utils::AlphaMode::plane>(src, width, background, colorMatrix, y, u, v, a);
+    }
+}
+
+void subsampleChromaAvx2(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows, const std::uint32_t width,
+                         const utils::ChromaFilter chromaFilter, const bool isVertical, std::int16_t *scratch,
+                         std::uint8_t *uv)
+{
+    switch (chromaFilter)
+    {
+        case(utils::ChromaFilter::cosited):
+            subsampleChromaRows<utils::ChromaFilter::cosited>(uRows, vRows, width, isVertical, scratch, uv);
+            break;
+        case(utils::ChromaFilter::lanczos):
+            subsampleChromaRows<utils::ChromaFilter::lanczos>(uRows, vRows, width, isVertical, scratch, uv);
+            break;
+        default:
+            subsampleChromaRows<utils::ChromaFilter::box>(uRows, vRows, width, isVertical, scratch, uv);
+            break;
+    }
+}
+
+} // namespace kernels
+
+} // namespace rgb2yuv
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "rgb2yuv_converter_kernels.hpp"
+
+namespace rgb2yuv
+{
+
+namespace kernels
+{
+
+namespace
+{
+
+// Coefficients of one output component laid out for _mm512_madd_epi16 on 32bit RGBX pixels
+// split into the 16bit pairs (R, B) and (G, X)
+struct PackedCoefficients
+{
+    __m512i rb;
+    __m512i gx;
+    __m512i bias;
+};
+
+inline PackedCoefficients makeCoefficients(const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                     const std::int32_t offset) noexcept
+{
+    return { _mm512_set1_epi32(static_cast<std::int32_t>((static_cast<std::uint32_t>(cB) << 16U) |
+                                                         (static_cast<std::uint32_t>(cR) & 0xFFFFU))),
+             _mm512_set1_epi32(cG & 0xFFFF),
+             _mm512_set1_epi32(128 + (offset << 8)) };
+}
+
+inline __m512i computeComponent(const __m512i rb, const __m512i gx, const PackedCoefficients &c) noexcept
+{
+    const __m512i sum { _mm512_add_epi32(_mm512_madd_epi16(rb, c.rb), _mm512_madd_epi16(gx, c.gx)) };
+    return _mm512_srai_epi32(_mm512_add_epi32(sum, c.bias), 8);
+}
+
+// Packs 4 x 16 32bit values to 64 bytes in pixel order
+inline __m512i pack(const __m512i *values, const __m512i order) noexcept
+{
+    const __m512i packed { _mm512_packus_epi16(_mm512_packs_epi32(values[0U], values[1U]),
+                                               _mm512_packs_epi32(values[2U], values[3U])) };
+    return _mm512_permutexvar_epi32(order, packed);
+}
+
+// Stores 64 bytes, bypassing the caches if stream is set (dst must then be 64 byte aligned)
+inline void store(std::uint8_t *dst, const __m512i value, const bool stream) noexcept
+{
+    if (stream) {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(dst), value);
+    } else {
+        _mm512_storeu_si512(dst, value);
+    }
+}
+
+inline bool isAligned(const std::uint8_t *pointer) noexcept
+{
+    return (reinterpret_cast<std::uintptr_t>(pointer) % 64U) == 0U;
+}
+
+template<bool streamLuma, bool streamChroma>
+void convertRow(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    constexpr std::uint32_t pixelsPerIteration { 64U };
+    constexpr __mmask16 loadMaskRgb { 0x0FFFU };
+    const __m512i expandRgb { _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+                                                                   6, 7, 8, -1, 9, 10, 11, -1)) };
+    const __m512i spreadRgb { _mm512_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0, 6, 7, 8, 0, 9, 10, 11, 0) };
+    const __m512i packOrder { _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15) };
+    const __m512i maskRb { _mm512_set1_epi32(0x00FF00FF) };
+    const Coefficients &matrix { getCoefficients(colorMatrix) };
+    const PackedCoefficients cY { makeCoefficients(matrix.yR, matrix.yG, matrix.yB, matrix.yOffset) };
+    const PackedCoefficients cU { makeCoefficients(matrix.uR, matrix.uG, matrix.uB, matrix.uvOffset) };
+    const PackedCoefficients cV { makeCoefficients(matrix.vR, matrix.vG, matrix.vB, matrix.uvOffset) };
+
+    std::uint32_t x { 0U };
+    bool streamY { false };
+    bool streamU { false };
+    bool streamV { false };
+    if (streamLuma) {
+        // Convert the pixels in front of the first aligned luma address with regular stores
+        x = std::min(width, static_cast<std::uint32_t>((0U - reinterpret_cast<std::uintptr_t>(y)) % 64U));
+        convertRowAvx2(src, x, bytesPerPixel, colorMatrix, y, u, v);
+        streamY = true;
+        streamU = streamChroma && isAligned(u + x);
+        streamV = streamChroma && isAligned(v + x);
+    }
+
+    for (; x + pixelsPerIteration <= width; x += pixelsPerIteration)
+    {
+        __m512i yv[4U];
+        __m512i uv[4U];
+        __m512i vv[4U];
+        for (std::uint32_t idx { 0U }; idx < 4U; ++idx)
+        {
+            const std::uint8_t *pixels { src + (x + 16U * idx) * bytesPerPixel };
+            __m512i rgbx { };
+            if (bytesPerPixel == 3U) {
+                // Masked load of 48 bytes, then move each group of 4 pixels into its own 128bit lane
+                const __m512i rgb { _mm512_maskz_loadu_epi32(loadMaskRgb, pixels) };
+                rgbx = _mm512_shuffle_epi8(_mm512_permutexvar_epi32(spreadRgb, rgb), expandRgb);
+            } else {
+                rgbx = _mm512_loadu_si512(pixels);
+            }
+            const __m512i rb { _mm512_and_si512(rgbx, maskRb) };
+            const __m512i gx { _mm512_srli_epi16(rgbx, 8) };
+            yv[idx] = computeComponent(rb, gx, cY);
+            uv[idx] = computeComponent(rb, gx, cU);
+            vv[idx] = computeComponent(rb, gx, cV);
+        }
+
+        store(y + x, pack(yv, packOrder), streamY);
+        store(u + x, pack(uv, packOrder), streamU);
+        store(v + x, pack(vv, packOrder), streamV);
+    }
+
+    convertRowAvx2(src + x * bytesPerPixel, width - x, bytesPerPixel, colorMatrix, y + x, u + x, v + x);
+}
+
+} // namespace
+
+void convertRowAvx512(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                      const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<false, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowAvx512Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                            const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, true>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowAvx512StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                                const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+} // namespace kernels
+
+} // namespace rgb2yuv
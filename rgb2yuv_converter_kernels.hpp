@@ -0,0 +1,423 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+namespace kernels
+{
+
+///
+/// @brief Fixed point (8 fractional bits) coefficients of a RGB to YUV matrix
+///
+/// Every kernel computes clamp(((c0 * R + c1 * G + c2 * B + 128) >> 8) + offset, 0, 255) with exact
+/// integer arithmetic, so all SIMD tiers produce bit identical output.
+///
+struct Coefficients
+{
+    std::int32_t yR; ///< R contribution to Y
+    std::int32_t yG; ///< G contribution to Y
+    std::int32_t yB; ///< B contribution to Y
+    std::int32_t uR; ///< R contribution to U (Cb)
+    std::int32_t uG; ///< G contribution to U (Cb)
+    std::int32_t uB; ///< B contribution to U (Cb)
+    std::int32_t vR; ///< R contribution to V (Cr)
+    std::int32_t vG; ///< G contribution to V (Cr)
+    std::int32_t vB; ///< B contribution to V (Cr)
+    std::int32_t yOffset; ///< Offset added to Y
+    std::int32_t uvOffset; ///< Offset added to U and V
+};
+
+///
+/// @brief Coefficients of each @ref utils::ColorMatrix
+///
+constexpr std::array<Coefficients, static_cast<std::uint32_t>(utils::ColorMatrix::last)> ct_coefficients
+{{
+    { 66, 129, 25, -38, -74, 112, 112, -94, -18, 16, 128 }, // bt601
+    { 47, 157, 16, -26, -86, 112, 112, -102, -10, 16, 128 }, // bt709
+    { 77, 150, 29, -43, -85, 128, 128, -107, -21, 0, 128 }, // bt601_full
+}};
+
+///
+/// @brief Returns the coefficients of @p colorMatrix
+///
+inline const Coefficients &getCoefficients(const utils::ColorMatrix colorMatrix) noexcept
+{
+    return ct_coefficients[static_cast<std::uint32_t>(colorMatrix)];
+}
+
+constexpr std::uint32_t ct_lookupLaneBits { 21U }; ///< Bits of each Y, U and V lane of a @ref LookupTables entry
+constexpr std::int32_t ct_lookupBias { 1 << 17 }; ///< Bias added to every lane, keeps lane sums positive
+
+///
+/// @brief Packed per channel contribution tables used by the scalar kernel
+///
+/// Each entry holds the Y, U and V contributions c * value of one channel value in lanes of
+/// @ref ct_lookupLaneBits bits, so a pixel takes three loads instead of nine. The rounding term, the
+/// offsets and @ref ct_lookupBias are folded into the R table. Every lane of tableR[R] + tableG[G] + tableB[B]
+/// is then in [0, 2^18), so lanes never borrow from each other and a component is
+/// clamp((lane >> 8) - (ct_lookupBias >> 8), 0, 255).
+///
+struct LookupTables
+{
+    std::array<std::uint64_t, 256U> r; ///< R contributions including rounding, offsets and bias
+    std::array<std::uint64_t, 256U> g; ///< G contributions
+    std::array<std::uint64_t, 256U> b; ///< B contributions
+};
+
+///
+/// @brief Packs Y, U and V contributions into the lanes of a @ref LookupTables entry
+///
+constexpr std::uint64_t packLanes(const std::int64_t y, const std::int64_t u, const std::int64_t v) noexcept
+{
+    return static_cast<std::uint64_t>(y + u * (std::int64_t { 1 } << ct_lookupLaneBits) +
+                                      v * (std::int64_t { 1 } << (2U * ct_lookupLaneBits)));
+}
+
+///
+/// @brief Builds the @ref LookupTables of @p c
+///
+constexpr LookupTables makeLookupTables(const Coefficients &c) noexcept
+{
+    LookupTables ret { };
+
+    for (std::int32_t value { 0 }; value < 256; ++value)
+    {
+        const std::size_t idx { static_cast<std::size_t>(value) };
+        ret.r[idx] = packLanes(c.yR * value + 128 + c.yOffset * 256 + ct_lookupBias,
+                               c.uR * value + 128 + c.uvOffset * 256 + ct_lookupBias,
+                               c.vR * value + 128 + c.uvOffset * 256 + ct_lookupBias);
+        ret.g[idx] = packLanes(c.yG * value, c.uG * value, c.vG * value);
+        ret.b[idx] = packLanes(c.yB * value, c.uB * value, c.vB * value);
+    }
+
+    return ret;
+}
+
+///
+/// @brief Checks that every lane sum of the @ref LookupTables of @p c is in [0, 2^18)
+///
+/// The extremes of a lane are reached with every channel at 0 or 255, depending on the sign of its coefficient.
+///
+constexpr bool fitsLookupLanes(const Coefficients &c) noexcept
+{
+    const std::array<std::array<std::int32_t, 4U>, 3U> lanes
+    {{
+        { c.yR, c.yG, c.yB, c.yOffset },
+        { c.uR, c.uG, c.uB, c.uvOffset },
+        { c.vR, c.vG, c.vB, c.uvOffset },
+    }};
+    bool ret { true };
+
+    for (const std::array<std::int32_t, 4U> &lane : lanes)
+    {
+        std::int32_t min { 128 + lane[3U] * 256 + ct_lookupBias };
+        std::int32_t max { min };
+        for (std::uint32_t channel { 0U }; channel < 3U; ++channel)
+        {
+            min += std::min(lane[channel] * 255, 0);
+            max += std::max(lane[channel] * 255, 0);
+        }
+        ret = ret && (min >= 0) && (max < (1 << 18));
+    }
+
+    return ret;
+}
+
+///
+/// @brief Signature of a kernel converting one row of packed RGB pixels to full resolution Y, U and V
+///
+/// @param[in] src Pointer to the first pixel of the row. R, G and B are the first three bytes of each pixel.
+/// @param[in] width Number of pixels in the row
+/// @param[in] bytesPerPixel 3 for RGB888, 4 for RGBA8888 (the fourth byte is ignored)
+/// @param[in] colorMatrix Matrix used for the conversion
+/// @param[out] y Destination of @p width luma values
+/// @param[out] u Destination of @p width Cb values
+/// @param[out] v Destination of @p width Cr values
+///
+using ConvertRowFn = void (*)(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                              const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u,
+                              std::uint8_t *v);
+
+///
+/// @brief Signature of a kernel converting one row of 16bit RGB pixels to full resolution high bit depth Y, U and V
+///
+/// Every kernel computes clamp(((c0 * R + c1 * G + c2 * B + 128) >> 8) + offset * 256, 0, 65535), i.e. the
+/// matrix of @ref Coefficients on 16bit samples, rounds it to @p bitDepth bits and stores it MSB aligned in
+/// 16 bits, as P010 and P016 do.
+///
+/// @param[in] src Pointer to the first pixel of the row, 3 native endian 16bit samples R, G and B per pixel
+/// @param[in] width Number of pixels in the row
+/// @param[in] bitDepth Significant bits of every output sample, 10 or 16
+/// @param[in] colorMatrix Matrix used for the conversion
+/// @param[out] y Destination of @p width luma samples
+/// @param[out] u Destination of @p width Cb samples
+/// @param[out] v Destination of @p width Cr samples
+///
+using ConvertRow16Fn = void (*)(const std::uint16_t *src, const std::uint32_t width, const std::uint32_t bitDepth,
+                                const utils::ColorMatrix colorMatrix, std::uint16_t *y, std::uint16_t *u,
+                                std::uint16_t *v);
+
+///
+/// @brief Signature of a kernel converting one row of RGBA8888 pixels, handling alpha in the same pass
+///
+/// For @ref utils::AlphaMode::composite every channel c is first replaced by the exactly rounded
+/// (c * A + background * (255 - A)) / 255, then the color is converted as by @ref ConvertRowFn.
+/// For @ref utils::AlphaMode::plane the color is converted as is and A is copied to @p a.
+///
+/// @param[in] src Pointer to the first pixel of the row, 4 bytes R, G, B and A per pixel
+/// @param[in] width Number of pixels in the row
+/// @param[in] alphaMode @ref utils::AlphaMode::composite or @ref utils::AlphaMode::plane
+/// @param[in] background Background color 0xRRGGBB used for @ref utils::AlphaMode::composite
+/// @param[in] colorMatrix Matrix used for the conversion
+/// @param[out] y Destination of @p width luma values
+/// @param[out] u Destination of @p width Cb values
+/// @param[out] v Destination of @p width Cr values
+/// @param[out] a Destination of @p width alpha values, only written for @ref utils::AlphaMode::plane
+///
+using ConvertRowAlphaFn = void (*)(const std::uint8_t *src, const std::uint32_t width, const utils::AlphaMode alphaMode,
+                                   const std::uint32_t background, const utils::ColorMatrix colorMatrix,
+                                   std::uint8_t *y, std::uint8_t *u, std::uint8_t *v, std::uint8_t *a);
+
+///
+/// @brief Signature of a kernel subsampling full resolution chroma rows to one row of interleaved U and V
+///
+/// The rows are first filtered vertically with the taps of @ref getChromaFilterRows rows, then output sample j is
+/// filtered horizontally around column 2j (see @ref filterChromaColumn). Columns outside [0, @p width) repeat the
+/// edge samples. Every kernel rounds sum(taps * samples) / sum(taps) with exact integer arithmetic and clamps it,
+/// so all SIMD tiers produce bit identical output.
+///
+/// @param[in] uRows @ref getChromaFilterRows pointers to full resolution Cb rows, top to bottom
+/// @param[in] vRows @ref getChromaFilterRows pointers to full resolution Cr rows, top to bottom
+/// @param[in] width Number of full resolution samples in every row (even)
+/// @param[in] chromaFilter Filter applied
+/// @param[in] isVertical @true to subsample vertically as well (4:2:0), @false for a single row (4:2:2)
+/// @param[in, out] scratch Scratch of @ref getChromaFilterScratchSize elements
+/// @param[out] uv Destination of @p width / 2 interleaved Cb and Cr pairs
+///
+using SubsampleChromaFn = void (*)(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows,
+                                   const std::uint32_t width, const utils::ChromaFilter chromaFilter,
+                                   const bool isVertical, std::int16_t *scratch, std::uint8_t *uv);
+
+///
+/// @brief Signature of a kernel subsampling high bit depth chroma rows as @ref SubsampleChromaFn
+///
+/// Samples are filtered at their @p bitDepth significant bits and stored MSB aligned, as P010 and P016 do.
+///
+/// @param[in] bitDepth Significant bits of every sample, 10 or 16
+///
+using SubsampleChroma16Fn = void (*)(const std::uint16_t *const *uRows, const std::uint16_t *const *vRows,
+                                     const std::uint32_t width, const utils::ChromaFilter chromaFilter,
+                                     const bool isVertical, const std::uint32_t bitDepth, std::int32_t *scratch,
+                                     std::uint16_t *uv);
+
+///
+/// @brief Edge samples repeated on either side of the vertically filtered rows in the scratch of @ref SubsampleChromaFn
+///
+constexpr std::uint32_t ct_chromaFilterPadding { 4U };
+
+///
+/// @brief Vertical taps of @ref utils::ChromaFilter::lanczos for rows 2k - 2 to 2k + 3 of chroma row k: Lanczos-2
+///        sampled half way between rows 2k and 2k + 1 and scaled to 64
+///
+constexpr std::array<std::int32_t, 6U> ct_lanczosVerticalTaps {{ -3, 7, 28, 28, 7, -3 }};
+
+///
+/// @brief Returns the number of full resolution rows a chroma row of @p chromaFilter is filtered from
+///
+/// @returns 1 unless @p isVertical, else 6 for @ref utils::ChromaFilter::lanczos (rows 2k - 2 to 2k + 3 for
+///          chroma row k) and 2 (rows 2k and 2k + 1) for the others
+///
+inline std::uint32_t getChromaFilterRows(const utils::ChromaFilter chromaFilter, const bool isVertical) noexcept
+{
+    return !isVertical ? 1U : ((chromaFilter == utils::ChromaFilter::lanczos) ? 6U : 2U);
+}
+
+///
+/// @brief Returns log2 of the sum of the taps of @p chromaFilter, i.e. the shift normalizing a filtered sample
+///
+inline std::uint32_t getChromaFilterShift(const utils::ChromaFilter chromaFilter, const bool isVertical) noexcept
+{
+    std::uint32_t ret { 1U };
+
+    switch (chromaFilter)
+    {
+        case(utils::ChromaFilter::cosited):
+            ret = isVertical ? 3U : 2U;
+            break;
+        case(utils::ChromaFilter::lanczos):
+            ret = isVertical ? 11U : 5U;
+            break;
+        default:
+            ret = isVertical ? 2U : 1U;
+            break;
+    }
+
+    return ret;
+}
+
+///
+/// @brief Returns the number of elements of the scratch of @ref SubsampleChromaFn for rows of @p width samples
+///
+inline std::size_t getChromaFilterScratchSize(const std::uint32_t width) noexcept
+{
+    return 2U * (static_cast<std::size_t>(width) + 2U * ct_chromaFilterPadding);
+}
+
+///
+/// @brief Filters the vertically filtered samples @p s horizontally for the chroma sample at column 0
+///
+/// Design:
+/// -# @ref utils::ChromaFilter::box: s[0] + s[1], centered between the two columns
+/// -# @ref utils::ChromaFilter::cosited: s[-1] + 2 s[0] + s[1]
+/// -# @ref utils::ChromaFilter::lanczos: -s[-3] + 9 s[-1] + 16 s[0] + 9 s[1] - s[3], Lanczos-2 sampled at every
+///    full resolution column and scaled to 32. The taps at +-2 are 0.
+///
+/// @returns Unnormalized filtered sample, see @ref getChromaFilterShift
+///
+template<typename Sum>
+inline std::int32_t filterChromaColumn(const Sum *s, const utils::ChromaFilter chromaFilter) noexcept
+{
+    std::int32_t ret { 0 };
+
+    switch (chromaFilter)
+    {
+        case(utils::ChromaFilter::cosited):
+            ret = s[-1] + 2 * s[0] + s[1];
+            break;
+        case(utils::ChromaFilter::lanczos):
+            ret = -s[-3] + 9 * s[-1] + 16 * s[0] + 9 * s[1] - s[3];
+            break;
+        default:
+            ret = s[0] + s[1];
+            break;
+    }
+
+    return ret;
+}
+
+///
+/// @brief Repeats the first and last of the @p width samples at @p s into the @ref ct_chromaFilterPadding samples
+///        either side
+///
+template<typename Sum>
+inline void padChromaRow(Sum *s, const std::uint32_t width) noexcept
+{
+    for (std::uint32_t idx { 1U }; idx <= ct_chromaFilterPadding; ++idx)
+    {
+        s[-static_cast<std::int32_t>(idx)] = s[0U];
+        s[width - 1U + idx] = s[width - 1U];
+    }
+}
+
+///
+/// @brief Entry of the kernel dispatch table
+///
+struct KernelEntry
+{
+    utils::SimdTier simdTier; ///< SIMD tier the kernels require
+    ConvertRowFn convertRow; ///< RGB to full resolution YUV row kernel
+    ConvertRowFn convertRowStream; ///< @ref KernelEntry::convertRow with non-temporal stores to y, and to u and v
+                                   ///< where they share the alignment of y
+    ConvertRowFn convertRowStreamLuma; ///< @ref KernelEntry::convertRow with non-temporal stores to y only
+    ConvertRow16Fn convertRow16; ///< 16bit RGB to full resolution high bit depth YUV row kernel
+    ConvertRowAlphaFn convertRowAlpha; ///< RGBA to full resolution YUV row kernel compositing or extracting alpha
+    SubsampleChromaFn subsampleChroma; ///< Chroma subsampling kernel
+    SubsampleChroma16Fn subsampleChroma16; ///< High bit depth chroma subsampling kernel
+};
+
+void convertRowScalar(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                      const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowSse41(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                     const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx2(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                    const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx512(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                      const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowSse41Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                           const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowSse41StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                               const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx2Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                          const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx2StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                              const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx512Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                            const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRowAvx512StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                                const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v);
+void convertRow16Scalar(const std::uint16_t *src, const std::uint32_t width, const std::uint32_t bitDepth,
+                        const utils::ColorMatrix colorMatrix, std::uint16_t *y, std::uint16_t *u, std::uint16_t *v);
+void convertRow16Avx2(const std::uint16_t *src, const std::uint32_t width, const std::uint32_t bitDepth,
+                      const utils::ColorMatrix colorMatrix, std::uint16_t *y, std::uint16_t *u, std::uint16_t *v);
+void convertRowAlphaScalar(const std::uint8_t *src, const std::uint32_t width, const utils::AlphaMode alphaMode,
+                           const std::uint32_t background, const utils::ColorMatrix colorMatrix,
+                           std::uint8_t *y, std::uint8_t *u, std::uint8_t *v, std::uint8_t *a);
+void convertRowAlphaAvx2(const std::uint8_t *src, const std::uint32_t width, const utils::AlphaMode alphaMode,
+                         const std::uint32_t background, const utils::ColorMatrix colorMatrix,
+                         std::uint8_t *y, std::uint8_t *u, std::uint8_t *v, std::uint8_t *a);
+void subsampleChromaScalar(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows, const std::uint32_t width,
+                           const utils::ChromaFilter chromaFilter, const bool isVertical, std::int16_t *scratch,
+                           std::uint8_t *uv);
+void subsampleChromaAvx2(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows, const std::uint32_t width,
+                         const utils::ChromaFilter chromaFilter, const bool isVertical, std::int16_t *scratch,
+                         std::uint8_t *uv);
+void subsampleChroma16Scalar(const std::uint16_t *const *uRows, const std::uint16_t *const *vRows,
+                             const std::uint32_t width, const utils::ChromaFilter chromaFilter, const bool isVertical,
+                             const std::uint32_t bitDepth, std::int32_t *scratch, std::uint16_t *uv);
+
+///
+/// @brief Kernel dispatch table, indexed by @ref utils::SimdTier
+///
+constexpr std::array<KernelEntry, static_cast<std::uint32_t>(utils::SimdTier::last) + 1U> ct_dispatchTable
+{{
+    // The scalar tier has no non-temporal stores and uses its regular kernel for all variants. The 16bit
+    // and alpha kernels and the chroma subsampling exist for AVX2 only, SSE4.1 uses the scalar ones and
+    // AVX512 the AVX2 ones. High bit depth chroma is subsampled by the scalar kernel on every tier.
+    { utils::SimdTier::scalar, convertRowScalar, convertRowScalar, convertRowScalar, convertRow16Scalar,
+      convertRowAlphaScalar, subsampleChromaScalar, subsampleChroma16Scalar },
+    { utils::SimdTier::sse4_1, convertRowSse41, convertRowSse41Stream, convertRowSse41StreamLuma, convertRow16Scalar,
+      convertRowAlphaScalar, subsampleChromaScalar, subsampleChroma16Scalar },
+    { utils::SimdTier::avx2, convertRowAvx2, convertRowAvx2Stream, convertRowAvx2StreamLuma, convertRow16Avx2,
+      convertRowAlphaAvx2, subsampleChromaAvx2, subsampleChroma16Scalar },
+    { utils::SimdTier::avx512, convertRowAvx512, convertRowAvx512Stream, convertRowAvx512StreamLuma, convertRow16Avx2,
+      convertRowAlphaAvx2, subsampleChromaAvx2, subsampleChroma16Scalar },
+}};
+
+///
+/// @brief Returns the dispatch table entry of @p simdTier
+///
+inline const KernelEntry &getKernels(const utils::SimdTier simdTier) noexcept
+{
+    return ct_dispatchTable[static_cast<std::uint32_t>(simdTier)];
+}
+
+} // namespace kernels
+
+} // namespace rgb2yuv
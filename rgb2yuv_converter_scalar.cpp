@@ -0,0 +1,216 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <limits>
+
+#include "rgb2yuv_converter_kernels.hpp"
+
+namespace rgb2yuv
+{
+
+namespace kernels
+{
+
+namespace
+{
+
+// Contribution tables of every color matrix, built at compile time
+constexpr std::array<LookupTables, ct_coefficients.size()> ct_lookupTables
+{{
+    makeLookupTables(ct_coefficients[0U]),
+    makeLookupTables(ct_coefficients[1U]),
+    makeLookupTables(ct_coefficients[2U]),
+}};
+static_assert(fitsLookupLanes(ct_coefficients[0U]) && fitsLookupLanes(ct_coefficients[1U]) &&
+              fitsLookupLanes(ct_coefficients[2U]), "Lane sums of the lookup tables overflow");
+
+constexpr std::array<std::uint8_t, 1024U> makeSaturationTable() noexcept
+{
+    std::array<std::uint8_t, 1024U> ret { };
+
+    for (std::int32_t idx { 0 }; idx < 1024; ++idx)
+    {
+        const std::int32_t value { idx - (ct_lookupBias >> 8) };
+        ret[static_cast<std::size_t>(idx)] = static_cast<std::uint8_t>(std::min(std::max(value, 0), 255));
+    }
+
+    return ret;
+}
+
+// Maps lane >> 8 of a lane sum to its component, a load is cheaper than removing the bias and clamping
+constexpr std::array<std::uint8_t, 1024U> ct_saturationTable { makeSaturationTable() };
+
+inline std::uint8_t extractLane(const std::uint64_t sum, const std::uint32_t lane) noexcept
+{
+    return ct_saturationTable[(sum >> (lane * ct_lookupLaneBits + 8U)) & (ct_saturationTable.size() - 1U)];
+}
+
+inline void convertPixelLookup(const std::uint8_t r, const std::uint8_t g, const std::uint8_t b, const LookupTables &t,
+                               std::uint8_t &y, std::uint8_t &u, std::uint8_t &v) noexcept
+{
+    const std::uint64_t sum { t.r[r] + t.g[g] + t.b[b] };
+    y = extractLane(sum, 0U);
+    u = extractLane(sum, 1U);
+    v = extractLane(sum, 2U);
+}
+
+template<std::uint32_t bytesPerPixel>
+void convertRowLookup(const std::uint8_t *src, const std::uint32_t width, const LookupTables &t,
+                      std::uint8_t *y, std::uint8_t *u, std::uint8_t *v) noexcept
+{
+    for (std::uint32_t x { 0U }; x < width; ++x, src += bytesPerPixel)
+    {
+        convertPixelLookup(src[0U], src[1U], src[2U], t, y[x], u[x], v[x]);
+    }
+}
+
+// Rounds a 16bit sample to the 16 - shift most significant bits
+inline std::uint16_t quantize(const std::int32_t value, const std::uint32_t shift) noexcept
+{
+    const std::int32_t clamped { std::min(std::max(value, 0), 65535) };
+    const std::int32_t rounded { std::min((clamped + ((1 << shift) >> 1)) >> shift, 65535 >> shift) };
+    return static_cast<std::uint16_t>(rounded << shift);
+}
+
+// Exactly rounded (c * a + background * (255 - a)) / 255
+inline std::uint8_t blend(const std::uint32_t c, const std::uint32_t background, const std::uint32_t a) noexcept
+{
+    const std::uint32_t sum { c * a + background * (255U - a) + 128U };
+    return static_cast<std::uint8_t>((sum + (sum >> 8U)) >> 8U);
+}
+
+// Filters numRows rows of a plane vertically, at the 16 - shift most significant bits of their samples, into s
+// and pads it
+template<typename Sample, typename Sum>
+void filterChromaRows(const Sample *const *rows, const std::uint32_t numRows, const std::uint32_t width,
+                      const std::uint32_t shift, Sum *s) noexcept
+{
+    for (std::uint32_t x { 0U }; x < width; ++x)
+    {
+        std::int32_t sum { 0 };
+        for (std::uint32_t row { 0U }; row < numRows; ++row)
+        {
+            const std::int32_t tap { (numRows == ct_lanczosVerticalTaps.size()) ? ct_lanczosVerticalTaps[row] : 1 };
+            sum += tap * (rows[row][x] >> shift);
+        }
+        s[x] = static_cast<Sum>(sum);
+    }
+    padChromaRow(s, width);
+}
+
+template<typename Sample, typename Sum>
+void subsampleChromaRows(const Sample *const *uRows, const Sample *const *vRows, const std::uint32_t width,
+                         const utils::ChromaFilter chromaFilter, const bool isVertical, const std::uint32_t sampleShift,
+                         Sum *scratch, Sample *uv) noexcept
+{
+    const std::uint32_t numRows { getChromaFilterRows(chromaFilter, isVertical) };
+    const std::uint32_t shift { getChromaFilterShift(chromaFilter, isVertical) };
+    const std::int32_t maxValue { static_cast<std::int32_t>(std::numeric_limits<Sample>::max() >> sampleShift) };
+    Sum *sU { scratch + ct_chromaFilterPadding };
+    Sum *sV { sU + width + 2U * ct_chromaFilterPadding };
+
+    filterChromaRows(uRows, numRows, width, sampleShift, sU);
+    filterChromaRows(vRows, numRows, width, sampleShift, sV);
+    for (std::uint32_t x { 0U }; x < width; x += 2U)
+    {
+        const std::int32_t u { (filterChromaColumn(sU + x, chromaFilter) + (1 << (shift - 1U))) >> shift };
+        const std::int32_t v { (filterChromaColumn(sV + x, chromaFilter) + (1 << (shift - 1U))) >> shift };
+        uv[x] = static_cast<Sample>(std::min(std::max(u, 0), maxValue) << sampleShift);
+        uv[x + 1U] = static_cast<Sample>(std::min(std::max(v, 0), maxValue) << sampleShift);
+    }
+}
+
+} // namespace
+
+void convertRowScalar(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                      const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    const LookupTables &tables { ct_lookupTables[static_cast<std::uint32_t>(colorMatrix)] };
+
+    if (bytesPerPixel == 4U) {
+        convertRowLookup<4U>(src, width, tables, y, u, v);
+    } else {
+        convertRowLookup<3U>(src, width, tables, y, u, v);
+    }
+}
+
+void convertRow16Scalar(const std::uint16_t *src, const std::uint32_t width, const std::uint32_t bitDepth,
+                        const utils::ColorMatrix colorMatrix, std::uint16_t *y, std::uint16_t *u, std::uint16_t *v)
+{
+    // 16bit samples exceed the lookup tables, the products fit 32 bits though
+    const Coefficients &c { getCoefficients(colorMatrix) };
+    const std::uint32_t shift { 16U - bitDepth };
+
+    for (std::uint32_t x { 0U }; x < width; ++x, src += 3U)
+    {
+        const std::int32_t r { src[0U] };
+        const std::int32_t g { src[1U] };
+        const std::int32_t b { src[2U] };
+        y[x] = quantize(((c.yR * r + c.yG * g + c.yB * b + 128) >> 8) + c.yOffset * 256, shift);
+        u[x] = quantize(((c.uR * r + c.uG * g + c.uB * b + 128) >> 8) + c.uvOffset * 256, shift);
+        v[x] = quantize(((c.vR * r + c.vG * g + c.vB * b + 128) >> 8) + c.uvOffset * 256, shift);
+    }
+}
+
+void convertRowAlphaScalar(const std::uint8_t *src, const std::uint32_t width, const utils::AlphaMode alphaMode,
+                           const std::uint32_t background, const utils::ColorMatrix colorMatrix,
+                           std::uint8_t *y, std::uint8_t *u, std::uint8_t *v, std::uint8_t *a)
+{
+    const LookupTables &t { ct_lookupTables[static_cast<std::uint32_t>(colorMatrix)] };
+    const std::uint32_t backgroundR { (background >> 16U) & 0xFFU };
+    const std::uint32_t backgroundG { (background >> 8U) & 0xFFU };
+    const std::uint32_t backgroundB { background & 0xFFU };
+    const bool isComposite { alphaMode == utils::AlphaMode::composite };
+
+    for (std::uint32_t x { 0U }; x < width; ++x, src += 4U)
+    {
+        std::uint8_t r { src[0U] };
+        std::uint8_t g { src[1U] };
+        std::uint8_t b { src[2U] };
+        if (isComposite) {
+            r = blend(r, backgroundR, src[3U]);
+            g = blend(g, backgroundG, src[3U]);
+            b = blend(b, backgroundB, src[3U]);
+        } else {
+            a[x] = src[3U];
+        }
+        convertPixelLookup(r, g, b, t, y[x], u[x], v[x]);
+    }
+}
+
+void subsampleChromaScalar(const std::uint8_t *const *uRows, const std::uint8_t *const *vRows, const std::uint32_t width,
+                           const utils::ChromaFilter chromaFilter, const bool isVertical, std::int16_t *scratch,
+                           std::uint8_t *uv)
+{
+    subsampleChromaRows(uRows, vRows, width, chromaFilter, isVertical, 0U, scratch, uv);
+}
+
+void subsampleChroma16Scalar(const std::uint16_t *const *uRows, const std::uint16_t *const *vRows,
+                             const std::uint32_t width, const utils::ChromaFilter chromaFilter, const bool isVertical,
+                             const std::uint32_t bitDepth, std::int32_t *scratch, std::uint16_t *uv)
+{
+    // 6 rows of 16bit samples times the Lanczos taps exceed 16 bits, hence the 32bit scratch
+    subsampleChromaRows(uRows, vRows, width, chromaFilter, isVertical, 16U - bitDepth, scratch, uv);
+}
+
+} // namespace kernels
+
+} // namespace rgb2yuv
@@ -0,0 +1,155 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "rgb2yuv_converter_kernels.hpp"
+
+namespace rgb2yuv
+{
+
+namespace kernels
+{
+
+namespace
+{
+
+// Coefficients of one output component laid out for _mm_madd_epi16 on 32bit RGBX pixels
+// split into the 16bit pairs (R, B) and (G, X)
+struct PackedCoefficients
+{
+    __m128i rb;
+    __m128i gx;
+    __m128i bias;
+};
+
+inline PackedCoefficients makeCoefficients(const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                     const std::int32_t offset) noexcept
+{
+    return { _mm_set1_epi32(static_cast<std::int32_t>((static_cast<std::uint32_t>(cB) << 16U) |
+                                                      (static_cast<std::uint32_t>(cR) & 0xFFFFU))),
+             _mm_set1_epi32(cG & 0xFFFF),
+             _mm_set1_epi32(128 + (offset << 8)) };
+}
+
+inline __m128i computeComponent(const __m128i rb, const __m128i gx, const PackedCoefficients &c) noexcept
+{
+    const __m128i sum { _mm_add_epi32(_mm_madd_epi16(rb, c.rb), _mm_madd_epi16(gx, c.gx)) };
+    return _mm_srai_epi32(_mm_add_epi32(sum, c.bias), 8);
+}
+
+// Stores 16 bytes, bypassing the caches if stream is set (dst must then be 16 byte aligned)
+inline void store(std::uint8_t *dst, const __m128i value, const bool stream) noexcept
+{
+    if (stream) {
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst), value);
+    } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), value);
+    }
+}
+
+inline bool isAligned(const std::uint8_t *pointer) noexcept
+{
+    return (reinterpret_cast<std::uintptr_t>(pointer) % 16U) == 0U;
+}
+
+template<bool streamLuma, bool streamChroma>
+void convertRow(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    constexpr std::uint32_t pixelsPerIteration { 16U };
+    const __m128i expandRgb { _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1) };
+    const __m128i maskRb { _mm_set1_epi32(0x00FF00FF) };
+    const Coefficients &matrix { getCoefficients(colorMatrix) };
+    const PackedCoefficients cY { makeCoefficients(matrix.yR, matrix.yG, matrix.yB, matrix.yOffset) };
+    const PackedCoefficients cU { makeCoefficients(matrix.uR, matrix.uG, matrix.uB, matrix.uvOffset) };
+    const PackedCoefficients cV { makeCoefficients(matrix.vR, matrix.vG, matrix.vB, matrix.uvOffset) };
+
+    // RGB888 loads read 16 bytes for 4 pixels, keep the last load within the row
+    const std::uint32_t overread { (bytesPerPixel == 3U) ? 4U : 0U };
+    std::uint32_t x { 0U };
+    bool streamY { false };
+    bool streamU { false };
+    bool streamV { false };
+    if (streamLuma) {
+        // Convert the pixels in front of the first aligned luma address with regular stores
+        x = std::min(width, static_cast<std::uint32_t>((0U - reinterpret_cast<std::uintptr_t>(y)) % 16U));
+        convertRowScalar(src, x, bytesPerPixel, colorMatrix, y, u, v);
+        streamY = true;
+        streamU = streamChroma && isAligned(u + x);
+        streamV = streamChroma && isAligned(v + x);
+    }
+
+    for (; (x + pixelsPerIteration) * bytesPerPixel + overread <= width * bytesPerPixel; x += pixelsPerIteration)
+    {
+        __m128i yv[4U];
+        __m128i uv[4U];
+        __m128i vv[4U];
+        for (std::uint32_t idx { 0U }; idx < 4U; ++idx)
+        {
+            const std::uint8_t *pixels { src + (x + 4U * idx) * bytesPerPixel };
+            __m128i rgbx { _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels)) };
+            if (bytesPerPixel == 3U) {
+                rgbx = _mm_shuffle_epi8(rgbx, expandRgb);
+            }
+            const __m128i rb { _mm_and_si128(rgbx, maskRb) };
+            const __m128i gx { _mm_srli_epi16(rgbx, 8) };
+            yv[idx] = computeComponent(rb, gx, cY);
+            uv[idx] = computeComponent(rb, gx, cU);
+            vv[idx] = computeComponent(rb, gx, cV);
+        }
+
+        store(y + x, _mm_packus_epi16(_mm_packs_epi32(yv[0U], yv[1U]), _mm_packs_epi32(yv[2U], yv[3U])),
+              streamY);
+        store(u + x, _mm_packus_epi16(_mm_packs_epi32(uv[0U], uv[1U]), _mm_packs_epi32(uv[2U], uv[3U])),
+              streamU);
+        store(v + x, _mm_packus_epi16(_mm_packs_epi32(vv[0U], vv[1U]), _mm_packs_epi32(vv[2U], vv[3U])),
+              streamV);
+    }
+
+    convertRowScalar(src + x * bytesPerPixel, width - x, bytesPerPixel, colorMatrix, y + x, u + x, v + x);
+}
+
+} // namespace
+
+void convertRowSse41(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                     const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<false, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowSse41Stream(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                           const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, true>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+void convertRowSse41StreamLuma(const std::uint8_t *src, const std::uint32_t width, const std::uint32_t bytesPerPixel,
+                               const utils::ColorMatrix colorMatrix, std::uint8_t *y, std::uint8_t *u, std::uint8_t *v)
+{
+    convertRow<true, false>(src, width, bytesPerPixel, colorMatrix, y, u, v);
+}
+
+} // namespace kernels
+
+} // namespace rgb2yuv
@@ -0,0 +1,637 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Bit exactness test of the rgb2yuv::Converter kernels.
+//
+// Randomized images of random widths, heights and strides are converted with every entry of
+// rgb2yuv::kernels::ct_dispatchTable supported by the CPU and compared byte for byte against the
+// scalar kernels, which in turn are compared against a straightforward per pixel reference.
+//
+// Usage: rgb2yuv_converter_test [seed] [iterations]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "rgb2yuv.hpp"
+#include "rgb2yuv_converter.hpp"
+#include "rgb2yuv_converter_kernels.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+
+namespace
+{
+
+using rgb2yuv::utils::ColorFormat;
+using rgb2yuv::utils::ColorMatrix;
+using rgb2yuv::utils::SimdTier;
+
+constexpr ColorMatrix ct_colorMatrices[] { ColorMatrix::bt601, ColorMatrix::bt709, ColorMatrix::bt601_full };
+
+constexpr ColorFormat ct_inputColorFormats[] { ColorFormat::rgb888, ColorFormat::rgba8888 };
+constexpr ColorFormat ct_outputColorFormats[] { ColorFormat::uyvy, ColorFormat::yuv420_nv12, ColorFormat::yuv444_packed,
+                                                ColorFormat::yuv444_planar, ColorFormat::yuyv };
+
+std::uint32_t g_numFailures { 0U };
+
+std::uint8_t referenceComponent(const std::int32_t r, const std::int32_t g, const std::int32_t b,
+                                const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                const std::int32_t offset)
+{
+    const std::int32_t value { ((cR * r + cG * g + cB * b + 128) >> 8) + offset };
+    return static_cast<std::uint8_t>(std::min(255, std::max(0, value)));
+}
+
+std::vector<std::uint8_t> referencePlanar(const std::vector<std::uint8_t> &src, const std::size_t srcStride,
+                                          const std::uint32_t width, const std::uint32_t height,
+                                          const std::uint32_t bytesPerPixel, const ColorMatrix colorMatrix)
+{
+    const rgb2yuv::kernels::Coefficients &c { rgb2yuv::kernels::getCoefficients(colorMatrix) };
+    const std::size_t planeSize { static_cast<std::size_t>(width) * height };
+    std::vector<std::uint8_t> ret(planeSize * 3U);
+
+    for (std::uint32_t row { 0U }; row < height; ++row)
+    {
+        for (std::uint32_t x { 0U }; x < width; ++x)
+        {
+            const std::uint8_t *pixel { &src[row * srcStride + x * bytesPerPixel] };
+            const std::size_t idx { static_cast<std::size_t>(row) * width + x };
+            ret[idx] = referenceComponent(pixel[0U], pixel[1U], pixel[2U], c.yR, c.yG, c.yB, c.yOffset);
+            ret[planeSize + idx] = referenceComponent(pixel[0U], pixel[1U], pixel[2U], c.uR, c.uG, c.uB, c.uvOffset);
+            ret[2U * planeSize + idx] = referenceComponent(pixel[0U], pixel[1U], pixel[2U], c.vR, c.vG, c.vB, c.uvOffset);
+        }
+    }
+
+    return ret;
+}
+
+std::vector<std::uint8_t> referenceDownscaleNv12(const std::vector<std::uint8_t> &src, const std::uint32_t width,
+                                                 const std::uint32_t height)
+{
+    const std::uint32_t dstWidth { width / 2U };
+    const std::uint32_t dstHeight { height / 2U };
+    std::vector<std::uint8_t> ret(static_cast<std::size_t>(dstWidth) * dstHeight * 3U / 2U);
+    const auto average = [&](const std::size_t base, const std::size_t step, const std::size_t stride)
+    {
+        return static_cast<std::uint8_t>((src[base] + src[base + step] + src[base + stride] + src[base + stride + step] + 2U) >> 2U);
+    };
+
+    for (std::uint32_t y { 0U }; y < dstHeight; ++y)
+    {
+        for (std::uint32_t x { 0U }; x < dstWidth; ++x)
+        {
+            ret[y * dstWidth + x] = average(2U * y * width + 2U * x, 1U, width);
+        }
+    }
+
+    const std::size_t srcChroma { static_cast<std::size_t>(width) * height };
+    const std::size_t dstChroma { static_cast<std::size_t>(dstWidth) * dstHeight };
+    for (std::uint32_t y { 0U }; y < dstHeight / 2U; ++y)
+    {
+        for (std::uint32_t x { 0U }; x < dstWidth / 2U; ++x)
+        {
+            ret[dstChroma + y * dstWidth + 2U * x] = average(srcChroma + 2U * y * width + 4U * x, 2U, width);
+            ret[dstChroma + y * dstWidth + 2U * x + 1U] = average(srcChroma + 2U * y * width + 4U * x + 1U, 2U, width);
+        }
+    }
+
+    return ret;
+}
+
+template<typename Expected, typename Actual>
+void expectEqual(const Expected &expected, const Actual &actual,
+                 const char *what, const SimdTier simdTier, const std::uint32_t width, const std::uint32_t height,
+                 const std::uint32_t format)
+{
+    if (expected.size() != actual.size()) {
+        std::cerr << "FAIL " << what << " tier=" << rgb2yuv::utils::toString(simdTier) << " " << width << "x" << height
+                  << " format=" << format << ": size " << actual.size() << " != " << expected.size() << "\n";
+        ++g_numFailures;
+        return;
+    }
+
+    const auto mismatch { std::mismatch(expected.begin(), expected.end(), actual.begin()) };
+    if (mismatch.first != expected.end()) {
+        std::cerr << "FAIL " << what << " tier=" << rgb2yuv::utils::toString(simdTier) << " " << width << "x" << height
+                  << " format=" << format << ": byte " << (mismatch.first - expected.begin()) << " is "
+                  << static_cast<std::uint32_t>(*mismatch.second) << ", expected "
+                  << static_cast<std::uint32_t>(*mismatch.first) << "\n";
+        ++g_numFailures;
+    }
+}
+
+void testRowKernels(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    std::uniform_int_distribution<std::uint32_t> widthDist(0U, 300U);
+    std::uniform_int_distribution<std::uint32_t> offsetDist(0U, 63U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    std::uniform_int_distribution<std::uint32_t> matrixDist(0U, std::size(ct_colorMatrices) - 1U);
+    const std::uint32_t width { widthDist(rng) };
+    const std::uint32_t offset { offsetDist(rng) };
+    const ColorMatrix colorMatrix { ct_colorMatrices[matrixDist(rng)] };
+
+    for (const std::uint32_t bytesPerPixel : { 3U, 4U })
+    {
+        // Exactly sized buffers so that out of bounds accesses are caught by sanitizers
+        std::vector<std::uint8_t> src(offset + width * bytesPerPixel);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+
+        std::vector<std::uint8_t> expected(3U * width);
+        rgb2yuv::kernels::convertRowScalar(src.data() + offset, width, bytesPerPixel, colorMatrix, expected.data(),
+                                           expected.data() + width, expected.data() + 2U * width);
+        expectEqual(referencePlanar(std::vector<std::uint8_t>(src.begin() + offset, src.end()), 0U, width, 1U,
+                                    bytesPerPixel, colorMatrix),
+                    expected, "row reference", SimdTier::scalar, width, 1U, bytesPerPixel);
+
+        for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+        {
+            if (entry.simdTier > widestSimdTier) {
+                continue;
+            }
+            // Misalign the destination so that the non-temporal variants go through their unaligned head
+            const std::uint32_t dstOffset { offsetDist(rng) };
+            for (const rgb2yuv::kernels::ConvertRowFn convertRow : { entry.convertRow, entry.convertRowStream,
+                                                                     entry.convertRowStreamLuma })
+            {
+                std::vector<std::uint8_t> actual(dstOffset + 3U * width);
+                std::uint8_t *dst { actual.data() + dstOffset };
+                convertRow(src.data() + offset, width, bytesPerPixel, colorMatrix, dst, dst + width, dst + 2U * width);
+                actual.erase(actual.begin(), actual.begin() + dstOffset);
+                expectEqual(expected, actual, "row kernel", entry.simdTier, width, 1U, bytesPerPixel);
+            }
+        }
+    }
+}
+
+void testConverter(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    std::uniform_int_distribution<std::uint32_t> widthDist(1U, 400U);
+    std::uniform_int_distribution<std::uint32_t> heightDist(1U, 24U);
+    std::uniform_int_distribution<std::uint32_t> paddingDist(0U, 40U);
+    std::uniform_int_distribution<std::uint32_t> threadsDist(1U, 4U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    std::uniform_int_distribution<std::uint32_t> matrixDist(0U, std::size(ct_colorMatrices) - 1U);
+    rgb2yuv::ThreadPool threadPool(threadsDist(rng));
+    // The SIMD converters run on pinned workers, so that static banding is compared against dynamic banding
+    rgb2yuv::ThreadPool pinnedThreadPool(threadsDist(rng), true);
+    // Alternate between regular and non-temporal stores for the SIMD converters
+    std::uniform_int_distribution<std::size_t> streamingDist(0U, 1U);
+    const std::size_t streamingThreshold { (streamingDist(rng) == 0U) ? 0U : std::numeric_limits<std::size_t>::max() };
+    const ColorMatrix colorMatrix { ct_colorMatrices[matrixDist(rng)] };
+
+    for (const ColorFormat inputColorFormat : ct_inputColorFormats)
+    {
+        const std::uint32_t bytesPerPixel { rgb2yuv::Converter::getBytesPerPixel(inputColorFormat) };
+        for (const ColorFormat outputColorFormat : ct_outputColorFormats)
+        {
+            // Chroma subsampled formats require even dimensions
+            const std::uint32_t width { (widthDist(rng) + 1U) & ~1U };
+            const std::uint32_t height { (heightDist(rng) + 1U) & ~1U };
+            const std::size_t srcStride { static_cast<std::size_t>(width) * bytesPerPixel + paddingDist(rng) };
+            std::vector<std::uint8_t> src((height - 1U) * srcStride + width * bytesPerPixel);
+            std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+
+            rgb2yuv::Converter scalar(inputColorFormat, outputColorFormat, colorMatrix, SimdTier::scalar, threadPool);
+            scalar.init();
+            const rgb2yuv::FrameBuffer expected { scalar.convert(src.data(), srcStride, width, height) };
+            if (outputColorFormat == ColorFormat::yuv444_planar) {
+                expectEqual(referencePlanar(src, srcStride, width, height, bytesPerPixel, colorMatrix), expected, "reference",
+                            SimdTier::scalar, width, height, static_cast<std::uint32_t>(outputColorFormat));
+            }
+
+            for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+            {
+                if ((entry.simdTier == SimdTier::scalar) || (entry.simdTier > widestSimdTier)) {
+                    continue;
+                }
+                rgb2yuv::Converter converter(inputColorFormat, outputColorFormat, colorMatrix, entry.simdTier,
+                                             pinnedThreadPool, streamingThreshold);
+                converter.init();
+                expectEqual(expected, converter.convert(src.data(), srcStride, width, height), "converter",
+                            entry.simdTier, width, height, static_cast<std::uint32_t>(outputColorFormat));
+
+                // Change a random rectangle and reconvert only the changed tiles on top of the previous output
+                std::vector<std::uint8_t> nextSrc(src);
+                const std::uint32_t x0 { std::uniform_int_distribution<std::uint32_t>(0U, width - 1U)(rng) };
+                const std::uint32_t y0 { std::uniform_int_distribution<std::uint32_t>(0U, height - 1U)(rng) };
+                const std::uint32_t x1 { std::uniform_int_distribution<std::uint32_t>(x0, width - 1U)(rng) };
+                const std::uint32_t y1 { std::uniform_int_distribution<std::uint32_t>(y0, height - 1U)(rng) };
+                for (std::uint32_t row { y0 }; row <= y1; ++row)
+                {
+                    std::generate_n(nextSrc.begin() + row * srcStride + x0 * bytesPerPixel, (x1 - x0 + 1U) * bytesPerPixel,
+                                    [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+                }
+                const rgb2yuv::FrameBuffer nextExpected { scalar.convert(nextSrc.data(), srcStride, width, height) };
+                expectEqual(nextExpected, converter.convertDirty(nextSrc.data(), src.data(), srcStride, width, height),
+                            "dirty converter", entry.simdTier, width, height, static_cast<std::uint32_t>(outputColorFormat));
+            }
+        }
+    }
+}
+
+void testPyramid(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    std::uniform_int_distribution<std::uint32_t> levelsDist(2U, 4U);
+    std::uniform_int_distribution<std::uint32_t> blocksDist(1U, 12U);
+    std::uniform_int_distribution<std::uint32_t> threadsDist(1U, 4U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    const std::uint32_t numLevels { levelsDist(rng) };
+    // Every level must have even dimensions
+    const std::uint32_t width { blocksDist(rng) << numLevels };
+    const std::uint32_t height { blocksDist(rng) << numLevels };
+    const std::size_t srcStride { static_cast<std::size_t>(width) * 3U };
+    std::vector<std::uint8_t> src(srcStride * height);
+    std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+
+    rgb2yuv::ThreadPool threadPool(threadsDist(rng), threadsDist(rng) > 2U);
+    rgb2yuv::Converter converter(ColorFormat::rgb888, ColorFormat::yuv420_nv12, ColorMatrix::bt601, widestSimdTier,
+                                 threadPool, 0U, numLevels);
+    converter.init();
+    std::vector<std::uint8_t> expected;
+    {
+        rgb2yuv::Converter scalar(ColorFormat::rgb888, ColorFormat::yuv420_nv12, ColorMatrix::bt601, SimdTier::scalar,
+                                  threadPool);
+        scalar.init();
+        const rgb2yuv::FrameBuffer &converted { scalar.convert(src.data(), srcStride, width, height) };
+        expected.assign(converted.begin(), converted.end());
+    }
+    expectEqual(expected, converter.convert(src.data(), srcStride, width, height), "pyramid level 0",
+                widestSimdTier, width, height, numLevels);
+
+    const std::vector<rgb2yuv::FrameBuffer> &pyramid { converter.getPyramid() };
+    if (pyramid.size() != numLevels - 1U) {
+        std::cerr << "FAIL pyramid: " << pyramid.size() << " levels, expected " << (numLevels - 1U) << "\n";
+        ++g_numFailures;
+        return;
+    }
+    for (std::uint32_t level { 1U }; level < numLevels; ++level)
+    {
+        expected = referenceDownscaleNv12(expected, width >> (level - 1U), height >> (level - 1U));
+        expectEqual(expected, pyramid[level - 1U], "pyramid level", widestSimdTier, width >> level, height >> level, level);
+    }
+}
+
+void testAlpha(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    std::uniform_int_distribution<std::uint32_t> widthDist(0U, 300U);
+    std::uniform_int_distribution<std::uint32_t> heightDist(1U, 12U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    std::uniform_int_distribution<std::uint32_t> threadsDist(1U, 4U);
+    std::uniform_int_distribution<std::uint32_t> matrixDist(0U, std::size(ct_colorMatrices) - 1U);
+    const ColorMatrix colorMatrix { ct_colorMatrices[matrixDist(rng)] };
+    const rgb2yuv::kernels::Coefficients &c { rgb2yuv::kernels::getCoefficients(colorMatrix) };
+    const std::uint32_t background { byteDist(rng) << 16U | byteDist(rng) << 8U | byteDist(rng) };
+
+    for (const rgb2yuv::utils::AlphaMode alphaMode : { rgb2yuv::utils::AlphaMode::composite, rgb2yuv::utils::AlphaMode::plane })
+    {
+        // Row kernels against the per pixel formula
+        const std::uint32_t width { widthDist(rng) };
+        std::vector<std::uint8_t> src(4U * width);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+        std::vector<std::uint8_t> expected(4U * width);
+        for (std::uint32_t x { 0U }; x < width; ++x)
+        {
+            std::int32_t rgb[3U] { src[4U * x], src[4U * x + 1U], src[4U * x + 2U] };
+            const std::int32_t alpha { src[4U * x + 3U] };
+            if (alphaMode == rgb2yuv::utils::AlphaMode::composite) {
+                for (std::uint32_t channel { 0U }; channel < 3U; ++channel)
+                {
+                    const std::int32_t backgroundChannel { static_cast<std::int32_t>((background >> (16U - 8U * channel)) & 0xFFU) };
+                    // Round to nearest, the numerator is never an odd multiple of 127.5
+                    rgb[channel] = (rgb[channel] * alpha + backgroundChannel * (255 - alpha) + 127) / 255;
+                }
+            } else {
+                expected[3U * width + x] = static_cast<std::uint8_t>(alpha);
+            }
+            expected[x] = referenceComponent(rgb[0U], rgb[1U], rgb[2U], c.yR, c.yG, c.yB, c.yOffset);
+            expected[width + x] = referenceComponent(rgb[0U], rgb[1U], rgb[2U], c.uR, c.uG, c.uB, c.uvOffset);
+            expected[2U * width + x] = referenceComponent(rgb[0U], rgb[1U], rgb[2U], c.vR, c.vG, c.vB, c.uvOffset);
+        }
+        for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+        {
+            if (entry.simdTier > widestSimdTier) {
+                continue;
+            }
+            std::vector<std::uint8_t> actual(4U * width);
+            entry.convertRowAlpha(src.data(), width, alphaMode, background, colorMatrix, actual.data(),
+                                  actual.data() + width, actual.data() + 2U * width, actual.data() + 3U * width);
+            expectEqual(expected, actual, "row kernel alpha", entry.simdTier, width, 1U,
+                        static_cast<std::uint32_t>(alphaMode));
+        }
+
+        // SIMD converters against the scalar converter
+        for (const ColorFormat outputColorFormat : ct_outputColorFormats)
+        {
+            const std::uint32_t imageWidth { 2U * (widthDist(rng) / 2U + 1U) };
+            const std::uint32_t imageHeight { 2U * heightDist(rng) };
+            std::vector<std::uint8_t> image(static_cast<std::size_t>(imageWidth) * imageHeight * 4U);
+            std::generate(image.begin(), image.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+
+            rgb2yuv::ThreadPool threadPool(threadsDist(rng));
+            rgb2yuv::Converter scalar(ColorFormat::rgba8888, outputColorFormat, colorMatrix, SimdTier::scalar, threadPool,
+                                      std::numeric_limits<std::size_t>::max(), 1U, alphaMode, background);
+            scalar.init();
+            const rgb2yuv::FrameBuffer imageExpected { scalar.convert(image.data(), imageWidth * 4U, imageWidth, imageHeight) };
+            for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+            {
+                if ((entry.simdTier == SimdTier::scalar) || (entry.simdTier > widestSimdTier)) {
+                    continue;
+                }
+                // Streaming stores must not bypass the alpha kernel
+                rgb2yuv::Converter converter(ColorFormat::rgba8888, outputColorFormat, colorMatrix, entry.simdTier,
+                                             threadPool, 0U, 1U, alphaMode, background);
+                converter.init();
+                expectEqual(imageExpected, converter.convert(image.data(), imageWidth * 4U, imageWidth, imageHeight),
+                            "converter alpha", entry.simdTier, imageWidth, imageHeight,
+                            static_cast<std::uint32_t>(outputColorFormat));
+            }
+        }
+    }
+}
+
+std::uint16_t referenceComponent16(const std::int32_t r, const std::int32_t g, const std::int32_t b,
+                                   const std::int32_t cR, const std::int32_t cG, const std::int32_t cB,
+                                   const std::int32_t offset, const std::uint32_t bitDepth)
+{
+    const std::int32_t value { std::min(65535, std::max(0, ((cR * r + cG * g + cB * b + 128) >> 8) + offset * 256)) };
+    const std::uint32_t shift { 16U - bitDepth };
+    const std::int32_t maxValue { 65535 >> shift };
+    return static_cast<std::uint16_t>(std::min(maxValue, (value + ((1 << shift) >> 1)) >> shift) << shift);
+}
+
+void testHighBitDepth(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    std::uniform_int_distribution<std::uint32_t> widthDist(1U, 300U);
+    std::uniform_int_distribution<std::uint32_t> heightDist(1U, 24U);
+    std::uniform_int_distribution<std::uint32_t> paddingDist(0U, 20U);
+    std::uniform_int_distribution<std::uint32_t> threadsDist(1U, 4U);
+    std::uniform_int_distribution<std::uint32_t> sampleDist(0U, 65535U);
+    std::uniform_int_distribution<std::uint32_t> matrixDist(0U, std::size(ct_colorMatrices) - 1U);
+    const ColorMatrix colorMatrix { ct_colorMatrices[matrixDist(rng)] };
+    const rgb2yuv::kernels::Coefficients &c { rgb2yuv::kernels::getCoefficients(colorMatrix) };
+
+    for (const std::uint32_t bitDepth : { 10U, 16U })
+    {
+        // Row kernels against the per pixel formula
+        const std::uint32_t rowWidth { widthDist(rng) };
+        std::vector<std::uint16_t> rowSrc(3U * rowWidth);
+        std::generate(rowSrc.begin(), rowSrc.end(), [&] { return static_cast<std::uint16_t>(sampleDist(rng)); });
+        std::vector<std::uint16_t> rowExpected(3U * rowWidth);
+        for (std::uint32_t x { 0U }; x < rowWidth; ++x)
+        {
+            const std::int32_t r { rowSrc[3U * x] };
+            const std::int32_t g { rowSrc[3U * x + 1U] };
+            const std::int32_t b { rowSrc[3U * x + 2U] };
+            rowExpected[x] = referenceComponent16(r, g, b, c.yR, c.yG, c.yB, c.yOffset, bitDepth);
+            rowExpected[rowWidth + x] = referenceComponent16(r, g, b, c.uR, c.uG, c.uB, c.uvOffset, bitDepth);
+            rowExpected[2U * rowWidth + x] = referenceComponent16(r, g, b, c.vR, c.vG, c.vB, c.uvOffset, bitDepth);
+        }
+        for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+        {
+            if (entry.simdTier > widestSimdTier) {
+                continue;
+            }
+            std::vector<std::uint16_t> actual(3U * rowWidth);
+            entry.convertRow16(rowSrc.data(), rowWidth, bitDepth, colorMatrix, actual.data(), actual.data() + rowWidth,
+                               actual.data() + 2U * rowWidth);
+            expectEqual(rowExpected, actual, "row kernel 16bit", entry.simdTier, rowWidth, 1U, bitDepth);
+        }
+
+        // SIMD converters against the scalar converter
+        const ColorFormat outputColorFormat { (bitDepth == 10U) ? ColorFormat::yuv420_p010 : ColorFormat::yuv420_p016 };
+        const std::uint32_t width { (widthDist(rng) + 1U) & ~1U };
+        const std::uint32_t height { (heightDist(rng) + 1U) & ~1U };
+        // Rows of 16bit samples start on even addresses
+        const std::size_t srcStride { static_cast<std::size_t>(width) * 6U + 2U * paddingDist(rng) };
+        std::vector<std::uint16_t> src(((height - 1U) * srcStride + width * 6U) / 2U);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint16_t>(sampleDist(rng)); });
+        const std::uint8_t *srcBytes { reinterpret_cast<const std::uint8_t *>(src.data()) };
+
+        rgb2yuv::ThreadPool threadPool(threadsDist(rng));
+        rgb2yuv::Converter scalar(ColorFormat::rgb161616, outputColorFormat, colorMatrix, SimdTier::scalar, threadPool);
+        scalar.init();
+        const rgb2yuv::FrameBuffer expected { scalar.convert(srcBytes, srcStride, width, height) };
+        for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+        {
+            if ((entry.simdTier == SimdTier::scalar) || (entry.simdTier > widestSimdTier)) {
+                continue;
+            }
+            rgb2yuv::Converter converter(ColorFormat::rgb161616, outputColorFormat, colorMatrix, entry.simdTier, threadPool);
+            converter.init();
+            expectEqual(expected, converter.convert(srcBytes, srcStride, width, height), "converter 16bit",
+                        entry.simdTier, width, height, static_cast<std::uint32_t>(outputColorFormat));
+        }
+    }
+}
+
+// Filters full resolution chroma planes with the 2D taps of chromaFilter, clamping rows and columns to the
+// plane, into interleaved U and V pairs of maxValue at most
+std::vector<std::int32_t> referenceSubsample(const std::vector<std::int32_t> &u, const std::vector<std::int32_t> &v,
+                                             const std::uint32_t width, const std::uint32_t height,
+                                             const rgb2yuv::utils::ChromaFilter chromaFilter, const bool isVertical,
+                                             const std::int32_t maxValue)
+{
+    struct Tap
+    {
+        std::int32_t offset;
+        std::int32_t weight;
+    };
+    const std::vector<Tap> horizontalTaps { (chromaFilter == rgb2yuv::utils::ChromaFilter::box) ? std::vector<Tap> { { 0, 1 }, { 1, 1 } } :
+                                            (chromaFilter == rgb2yuv::utils::ChromaFilter::cosited) ? std::vector<Tap> { { -1, 1 }, { 0, 2 }, { 1, 1 } } :
+                                            std::vector<Tap> { { -3, -1 }, { -1, 9 }, { 0, 16 }, { 1, 9 }, { 3, -1 } } };
+    const std::vector<Tap> verticalTaps { !isVertical ? std::vector<Tap> { { 0, 1 } } :
+                                          (chromaFilter == rgb2yuv::utils::ChromaFilter::lanczos) ?
+                                          std::vector<Tap> { { -2, -3 }, { -1, 7 }, { 0, 28 }, { 1, 28 }, { 2, 7 }, { 3, -3 } } :
+                                          std::vector<Tap> { { 0, 1 }, { 1, 1 } } };
+    std::int32_t norm { 0 };
+    for (const Tap &horizontal : horizontalTaps)
+    {
+        for (const Tap &vertical : verticalTaps)
+        {
+            norm += horizontal.weight * vertical.weight;
+        }
+    }
+
+    const std::uint32_t chromaHeight { isVertical ? height / 2U : height };
+    std::vector<std::int32_t> ret(static_cast<std::size_t>(width) * chromaHeight);
+    for (std::uint32_t row { 0U }; row < chromaHeight; ++row)
+    {
+        for (std::uint32_t x { 0U }; x < width; x += 2U)
+        {
+            for (std::uint32_t plane { 0U }; plane < 2U; ++plane)
+            {
+                std::int32_t sum { 0 };
+                for (const Tap &vertical : verticalTaps)
+                {
+                    const std::int32_t srcRow { std::min(std::max(static_cast<std::int32_t>(isVertical ? 2U * row : row) + vertical.offset, 0),
+                                                         static_cast<std::int32_t>(height) - 1) };
+                    for (const Tap &horizontal : horizontalTaps)
+                    {
+                        const std::int32_t srcX { std::min(std::max(static_cast<std::int32_t>(x) + horizontal.offset, 0),
+                                                           static_cast<std::int32_t>(width) - 1) };
+                        const std::size_t idx { static_cast<std::size_t>(srcRow) * width + srcX };
+                        sum += vertical.weight * horizontal.weight * ((plane == 0U) ? u[idx] : v[idx]);
+                    }
+                }
+                // Rounded to nearest, ties up, as an arithmetic shift of sum + norm / 2 rounds
+                const std::int32_t rounded { sum + norm / 2 };
+                const std::int32_t quotient { (rounded >= 0) ? (rounded / norm) : -((norm - 1 - rounded) / norm) };
+                ret[static_cast<std::size_t>(row) * width + x + plane] = std::min(std::max(quotient, 0), maxValue);
+            }
+        }
+    }
+
+    return ret;
+}
+
+void testChromaFilter(std::mt19937 &rng, const SimdTier widestSimdTier)
+{
+    using rgb2yuv::utils::ChromaFilter;
+    std::uniform_int_distribution<std::uint32_t> widthDist(1U, 200U);
+    std::uniform_int_distribution<std::uint32_t> heightDist(1U, 24U);
+    std::uniform_int_distribution<std::uint32_t> threadsDist(1U, 4U);
+    std::uniform_int_distribution<std::uint32_t> sampleDist(0U, 65535U);
+    std::uniform_int_distribution<std::uint32_t> matrixDist(0U, std::size(ct_colorMatrices) - 1U);
+    const ColorMatrix colorMatrix { ct_colorMatrices[matrixDist(rng)] };
+    const rgb2yuv::kernels::Coefficients &c { rgb2yuv::kernels::getCoefficients(colorMatrix) };
+    // Small images split into bands of 2 rows on several workers, so the vertical taps cross band edges
+    rgb2yuv::ThreadPool threadPool(threadsDist(rng));
+
+    for (const ChromaFilter chromaFilter : { ChromaFilter::box, ChromaFilter::cosited, ChromaFilter::lanczos })
+    {
+        for (const ColorFormat outputColorFormat : { ColorFormat::uyvy, ColorFormat::yuyv, ColorFormat::yuv420_nv12,
+                                                     ColorFormat::yuv420_p010, ColorFormat::yuv420_p016 })
+        {
+            const bool isHighBitDepth { (outputColorFormat == ColorFormat::yuv420_p010) ||
+                                        (outputColorFormat == ColorFormat::yuv420_p016) };
+            const bool isVertical { (outputColorFormat != ColorFormat::uyvy) && (outputColorFormat != ColorFormat::yuyv) };
+            const ColorFormat inputColorFormat { isHighBitDepth ? ColorFormat::rgb161616 : ColorFormat::rgb888 };
+            const std::uint32_t bytesPerPixel { rgb2yuv::Converter::getBytesPerPixel(inputColorFormat) };
+            const std::uint32_t shift { (outputColorFormat == ColorFormat::yuv420_p010) ? 6U : 0U };
+            const std::uint32_t width { (widthDist(rng) + 1U) & ~1U };
+            const std::uint32_t height { (heightDist(rng) + 1U) & ~1U };
+            const std::size_t srcStride { static_cast<std::size_t>(width) * bytesPerPixel };
+            std::vector<std::uint8_t> src(height * srcStride);
+            if (isHighBitDepth) {
+                std::uint16_t *samples { reinterpret_cast<std::uint16_t *>(src.data()) };
+                std::generate_n(samples, src.size() / 2U, [&] { return static_cast<std::uint16_t>(sampleDist(rng)); });
+            } else {
+                std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(sampleDist(rng)); });
+            }
+
+            // Full resolution chroma at the significant bits of the output samples
+            const std::size_t planeSize { static_cast<std::size_t>(width) * height };
+            std::vector<std::int32_t> u(planeSize);
+            std::vector<std::int32_t> v(planeSize);
+            if (isHighBitDepth) {
+                const std::uint16_t *samples { reinterpret_cast<const std::uint16_t *>(src.data()) };
+                for (std::size_t idx { 0U }; idx < planeSize; ++idx)
+                {
+                    const std::int32_t r { samples[3U * idx] };
+                    const std::int32_t g { samples[3U * idx + 1U] };
+                    const std::int32_t b { samples[3U * idx + 2U] };
+                    u[idx] = referenceComponent16(r, g, b, c.uR, c.uG, c.uB, c.uvOffset, 16U - shift) >> shift;
+                    v[idx] = referenceComponent16(r, g, b, c.vR, c.vG, c.vB, c.uvOffset, 16U - shift) >> shift;
+                }
+            } else {
+                const std::vector<std::uint8_t> planar { referencePlanar(src, srcStride, width, height, bytesPerPixel, colorMatrix) };
+                std::copy(planar.begin() + planeSize, planar.begin() + 2U * planeSize, u.begin());
+                std::copy(planar.begin() + 2U * planeSize, planar.end(), v.begin());
+            }
+            const std::vector<std::int32_t> chroma { referenceSubsample(u, v, width, height, chromaFilter, isVertical,
+                                                                        (isHighBitDepth ? 65535 : 255) >> shift) };
+
+            rgb2yuv::Converter scalar(inputColorFormat, outputColorFormat, colorMatrix, SimdTier::scalar, threadPool,
+                                      std::numeric_limits<std::size_t>::max(), 1U, rgb2yuv::utils::AlphaMode::drop,
+                                      0U, chromaFilter);
+            scalar.init();
+            const rgb2yuv::FrameBuffer expected { scalar.convert(src.data(), srcStride, width, height) };
+
+            // Chroma of the scalar converter against the reference
+            std::vector<std::int32_t> actual(chroma.size());
+            for (std::size_t idx { 0U }; idx < chroma.size(); ++idx)
+            {
+                if (isHighBitDepth) {
+                    actual[idx] = reinterpret_cast<const std::uint16_t *>(expected.data())[planeSize + idx] >> shift;
+                } else if (isVertical) {
+                    actual[idx] = expected[planeSize + idx];
+                } else {
+                    // U and V are bytes 0 and 2 of UYVY, 1 and 3 of YUYV
+                    const std::size_t pair { (idx / 2U) * 4U + (idx % 2U) * 2U };
+                    actual[idx] = expected[pair + ((outputColorFormat == ColorFormat::uyvy) ? 0U : 1U)];
+                }
+            }
+            expectEqual(chroma, actual, "chroma filter reference", SimdTier::scalar, width, height,
+                        static_cast<std::uint32_t>(chromaFilter));
+
+            for (const rgb2yuv::kernels::KernelEntry &entry : rgb2yuv::kernels::ct_dispatchTable)
+            {
+                if ((entry.simdTier == SimdTier::scalar) || (entry.simdTier > widestSimdTier)) {
+                    continue;
+                }
+                rgb2yuv::Converter converter(inputColorFormat, outputColorFormat, colorMatrix, entry.simdTier, threadPool,
+                                             std::numeric_limits<std::size_t>::max(), 1U,
+                                             rgb2yuv::utils::AlphaMode::drop, 0U, chromaFilter);
+                converter.init();
+                expectEqual(expected, converter.convert(src.data(), srcStride, width, height), "chroma filter converter",
+                            entry.simdTier, width, height, static_cast<std::uint32_t>(chromaFilter));
+                expectEqual(expected, converter.convertDirty(src.data(), src.data(), srcStride, width, height),
+                            "chroma filter dirty converter", entry.simdTier, width, height,
+                            static_cast<std::uint32_t>(chromaFilter));
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::uint32_t seed { (argc > 1) ? static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 5489U };
+    const std::uint32_t iterations { (argc > 2) ? static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 200U };
+    std::mt19937 rng(seed);
+
+    rgb2yuv::Context context({ });
+    context.querySimdSupport();
+    const SimdTier widestSimdTier { context.getWidestSimdTier() };
+    std::cout << "seed=" << seed << " iterations=" << iterations << " widest tier="
+              << rgb2yuv::utils::toString(widestSimdTier) << "\n";
+
+    for (std::uint32_t iteration { 0U }; iteration < iterations; ++iteration)
+    {
+        testRowKernels(rng, widestSimdTier);
+        testConverter(rng, widestSimdTier);
+        testPyramid(rng, widestSimdTier);
+        testHighBitDepth(rng, widestSimdTier);
+        testAlpha(rng, widestSimdTier);
+        testChromaFilter(rng, widestSimdTier);
+    }
+
+    if (g_numFailures != 0U) {
+        std::cerr << g_numFailures << " mismatches\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "All kernels bit exact\n";
+    return EXIT_SUCCESS;
+}
@@ -18,7 +18,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include "rgb2yuv_decoder.hpp"
 
 namespace rgb2yuv
@@ -34,7 +37,16 @@ void Decoder::init()
         throw std::invalid_argument("Input color format not supported for decoding!");
     }
 
-    m_inputFileStream = std::fstream(m_inputFile, std::ios::in);
+    if ((m_inputFileFormat == utils::FileFormat::ppm) && (m_inputColorFormat != utils::ColorFormat::rgb888) &&
+        (m_inputColorFormat != utils::ColorFormat::rgb161616)) {
+        throw std::invalid_argument("PPM input files only carry rgb888 or rgb161616 color data!");
+    }
+
+    if (m_isFileRead) {
+        return;
+    }
+
+    m_inputFileStream = std::fstream(m_inputFile, std::ios::in | std::ios::binary);
     if (!m_inputFileStream.is_open()) {
         throw std::invalid_argument("Failed to open input file");
     }
@@ -45,19 +57,98 @@ void Decoder::deinit()
     if (m_inputFileStream.is_open()) {
         m_inputFileStream.close();
     }
+
+    m_fileData.clear();
+    m_fileData.shrink_to_fit();
+    m_isFileRead = false;
 }
 
-std::vector<std::uint8_t>& Decoder::decode()
+const std::vector<std::uint8_t> &Decoder::read()
+{
+    if (m_isFileRead) {
+        return m_fileData;
+    }
+
+    m_inputFileStream.seekg(0, std::ios::end);
+    const std::streamoff fileSize { m_inputFileStream.tellg() };
+    m_inputFileStream.seekg(0, std::ios::beg);
+    if (fileSize < 0) {
+        throw std::invalid_argument("Failed to read input file");
+    }
+
+    m_fileData.resize(static_cast<std::size_t>(fileSize));
+    if (!m_inputFileStream.read(reinterpret_cast<char *>(m_fileData.data()), fileSize)) {
+        throw std::invalid_argument("Failed to read input file");
+    }
+
+    m_isFileRead = true;
+    return m_fileData;
+}
+
+std::size_t Decoder::getBytesPerPixel() const noexcept
+{
+    std::size_t ret { 3U };
+
+    switch (m_inputColorFormat)
+    {
+        case(utils::ColorFormat::rgba8888):
+            ret = 4U;
+            break;
+        case(utils::ColorFormat::rgb161616):
+            ret = 6U;
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+std::uint32_t Decoder::decodeSequence()
+{
+    const std::size_t bytesPerPixel { getBytesPerPixel() };
+
+    if (m_inputFileFormat != utils::FileFormat::raw) {
+        throw std::invalid_argument("Frame sequences are only supported for raw input files");
+    }
+
+    if ((m_rawWidth == 0U) || (m_rawHeight == 0U)) {
+        throw std::invalid_argument("Width and height must be specified for raw input files");
+    }
+
+    read();
+    m_frameSize = static_cast<std::size_t>(m_rawWidth) * m_rawHeight * bytesPerPixel;
+    if (m_fileData.empty() || ((m_fileData.size() % m_frameSize) != 0U)) {
+        throw std::invalid_argument("Input raw file size is not a multiple of the frame size");
+    }
+
+    m_width = m_rawWidth;
+    m_height = m_rawHeight;
+    return static_cast<std::uint32_t>(m_fileData.size() / m_frameSize);
+}
+
+FrameBuffer& Decoder::decode()
+{
+    read();
+    return decode(m_fileData.data(), m_fileData.size());
+}
+
+FrameBuffer& Decoder::decode(const std::uint8_t *data, const std::size_t size)
 {
     try
     {
+        m_decodedData.clear();
+        m_width = 0U;
+        m_height = 0U;
+
         switch (m_inputFileFormat)
         {
             case(utils::FileFormat::ppm):
-                decodePpm();
+                decodePpm(data, size);
                 break;
             case(utils::FileFormat::raw):
-                decodeRaw();
+                decodeRaw(data, size);
                 break;
             default:
                 // Unreachable. Do nothing
@@ -72,59 +163,306 @@ std::vector<std::uint8_t>& Decoder::decode()
     }
 }
 
-void Decoder::decodePpm()
+namespace
+{
+
+inline bool isWhitespace(const std::uint8_t value) noexcept
+{
+    return (value == ' ') || (value == '\t') || (value == '\n') || (value == '\r') || (value == '\v') || (value == '\f');
+}
+
+// Skips whitespace and, if allowed, '#' comments running until the end of the line
+const std::uint8_t *skipWhitespace(const std::uint8_t *pos, const std::uint8_t *end, const bool allowComments) noexcept
+{
+    while (pos != end)
+    {
+        if (isWhitespace(*pos)) {
+            ++pos;
+        } else if (allowComments && (*pos == '#')) {
+            while ((pos != end) && (*pos != '\n') && (*pos != '\r'))
+            {
+                ++pos;
+            }
+        } else {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+// Parses an unsigned decimal value that must be followed by whitespace, a comment or the end of data
+bool parseUnsigned(const std::uint8_t *&pos, const std::uint8_t *end, const std::uint32_t maxValue,
+                   std::uint32_t &value) noexcept
+{
+    const std::uint8_t *start { pos };
+    std::uint64_t parsed { 0U };
+
+    while ((pos != end) && (*pos >= '0') && (*pos <= '9'))
+    {
+        parsed = parsed * 10U + (*pos - '0');
+        if (parsed > maxValue) {
+            return false;
+        }
+        ++pos;
+    }
+
+    value = static_cast<std::uint32_t>(parsed);
+    return (pos != start) && ((pos == end) || isWhitespace(*pos) || (*pos == '#'));
+}
+
+// Scales a sample in [0, maxValue] to the full range of T. 8bit samples always have a maxValue of 255.
+template<typename T>
+inline T scaleSample(const std::uint32_t value, const std::uint32_t maxValue) noexcept
+{
+    if constexpr (sizeof(T) == 1U) {
+        return static_cast<T>(value);
+    } else {
+        return static_cast<T>((static_cast<std::uint64_t>(value) * 65535U + maxValue / 2U) / maxValue);
+    }
+}
+
+// Parses count whitespace separated values <= maxValue into dst, and verifies that only whitespace follows them
+template<typename T>
+void parseValues(const std::uint8_t *pos, const std::uint8_t *end, T *dst, const std::size_t count,
+                 const std::uint32_t maxValue)
+{
+    for (std::size_t idx { 0U }; idx < count; ++idx)
+    {
+        std::uint32_t value { 0U };
+        pos = skipWhitespace(pos, end, false);
+        if (!parseUnsigned(pos, end, maxValue, value)) {
+            throw std::invalid_argument("Input PPM file contains an invalid RGB value");
+        }
+        dst[idx] = scaleSample<T>(value, maxValue);
+    }
+
+    if (skipWhitespace(pos, end, false) != end)
+    {
+        throw std::invalid_argument("Input PPM file dimensions do not match the number of RGB values present");
+    }
+}
+
+// Counts the whitespace separated tokens in [pos, end), pos must not be within a token
+std::size_t countTokens(const std::uint8_t *pos, const std::uint8_t *end) noexcept
+{
+    std::size_t ret { 0U };
+    bool isPreviousWhitespace { true };
+
+    for (; pos != end; ++pos)
+    {
+        const bool isCurrentWhitespace { isWhitespace(*pos) };
+        ret += (isPreviousWhitespace && !isCurrentWhitespace) ? 1U : 0U;
+        isPreviousWhitespace = isCurrentWhitespace;
+    }
+
+    return ret;
+}
+
+} // namespace
+
+void Decoder::decodePpm(const std::uint8_t *data, const std::size_t size)
 {
-    std::uint32_t width { 0U };
-    std::uint32_t height { 0U };
     std::uint32_t maxColorValue { 0U };
-    constexpr uint32_t expectedMaxColorValue { 255U };
+    constexpr std::uint32_t maxMaxColorValue { 65535U };
+    constexpr std::uint32_t maxDimension { 1U << 16U };
+    const bool isHighBitDepth { m_inputColorFormat == utils::ColorFormat::rgb161616 };
+    const std::uint8_t *pos { data };
+    const std::uint8_t *end { data + size };
+
     // Verify PPM header
-    std::string ppmMagic { };
-    std::string expectedPpmMagic { "P3" };
-    std::getline(m_inputFileStream, ppmMagic);
-    if (ppmMagic != expectedPpmMagic)
+    if ((size < 3U) || (data[0U] != 'P') || ((data[1U] != '3') && (data[1U] != '6')) || !isWhitespace(data[2U]))
     {
-        throw std::invalid_argument("Unsupported input PPM file. Only ASCII RGB PPM files (P3) are supported");
+        throw std::invalid_argument("Unsupported input PPM file. Only RGB PPM files (P3, P6) are supported");
     }
+    const bool isBinary { data[1U] == '6' };
+    pos += 2U;
 
     // Get width, height and max supported color value from PPM file
-    m_inputFileStream >> width;
-    m_inputFileStream >> height;
-    m_inputFileStream >> maxColorValue;
-    if (maxColorValue != expectedMaxColorValue)
-    {
-        throw std::invalid_argument("Input PPM file contains a maximum RGB value > 255. Not supported");
+    pos = skipWhitespace(pos, end, true);
+    const bool validWidth { parseUnsigned(pos, end, maxDimension, m_width) };
+    pos = skipWhitespace(pos, end, true);
+    const bool validHeight { parseUnsigned(pos, end, maxDimension, m_height) };
+    if (!validWidth || !validHeight || (m_width == 0U) || (m_height == 0U)) {
+        throw std::invalid_argument("Input PPM file contains invalid dimensions");
+    }
+
+    pos = skipWhitespace(pos, end, true);
+    if (!parseUnsigned(pos, end, maxMaxColorValue, maxColorValue) || (maxColorValue == 0U)) {
+        throw std::invalid_argument("Input PPM file contains an invalid maximum RGB value");
+    }
+
+    if (!isHighBitDepth && (maxColorValue != 255U)) {
+        throw std::invalid_argument("Input PPM file contains a maximum RGB value other than 255. Decode it as rgb161616");
+    }
+
+    const std::size_t numValues { static_cast<std::size_t>(m_width) * m_height * 3U };
+    const std::size_t rowBytes { static_cast<std::size_t>(m_width) * getBytesPerPixel() };
+    if (isBinary) {
+        // A single whitespace byte separates the header from the big endian samples
+        const std::size_t sampleSize { (maxColorValue > 255U) ? 2U : 1U };
+        if ((pos == end) || !isWhitespace(*pos) || (static_cast<std::size_t>(end - pos - 1) != numValues * sampleSize)) {
+            throw std::invalid_argument("Input PPM file dimensions do not match the number of RGB values present");
+        }
+
+        allocateDecodedData(rowBytes);
+        decodePpmSamples(pos + 1U, sampleSize, maxColorValue);
+        return;
+    }
+
+    // Every value takes at least two bytes (a digit and a separator), reject truncated files
+    // before allocating memory for them
+    if (numValues > static_cast<std::size_t>(end - pos)) {
+        throw std::invalid_argument("Input PPM file dimensions do not match the number of RGB values present");
     }
 
     // Get the ASCII RGB values from the file and store them in binary form
-    for (std::uint32_t readValue { 0U }; m_inputFileStream >> readValue;)
+    allocateDecodedData(rowBytes);
+    decodePpmValues(pos, end, maxColorValue);
+}
+
+void Decoder::decodePpmValues(const std::uint8_t *pos, const std::uint8_t *end, const std::uint32_t maxColorValue)
+{
+    const std::size_t payloadSize { static_cast<std::size_t>(end - pos) };
+    const std::uint32_t numThreads { (m_threadPool != nullptr) ? m_threadPool->getNumThreads() : 1U };
+    const std::uint32_t numChunks { static_cast<std::uint32_t>(std::min<std::size_t>(numThreads,
+                                                                                      payloadSize / ct_minChunkSize)) };
+    const bool isHighBitDepth { m_inputColorFormat == utils::ColorFormat::rgb161616 };
+    const std::size_t numValues { m_decodedData.size() / (isHighBitDepth ? 2U : 1U) };
+
+    // Parses count values from [first, last) into the values of m_decodedData starting at offset
+    const auto parse = [&](const std::uint8_t *first, const std::uint8_t *last, const std::size_t offset,
+                           const std::size_t count)
     {
-        m_decodedData.emplace_back(static_cast<std::uint8_t>(readValue));
+        if (isHighBitDepth) {
+            parseValues(first, last, reinterpret_cast<std::uint16_t *>(m_decodedData.data()) + offset, count,
+                        maxColorValue);
+        } else {
+            parseValues(first, last, m_decodedData.data() + offset, count, maxColorValue);
+        }
+    };
+
+    if (numChunks <= 1U) {
+        parse(pos, end, 0U, numValues);
+        return;
     }
 
-    // Debug code to verify that the parsed data matches the input file
-    // TODO: Remove in final release
-#if 0
-    std::cout << "P3\n";
-    std::cout << width << " " << height << "\n";
-    std::cout << maxColorValue << "\n";
-    std::uint64_t idx { 0U };
-    for (const std::uint8_t value : m_decodedData)
+    // Move every chunk boundary forward to the start of a token, the byte before pos is part of the header
+    std::vector<const std::uint8_t *> boundaries(numChunks + 1U);
+    boundaries[0U] = pos;
+    boundaries[numChunks] = end;
+    for (std::uint32_t chunkIdx { 1U }; chunkIdx < numChunks; ++chunkIdx)
     {
-        ++idx;
-        std::cout << static_cast<std::uint32_t>(value);
-        if (idx % 3U == 0U) {
-            std::cout << "\n";
-        } else {
-            std::cout << " ";
+        const std::uint8_t *boundary { std::max(boundaries[chunkIdx - 1U], pos + payloadSize * chunkIdx / numChunks) };
+        while ((boundary != end) && !isWhitespace(boundary[-1]))
+        {
+            ++boundary;
+        }
+        boundaries[chunkIdx] = boundary;
+    }
+
+    // First pass: count the values in every chunk
+    std::vector<std::size_t> offsets(numChunks + 1U, 0U);
+    m_threadPool->parallelFor(numChunks, [&](const std::uint32_t chunkIdx, const std::uint32_t)
+    {
+        offsets[chunkIdx + 1U] = countTokens(boundaries[chunkIdx], boundaries[chunkIdx + 1U]);
+    });
+
+    for (std::uint32_t chunkIdx { 0U }; chunkIdx < numChunks; ++chunkIdx)
+    {
+        offsets[chunkIdx + 1U] += offsets[chunkIdx];
+    }
+    if (offsets[numChunks] != numValues) {
+        throw std::invalid_argument("Input PPM file dimensions do not match the number of RGB values present");
+    }
+
+    // Second pass: parse every chunk into its slice of the output
+    m_threadPool->parallelFor(numChunks, [&](const std::uint32_t chunkIdx, const std::uint32_t)
+    {
+        parse(boundaries[chunkIdx], boundaries[chunkIdx + 1U], offsets[chunkIdx], offsets[chunkIdx + 1U] - offsets[chunkIdx]);
+    });
+}
+
+void Decoder::decodePpmSamples(const std::uint8_t *pos, const std::size_t sampleSize, const std::uint32_t maxColorValue)
+{
+    if ((sampleSize == 1U) && (maxColorValue == 255U) && (m_inputColorFormat == utils::ColorFormat::rgb888)) {
+        std::memcpy(m_decodedData.data(), pos, m_decodedData.size());
+        return;
+    }
+
+    // High bit depth samples are stored big endian in the file and native endian in m_decodedData
+    std::uint16_t *dst { reinterpret_cast<std::uint16_t *>(m_decodedData.data()) };
+    const std::size_t numValues { m_decodedData.size() / 2U };
+    if (maxColorValue == 65535U) {
+        // Full range samples need neither validation nor scaling
+        for (std::size_t idx { 0U }; idx < numValues; ++idx, pos += 2U)
+        {
+            dst[idx] = static_cast<std::uint16_t>((pos[0U] << 8U) | pos[1U]);
+        }
+        return;
+    }
+
+    for (std::size_t idx { 0U }; idx < numValues; ++idx, pos += sampleSize)
+    {
+        const std::uint32_t value { (sampleSize == 2U) ? ((static_cast<std::uint32_t>(pos[0U]) << 8U) | pos[1U]) :
+                                                         static_cast<std::uint32_t>(pos[0U]) };
+        if (value > maxColorValue) {
+            throw std::invalid_argument("Input PPM file contains an invalid RGB value");
         }
+        dst[idx] = scaleSample<std::uint16_t>(value, maxColorValue);
     }
-#endif
 }
 
-void Decoder::decodeRaw()
+void Decoder::decodeRaw(const std::uint8_t *data, const std::size_t size)
 {
-    // TODO
+    const std::size_t bytesPerPixel { getBytesPerPixel() };
+
+    if ((m_rawWidth == 0U) || (m_rawHeight == 0U)) {
+        throw std::invalid_argument("Width and height must be specified for raw input files");
+    }
+
+    if (size != static_cast<std::size_t>(m_rawWidth) * m_rawHeight * bytesPerPixel) {
+        throw std::invalid_argument("Input raw file size does not match the specified width, height and color format");
+    }
+
+    m_width = m_rawWidth;
+    m_height = m_rawHeight;
+    const std::size_t rowBytes { static_cast<std::size_t>(m_width) * bytesPerPixel };
+
+    if ((m_threadPool == nullptr) || !m_threadPool->isPinned()) {
+        m_decodedData.assign(data, data + size);
+        return;
+    }
+
+    m_decodedData.resize(size);
+    const std::uint32_t numBands { m_threadPool->getNumThreads() };
+    m_threadPool->parallelFor(numBands, [&](const std::uint32_t bandIdx, const std::uint32_t)
+    {
+        const auto band { ThreadPool::getBand(m_height, numBands, bandIdx, 2U) };
+        const std::size_t offset { band.first * rowBytes };
+        std::memcpy(m_decodedData.data() + offset, data + offset, (band.second - band.first) * rowBytes);
+    }, ThreadPool::Schedule::fixed);
+}
+
+void Decoder::allocateDecodedData(const std::size_t rowBytes)
+{
+    m_decodedData.resize(rowBytes * m_height);
+
+    if ((m_threadPool == nullptr) || !m_threadPool->isPinned()) {
+        return;
+    }
+
+    constexpr std::size_t pageSize { 4096U };
+    const std::uint32_t numBands { m_threadPool->getNumThreads() };
+    m_threadPool->parallelFor(numBands, [&](const std::uint32_t bandIdx, const std::uint32_t)
+    {
+        const auto band { ThreadPool::getBand(m_height, numBands, bandIdx, 2U) };
+        const std::size_t end { band.second * rowBytes };
+        for (std::size_t offset { band.first * rowBytes }; offset < end; offset += pageSize)
+        {
+            m_decodedData[offset] = 0U;
+        }
+    }, ThreadPool::Schedule::fixed);
 }
 
 bool Decoder::isSupported(utils::FileFormat fileFormat) noexcept
@@ -153,6 +491,7 @@ bool Decoder::isSupported(utils::ColorFormat colorFormat) noexcept
     {
         case(utils::ColorFormat::rgb888):
         case(utils::ColorFormat::rgba8888):
+        case(utils::ColorFormat::rgb161616):
             ret = true;
             break;
         default:
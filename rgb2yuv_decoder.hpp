@@ -21,8 +21,11 @@
 #pragma once
 
 #include <fstream>
+#include <utility>
 #include <vector>
 
+#include "rgb2yuv_frame_buffer.hpp"
+#include "rgb2yuv_thread_pool.hpp"
 #include "rgb2yuv_utils.hpp"
 
 namespace rgb2yuv
@@ -34,22 +37,107 @@ class Decoder
         const std::string m_inputFile; ///< Input file path
         const utils::FileFormat m_inputFileFormat; ///< Format of @ref Decoder::m_inputFile
         const utils::ColorFormat m_inputColorFormat; ///< Format of the color data in @ref Decoder::m_inputFile
-        std::vector<std::uint8_t> m_decodedData { }; ///< Container for the decoded color data in RGB888 form
+        const std::uint32_t m_rawWidth; ///< Width in pixels of a @ref utils::FileFormat::raw input file
+        const std::uint32_t m_rawHeight; ///< Height in pixels of a @ref utils::FileFormat::raw input file
+        std::vector<std::uint8_t> m_fileData { }; ///< Contents of @ref Decoder::m_inputFile
+        bool m_isFileRead { false }; ///< Specifies if @ref Decoder::m_fileData holds the contents of @ref Decoder::m_inputFile
+        std::size_t m_frameSize { 0U }; ///< Size in bytes of a frame of the sequence found by @ref Decoder::decodeSequence
+        FrameBuffer m_decodedData { }; ///< Container for the decoded color data in @ref Decoder::m_inputColorFormat
+        std::uint32_t m_width { 0U }; ///< Width of the decoded image in pixels
+        std::uint32_t m_height { 0U }; ///< Height of the decoded image in pixels
         std::fstream m_inputFileStream; ///< Input stream to @ref Decoder::m_inputFile
+        ThreadPool *m_threadPool; ///< Pool used to parse PPM files and first-touch @ref Decoder::m_decodedData, may be nullptr
+
+        ///
+        /// @brief Resizes @ref Decoder::m_decodedData to @ref Decoder::m_height rows of @p rowBytes bytes
+        ///
+        /// Design:
+        /// -# Resize @ref Decoder::m_decodedData without initializing its contents
+        /// -# If @ref Decoder::m_threadPool has pinned workers, write one byte per page of every band of
+        ///    @ref ThreadPool::getBand so that the pages are first-touched, and hence placed, on the NUMA
+        ///    node of the worker that will convert the band
+        ///
+        void allocateDecodedData(const std::size_t rowBytes);
+
+        ///
+        /// @brief Returns the number of bytes per pixel of @ref Decoder::m_inputColorFormat
+        ///
+        std::size_t getBytesPerPixel() const noexcept;
 
         ///
         /// @brief Extract color data from a PPM image file
         ///
-        /// Design: TODO
+        /// @param[in] data Contents of the PPM file
+        /// @param[in] size Size of @p data in bytes
+        ///
+        /// @throws std::invalid_argument if @p data is not a valid P3 or P6 PPM file with a maximum color value
+        ///         of 255 for @ref utils::ColorFormat::rgb888, or of at most 65535 for @ref utils::ColorFormat::rgb161616
+        ///
+        /// Design:
+        /// -# Verify the "P3" (ASCII) or "P6" (binary) magic followed by whitespace
+        /// -# Parse width, height and maximum color value, skipping whitespace and '#' comments
+        ///    -# Throw std::invalid_argument if a dimension is 0 or > 65536, or if the maximum color value is
+        ///       not supported by @ref Decoder::m_inputColorFormat
+        /// -# For P6, throw std::invalid_argument unless a single whitespace byte and exactly width * height * 3
+        ///    samples follow the header, then invoke @ref Decoder::decodePpmSamples
+        /// -# For P3, throw std::invalid_argument if @p data cannot hold width * height * 3 values, then invoke
+        ///    @ref Decoder::decodePpmValues on the data following the header
+        ///
+        void decodePpm(const std::uint8_t *data, const std::size_t size);
+
+        ///
+        /// @brief Copies the binary samples of a P6 PPM file into @ref Decoder::m_decodedData
+        ///
+        /// @param[in] pos Start of the samples
+        /// @param[in] sampleSize Size of a sample in bytes, 2 if the maximum color value is above 255
+        /// @param[in] maxColorValue Maximum color value of the file
+        ///
+        /// @throws std::invalid_argument if a sample is above @p maxColorValue
+        ///
+        /// Design:
+        /// -# Copy the samples as is for @ref utils::ColorFormat::rgb888
+        /// -# Byte swap the samples into native endian 16bit samples if @p maxColorValue is 65535
+        /// -# Else convert the big endian samples to native endian 16bit samples scaled from
+        ///    [0, @p maxColorValue] to [0, 65535]
+        ///
+        void decodePpmSamples(const std::uint8_t *pos, const std::size_t sampleSize, const std::uint32_t maxColorValue);
+
+        ///
+        /// @brief Parses the whitespace separated RGB values of a P3 PPM file into @ref Decoder::m_decodedData
+        ///
+        /// @param[in] pos Start of the values, must not be within a token
+        /// @param[in] end End of the file
+        /// @param[in] maxColorValue Maximum color value of the file. For @ref utils::ColorFormat::rgb161616 the
+        ///            values are scaled from [0, @p maxColorValue] to native endian 16bit samples in [0, 65535].
+        ///
+        /// @throws std::invalid_argument if a value is not a decimal number <= @p maxColorValue, or if the number
+        ///         of values does not match the size of @ref Decoder::m_decodedData
+        ///
+        /// Design:
+        /// -# Split [@p pos, @p end) into one chunk per worker of @ref Decoder::m_threadPool, at most one per
+        ///    @ref Decoder::ct_minChunkSize bytes. Parse on the calling thread if that yields a single chunk.
+        /// -# Move every chunk boundary forward to the start of the next token
+        /// -# First pass: count the tokens in every chunk in parallel
+        /// -# Prefix-sum the counts to the output offset of every chunk and verify the total
+        /// -# Second pass: parse every chunk in parallel directly into its slice of @ref Decoder::m_decodedData
         ///
-        void decodePpm();
+        void decodePpmValues(const std::uint8_t *pos, const std::uint8_t *end, const std::uint32_t maxColorValue);
 
         ///
         /// @brief Extract color data from a RAW image file
         ///
-        /// Design: TODO
+        /// @param[in] data Contents of the RAW file
+        /// @param[in] size Size of @p data in bytes
         ///
-        void decodeRaw();
+        /// @throws std::invalid_argument if @ref Decoder::m_rawWidth or @ref Decoder::m_rawHeight is 0,
+        ///         or if @p size does not match them
+        ///
+        /// Design:
+        /// -# Verify that @p size equals width * height * bytes per pixel of @ref Decoder::m_inputColorFormat
+        /// -# Copy @p data into @ref Decoder::m_decodedData. If @ref Decoder::m_threadPool has pinned workers,
+        ///    copy every band on the worker that will convert it.
+        ///
+        void decodeRaw(const std::uint8_t *data, const std::size_t size);
 
         ///
         /// @brief Check if the input file format is supported for decoding
@@ -71,12 +159,15 @@ class Decoder
         /// -# Return true for the following values of @p colorFormat:
         ///    -# @ref utils::ColorFormat::rgb888
         ///    -# @ref utils::ColorFormat::rgba8888
+        ///    -# @ref utils::ColorFormat::rgb161616
         /// -# Return false for any other values of @p colorFormat
         ///
         /// @returns @true if @p colorFormat is supported for decoding, else @false
         ///
         bool isSupported(utils::ColorFormat colorFormat) noexcept;
     public:
+        static constexpr std::size_t ct_minChunkSize { 1U << 20U }; ///< Minimum PPM payload size in bytes per parsing thread
+
         ///
         /// @brief Sole parameterized constructor
         ///
@@ -85,11 +176,18 @@ class Decoder
         ///    -# @p inputFile - @ref Decoder::m_inputFile
         ///    -# @p inputFileFormat - @ref Decoder::m_inputFileFormat
         ///    -# @p inputColorFormat - @ref Decoder::m_inputColorFormat
+        ///    -# @p rawWidth - @ref Decoder::m_rawWidth
+        ///    -# @p rawHeight - @ref Decoder::m_rawHeight
+        ///    -# @p threadPool - @ref Decoder::m_threadPool
         ///
         Decoder(const std::string &inputFile, const utils::FileFormat inputFileFormat,
-                const utils::ColorFormat inputColorFormat) : m_inputFile(inputFile),
-                                                             m_inputFileFormat(inputFileFormat),
-                                                             m_inputColorFormat(inputColorFormat)
+                const utils::ColorFormat inputColorFormat, const std::uint32_t rawWidth = 0U,
+                const std::uint32_t rawHeight = 0U, ThreadPool *threadPool = nullptr) : m_inputFile(inputFile),
+                                                                                       m_inputFileFormat(inputFileFormat),
+                                                                                       m_inputColorFormat(inputColorFormat),
+                                                                                       m_rawWidth(rawWidth),
+                                                                                       m_rawHeight(rawHeight),
+                                                                                       m_threadPool(threadPool)
         {
         }
 
@@ -103,13 +201,109 @@ class Decoder
         ///    -# Throw std::invalid_argument if @false is returned
         /// -# Invoke @ref Decoder::isSupported on @ref Decoder::m_inputColorFormat
         ///    -# Throw std::invalid_argument if @false is returned
-        /// -# Open a file stream to @ref Decoder::m_inputFile
+        /// -# Throw std::invalid_argument if @ref Decoder::m_inputFileFormat is @ref utils::FileFormat::ppm
+        ///    and @ref Decoder::m_inputColorFormat is not @ref utils::ColorFormat::rgb888 or
+        ///    @ref utils::ColorFormat::rgb161616
+        /// -# Unless @ref Decoder::setFileData provided the contents already, open a file stream to
+        ///    @ref Decoder::m_inputFile
         /// -# Check if the file is opened
         ///    -# Throw std::invalid_argument if check fails
         ///
         void init();
         void deinit();
-        std::vector<std::uint8_t> &decode();
+
+        ///
+        /// @brief Provides the contents of @ref Decoder::m_inputFile read ahead by the caller
+        ///
+        /// Design: Move @p fileData into @ref Decoder::m_fileData and mark it as read, so that @ref Decoder::init
+        ///         does not open the file and @ref Decoder::read returns @p fileData
+        ///
+        void setFileData(std::vector<std::uint8_t> &&fileData) noexcept
+        {
+            m_fileData = std::move(fileData);
+            m_isFileRead = true;
+        }
+
+        ///
+        /// @brief Reads the contents of @ref Decoder::m_inputFile
+        ///
+        /// @throws std::invalid_argument if the file cannot be read
+        ///
+        /// Design: Read the contents of @ref Decoder::m_inputFileStream into @ref Decoder::m_fileData,
+        ///         unless they have been read before
+        ///
+        /// @returns Reference to @ref Decoder::m_fileData
+        ///
+        const std::vector<std::uint8_t> &read();
+
+        ///
+        /// @brief Reads @ref Decoder::m_inputFile and extracts its color data
+        ///
+        /// @throws std::invalid_argument if the file cannot be read or is malformed
+        ///
+        /// Design:
+        /// -# Invoke @ref Decoder::read
+        /// -# Invoke @ref Decoder::decode(const std::uint8_t *, std::size_t) on @ref Decoder::m_fileData
+        ///
+        /// @returns Reference to @ref Decoder::m_decodedData
+        ///
+        FrameBuffer &decode();
+
+        ///
+        /// @brief Extracts color data from an in-memory copy of a file in @ref Decoder::m_inputFileFormat
+        ///
+        /// Note: Does not require @ref Decoder::init to have opened @ref Decoder::m_inputFile
+        ///
+        /// @param[in] data Contents of the file
+        /// @param[in] size Size of @p data in bytes
+        ///
+        /// @throws std::invalid_argument if @p data is malformed
+        ///
+        /// Design:
+        /// -# Invoke @ref Decoder::decodePpm or @ref Decoder::decodeRaw depending on @ref Decoder::m_inputFileFormat
+        ///
+        /// @returns Reference to @ref Decoder::m_decodedData
+        ///
+        FrameBuffer &decode(const std::uint8_t *data, const std::size_t size);
+
+        ///
+        /// @brief Reads a @ref utils::FileFormat::raw input file holding a sequence of frames
+        ///
+        /// @throws std::invalid_argument if @ref Decoder::m_inputFileFormat is not @ref utils::FileFormat::raw,
+        ///         if the raw dimensions are 0 or if the file size is not a multiple of the frame size
+        ///
+        /// Design:
+        /// -# Invoke @ref Decoder::read
+        /// -# Verify that the file holds a whole number of frames of @ref Decoder::m_rawWidth x
+        ///    @ref Decoder::m_rawHeight pixels in @ref Decoder::m_inputColorFormat
+        ///
+        /// @returns Number of frames in the sequence, access them with @ref Decoder::getFrame
+        ///
+        std::uint32_t decodeSequence();
+
+        ///
+        /// @brief Returns a pointer to the first pixel of frame @p frameIdx found by @ref Decoder::decodeSequence
+        ///
+        const std::uint8_t *getFrame(const std::uint32_t frameIdx) const noexcept
+        {
+            return m_fileData.data() + frameIdx * m_frameSize;
+        }
+
+        ///
+        /// @brief Returns the width in pixels of the image extracted by @ref Decoder::decode
+        ///
+        std::uint32_t getWidth() const noexcept
+        {
+            return m_width;
+        }
+
+        ///
+        /// @brief Returns the height in pixels of the image extracted by @ref Decoder::decode
+        ///
+        std::uint32_t getHeight() const noexcept
+        {
+            return m_height;
+        }
 };
 
 } // namespace rgb2yuv
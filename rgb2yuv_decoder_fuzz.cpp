@@ -0,0 +1,144 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Fuzz target for rgb2yuv::Decoder.
+//
+// The first input byte selects the decoder and, for raw input, the color format and dimensions;
+// the remaining bytes are the file contents. Built with RGB2YUV_LIBFUZZER (RGB2YUV_BUILD_FUZZERS=ON,
+// Clang) this is a libFuzzer target:
+//
+//     rgb2yuv_decoder_fuzz -max_len=4096 corpus/
+//
+// Otherwise a replay driver is built instead. It runs the target on the files given as arguments or,
+// without arguments, on randomly mutated seed inputs so that the target is exercised by ctest.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "rgb2yuv_decoder.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    using rgb2yuv::utils::ColorFormat;
+    using rgb2yuv::utils::FileFormat;
+
+    if (size < 1U) {
+        return 0;
+    }
+
+    const std::uint8_t selector { data[0U] };
+    const bool isRaw { (selector & 0x1U) != 0U };
+    const bool isWide { (selector & 0x2U) != 0U };
+    const ColorFormat colorFormat { !isWide ? ColorFormat::rgb888 :
+                                    (isRaw ? ColorFormat::rgba8888 : ColorFormat::rgb161616) };
+    const std::uint32_t rawWidth { (selector >> 2U) & 0x7U };
+    const std::uint32_t rawHeight { (selector >> 5U) & 0x7U };
+
+    rgb2yuv::Decoder decoder("", isRaw ? FileFormat::raw : FileFormat::ppm, colorFormat, rawWidth, rawHeight);
+    try
+    {
+        const rgb2yuv::FrameBuffer &decodedData { decoder.decode(data + 1U, size - 1U) };
+        const std::size_t bytesPerPixel { !isWide ? 3U : (isRaw ? 4U : 6U) };
+        if (decodedData.size() != static_cast<std::size_t>(decoder.getWidth()) * decoder.getHeight() * bytesPerPixel) {
+            std::abort();
+        }
+    }
+    catch (const std::invalid_argument &)
+    {
+        // Malformed input is expected to be rejected
+    }
+
+    return 0;
+}
+
+#ifndef RGB2YUV_LIBFUZZER
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    // Silence the "Decoding failed" diagnostics of rejected inputs
+    std::cerr.setstate(std::ios::failbit);
+
+    for (int idx { 1 }; idx < argc; ++idx)
+    {
+        std::ifstream file(argv[idx], std::ios::binary);
+        const std::vector<std::uint8_t> input { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    if (argc > 1) {
+        return 0;
+    }
+
+    const std::string seeds[] {
+        std::string(1U, '\0') + "P3\n2 2\n255\n0 0 0 255 255 255\n1 2 3 # not a comment\n4 5 6\n",
+        std::string(1U, '\0') + "P3 # comment\n1 1 255 7 8 9",
+        std::string(1U, '\x2') + "P3\n2 1\n65535\n0 1 65535 1023 512 7\n",
+        std::string(1U, '\x2') + "P3\n1 2 1023 1023 0 511 4 5 6",
+        std::string(1U, '\0') + "P6\n2 1\n255\n" + std::string(6U, 'z'),
+        std::string(1U, '\x2') + "P6\n1 1\n1023\n" + std::string("\x03\xff\x00\x00\x02\x00", 6U),
+        std::string(1U, static_cast<char>(0x1U | (2U << 2U) | (2U << 5U))) + std::string(12U, 'x'),
+        std::string(1U, static_cast<char>(0x3U | (1U << 2U) | (3U << 5U))) + std::string(12U, 'y'),
+    };
+    std::mt19937 rng(1U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+
+    for (const std::string &seed : seeds)
+    {
+        for (std::uint32_t iteration { 0U }; iteration < 20000U; ++iteration)
+        {
+            std::vector<std::uint8_t> input(seed.begin(), seed.end());
+            const std::uint32_t numMutations { 1U + byteDist(rng) % 4U };
+            for (std::uint32_t mutation { 0U }; mutation < numMutations; ++mutation)
+            {
+                const std::size_t pos { byteDist(rng) % (input.size() + 1U) };
+                switch (byteDist(rng) % 3U)
+                {
+                    case 0U:
+                        input.insert(input.begin() + pos, static_cast<std::uint8_t>(byteDist(rng)));
+                        break;
+                    case 1U:
+                        if (pos < input.size()) {
+                            input.erase(input.begin() + pos);
+                        }
+                        break;
+                    default:
+                        if (pos < input.size()) {
+                            input[pos] = static_cast<std::uint8_t>(byteDist(rng));
+                        }
+                        break;
+                }
+            }
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+    }
+
+    return 0;
+}
+
+#endif
@@ -18,4 +18,159 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-// TODO
+#include "rgb2yuv_encoder.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+namespace rgb2yuv
+{
+
+void Encoder::init()
+{
+    if (!isSupported(m_outputFileFormat)) {
+        throw std::invalid_argument("Output file format not supported for encoding!");
+    }
+
+    // Never truncate an existing file in place, it may share its data with a file elsewhere (e.g. a hardlink)
+    std::error_code error { };
+    std::filesystem::remove(m_outputFile, error);
+
+    m_outputFileStream = std::fstream(m_outputFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_outputFileStream.is_open()) {
+        throw std::invalid_argument("Failed to create output file");
+    }
+}
+
+void Encoder::deinit()
+{
+    if (m_outputFileStream.is_open()) {
+        m_outputFileStream.close();
+    }
+}
+
+void Encoder::encode(const FrameBuffer &data, const std::uint32_t width, const std::uint32_t height)
+{
+    try
+    {
+        write(m_outputFileStream, data, width, height);
+    }
+    catch(...)
+    {
+        std::cerr << "Encoding failed\n";
+        throw;
+    }
+}
+
+void Encoder::encodeLevels(const std::vector<FrameBuffer> &levels, const std::uint32_t width,
+                           const std::uint32_t height)
+{
+    try
+    {
+        for (std::uint32_t level { 1U }; level <= levels.size(); ++level)
+        {
+            std::ofstream stream(getLevelFileName(m_outputFile, level), std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!stream.is_open()) {
+                throw std::runtime_error("Failed to create output file of pyramid level");
+            }
+            write(stream, levels[level - 1U], width >> level, height >> level);
+        }
+    }
+    catch(...)
+    {
+        std::cerr << "Encoding failed\n";
+        throw;
+    }
+}
+
+std::string Encoder::getLevelFileName(const std::string &outputFile, const std::uint32_t level)
+{
+    const std::filesystem::path path { outputFile };
+    std::filesystem::path ret { path.parent_path() };
+    ret /= path.stem().string() + "_L" + std::to_string(level) + path.extension().string();
+    return ret.string();
+}
+
+void Encoder::write(std::ostream &stream, const FrameBuffer &data, const std::uint32_t width,
+                    const std::uint32_t height)
+{
+    switch (m_outputFileFormat)
+    {
+        case(utils::FileFormat::c_header):
+            encodeCHeader(stream, data, width, height);
+            break;
+        case(utils::FileFormat::raw):
+            encodeRaw(stream, data);
+            break;
+        default:
+            // Unreachable. Do nothing
+            break;
+    }
+
+    stream.flush();
+    if (!stream) {
+        throw std::runtime_error("Failed to write output file");
+    }
+}
+
+void Encoder::encodeRaw(std::ostream &stream, const FrameBuffer &data)
+{
+    stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void Encoder::encodeCHeader(std::ostream &stream, const FrameBuffer &data, const std::uint32_t width,
+                            const std::uint32_t height)
+{
+    constexpr std::size_t valuesPerLine { 16U };
+    constexpr char hexDigits[] { "0123456789abcdef" };
+
+    stream << "// Generated by rgb2yuv\n\n";
+    stream << "#pragma once\n\n";
+    stream << "#include <stdint.h>\n\n";
+    stream << "#define RGB2YUV_IMAGE_WIDTH " << width << "U\n";
+    stream << "#define RGB2YUV_IMAGE_HEIGHT " << height << "U\n";
+    stream << "#define RGB2YUV_IMAGE_COLOR_FORMAT " << static_cast<std::uint32_t>(m_outputColorFormat) << "U\n";
+    stream << "#define RGB2YUV_IMAGE_SIZE " << data.size() << "U\n\n";
+    stream << "static const uint8_t rgb2yuv_image[RGB2YUV_IMAGE_SIZE] = {\n";
+
+    // Format each line in a local buffer, streaming value by value is an order of magnitude slower
+    std::string line { };
+    for (std::size_t idx { 0U }; idx < data.size(); ++idx)
+    {
+        if ((idx % valuesPerLine) == 0U) {
+            line.assign("   ");
+        }
+        line += " 0x";
+        line += hexDigits[data[idx] >> 4U];
+        line += hexDigits[data[idx] & 0xFU];
+        line += ',';
+        if (((idx % valuesPerLine) == valuesPerLine - 1U) || (idx == data.size() - 1U)) {
+            line += '\n';
+            stream << line;
+        }
+    }
+
+    stream << "};\n";
+}
+
+bool Encoder::isSupported(utils::FileFormat fileFormat) noexcept
+{
+    bool ret { false };
+
+    switch(fileFormat)
+    {
+        case(utils::FileFormat::c_header):
+        case(utils::FileFormat::raw):
+            ret = true;
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+} // namespace rgb2yuv
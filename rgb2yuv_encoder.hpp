@@ -20,12 +20,136 @@
 
 #pragma once
 
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "rgb2yuv_frame_buffer.hpp"
+#include "rgb2yuv_utils.hpp"
+
 namespace rgb2yuv
 {
 
 class Encoder
 {
-    // TODO
+    private:
+        const std::string m_outputFile; ///< Output file path
+        const utils::FileFormat m_outputFileFormat; ///< Format of @ref Encoder::m_outputFile
+        const utils::ColorFormat m_outputColorFormat; ///< Format of the color data written to @ref Encoder::m_outputFile
+        std::fstream m_outputFileStream; ///< Output stream to @ref Encoder::m_outputFile
+
+        ///
+        /// @brief Write color data to @p stream in @ref Encoder::m_outputFileFormat
+        ///
+        /// @throws std::runtime_error if writing to @p stream fails
+        ///
+        /// Design:
+        /// -# Invoke @ref Encoder::encodeRaw or @ref Encoder::encodeCHeader depending on @ref Encoder::m_outputFileFormat
+        /// -# Flush @p stream and throw std::runtime_error if it is in a failed state
+        ///
+        void write(std::ostream &stream, const FrameBuffer &data, const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Write color data as raw bytes
+        ///
+        /// Design: Write @p data to @p stream as is
+        ///
+        void encodeRaw(std::ostream &stream, const FrameBuffer &data);
+
+        ///
+        /// @brief Write color data as a C header
+        ///
+        /// Design:
+        /// -# Write the image dimensions and color format as preprocessor definitions
+        /// -# Write @p data as a hexadecimal uint8_t array, 16 values per line
+        ///
+        void encodeCHeader(std::ostream &stream, const FrameBuffer &data, const std::uint32_t width,
+                           const std::uint32_t height);
+
+        ///
+        /// @brief Check if the output file format is supported for encoding
+        ///
+        /// Design:
+        /// -# Return true for the following values of @p fileFormat:
+        ///    -# @ref utils::FileFormat::c_header
+        ///    -# @ref utils::FileFormat::raw
+        /// -# Return false for any other values of @p fileFormat
+        ///
+        /// @returns @true if @p fileFormat is supported for encoding, else @false
+        ///
+        bool isSupported(utils::FileFormat fileFormat) noexcept;
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// Design:
+        /// -# Assign the input parameters as below:
+        ///    -# @p outputFile - @ref Encoder::m_outputFile
+        ///    -# @p outputFileFormat - @ref Encoder::m_outputFileFormat
+        ///    -# @p outputColorFormat - @ref Encoder::m_outputColorFormat
+        ///
+        Encoder(const std::string &outputFile, const utils::FileFormat outputFileFormat,
+                const utils::ColorFormat outputColorFormat) : m_outputFile(outputFile),
+                                                              m_outputFileFormat(outputFileFormat),
+                                                              m_outputColorFormat(outputColorFormat)
+        {
+        }
+
+        ///
+        /// @brief Performs initialization steps of @ref Encoder that may fail
+        ///
+        /// @throws std::invalid_argument if @ref Encoder::m_outputFileFormat is not supported by @ref Encoder
+        ///         or if @ref Encoder::m_outputFile cannot be created
+        ///
+        /// Design:
+        /// -# Invoke @ref Encoder::isSupported on @ref Encoder::m_outputFileFormat
+        ///    -# Throw std::invalid_argument if @false is returned
+        /// -# Remove @ref Encoder::m_outputFile if it exists, so that a file sharing its data (e.g. a hardlink)
+        ///    is never overwritten
+        /// -# Open a binary file stream to @ref Encoder::m_outputFile
+        /// -# Check if the file is opened
+        ///    -# Throw std::invalid_argument if check fails
+        ///
+        void init();
+
+        ///
+        /// @brief Flushes and closes @ref Encoder::m_outputFileStream
+        ///
+        void deinit();
+
+        ///
+        /// @brief Writes the converted color data to @ref Encoder::m_outputFile
+        ///
+        /// @param[in] data Converted color data in @ref Encoder::m_outputColorFormat
+        /// @param[in] width Width of the image in pixels
+        /// @param[in] height Height of the image in pixels
+        ///
+        /// @throws std::runtime_error if writing to @ref Encoder::m_outputFile fails
+        ///
+        void encode(const FrameBuffer &data, const std::uint32_t width, const std::uint32_t height);
+
+        ///
+        /// @brief Writes further levels of an image pyramid, each to its own file next to @ref Encoder::m_outputFile
+        ///
+        /// @param[in] levels Converted color data of levels 1, 2, ... in @ref Encoder::m_outputColorFormat
+        /// @param[in] width Width of level 0 in pixels, every level halves it
+        /// @param[in] height Height of level 0 in pixels, every level halves it
+        ///
+        /// @throws std::runtime_error if a level file cannot be created or written
+        ///
+        /// Design: Write level k to @ref Encoder::getLevelFileName with @ref Encoder::write
+        ///
+        void encodeLevels(const std::vector<FrameBuffer> &levels, const std::uint32_t width,
+                          const std::uint32_t height);
+
+        ///
+        /// @brief Returns the name of the file holding pyramid level @p level of @p outputFile
+        ///
+        /// Design: Insert "_L<level>" in front of the extension of @p outputFile, e.g. out.yuv -> out_L1.yuv
+        ///
+        static std::string getLevelFileName(const std::string &outputFile, const std::uint32_t level);
 };
 
 } // namespace rgb2yuv
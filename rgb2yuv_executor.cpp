@@ -0,0 +1,92 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_executor.hpp"
+
+#include <utility>
+
+namespace rgb2yuv
+{
+
+Executor::Executor(const std::uint32_t numThreads) : m_numThreads(numThreads > 0U ? numThreads : 1U)
+{
+    for (std::uint32_t workerIdx { 0U }; workerIdx < m_numThreads; ++workerIdx)
+    {
+        m_threads.emplace_back(&Executor::workerLoop, this, workerIdx);
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_condition.notify_all();
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void Executor::post(Task task, const Priority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (priority == Priority::continuation) {
+            m_continuationTasks.push_back(std::move(task));
+        } else {
+            m_startTasks.push_back(std::move(task));
+        }
+    }
+    m_condition.notify_one();
+}
+
+void Executor::workerLoop(const std::uint32_t workerIdx)
+{
+    for (;;)
+    {
+        Task task { };
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&]
+            {
+                return m_shutdown || !m_continuationTasks.empty() || !m_startTasks.empty();
+            });
+            std::deque<Task> &queue { !m_continuationTasks.empty() ? m_continuationTasks : m_startTasks };
+            if (queue.empty()) {
+                return;
+            }
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        try
+        {
+            task(workerIdx);
+        }
+        catch (...)
+        {
+            // Tasks report their own errors
+        }
+    }
+}
+
+} // namespace rgb2yuv
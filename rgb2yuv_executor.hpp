@@ -0,0 +1,118 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rgb2yuv
+{
+
+///
+/// @brief Fixed set of workers executing independent tasks posted from any thread
+///
+/// Unlike @ref ThreadPool, which runs one fork-join job at a time on behalf of a waiting caller, tasks
+/// posted to an @ref Executor are fire-and-forget, so that the stages of many conversions can share
+/// the same workers without a thread blocking per conversion.
+///
+class Executor
+{
+    public:
+        ///
+        /// @brief Signature of a task executed by @ref Executor
+        ///
+        /// @param[in] workerIdx Index of the worker executing the task in [0, @ref Executor::getNumThreads)
+        ///
+        /// Tasks must report their errors themselves, exceptions escaping a task are discarded.
+        ///
+        using Task = std::function<void(const std::uint32_t workerIdx)>;
+
+        ///
+        /// @brief Order in which posted tasks are executed
+        ///
+        enum class Priority : std::uint32_t
+        {
+            start = 0U, ///< First task of a new unit of work, executed in FIFO order
+            continuation ///< Further task of a unit of work already started, executed before any @ref Priority::start task
+        };
+
+    private:
+        const std::uint32_t m_numThreads; ///< Number of workers
+        std::vector<std::thread> m_threads { }; ///< Workers
+        std::mutex m_mutex { }; ///< Protects the queues below
+        std::condition_variable m_condition { }; ///< Signalled when a task is posted or on shutdown
+        std::deque<Task> m_startTasks { }; ///< Queued @ref Priority::start tasks
+        std::deque<Task> m_continuationTasks { }; ///< Queued @ref Priority::continuation tasks
+        bool m_shutdown { false }; ///< Set by the destructor to stop the workers once the queues are empty
+
+        ///
+        /// @brief Main loop of a worker
+        ///
+        /// Design: Pop the next task, @ref Executor::m_continuationTasks first, and execute it until
+        ///         @ref Executor::m_shutdown is set and both queues are empty
+        ///
+        void workerLoop(const std::uint32_t workerIdx);
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// @param[in] numThreads Number of workers, clamped to at least 1
+        ///
+        /// Design: Spawn @p numThreads workers
+        ///
+        explicit Executor(const std::uint32_t numThreads);
+
+        ///
+        /// @brief Sole destructor
+        ///
+        /// Design: Signal shutdown and join all workers once every queued task has been executed
+        ///
+        ~Executor();
+
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        ///
+        /// @brief Queues @p task for execution on one of the workers
+        ///
+        /// @param[in] task Task to execute
+        /// @param[in] priority Queue of the task. Preferring continuations finishes units of work already
+        ///            started before new ones are started, which bounds the number of units in flight (and
+        ///            the memory they hold) by the number of workers rather than by the number posted.
+        ///
+        void post(Task task, const Priority priority = Priority::start);
+
+        ///
+        /// @brief Returns the number of workers
+        ///
+        std::uint32_t getNumThreads() const noexcept
+        {
+            return m_numThreads;
+        }
+};
+
+} // namespace rgb2yuv
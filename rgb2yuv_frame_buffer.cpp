@@ -0,0 +1,139 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_frame_buffer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+std::atomic<bool> g_hugePages { false };
+std::atomic<bool> g_prefault { false };
+
+constexpr std::size_t ct_alignment { FrameAllocator<std::uint8_t>::ct_alignment };
+
+inline std::size_t getMappingSize(const std::size_t size) noexcept
+{
+    return (size + ct_hugePageSize - 1U) & ~(ct_hugePageSize - 1U);
+}
+
+#ifdef __linux__
+// Maps regular pages aligned to a huge page, so that the kernel can back them with transparent huge pages
+void *mapAligned(const std::size_t mappingSize, const int flags) noexcept
+{
+    void *mapping { mmap(nullptr, mappingSize + ct_hugePageSize, PROT_READ | PROT_WRITE, flags, -1, 0) };
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    const std::uintptr_t address { reinterpret_cast<std::uintptr_t>(mapping) };
+    const std::uintptr_t alignedAddress { (address + ct_hugePageSize - 1U) & ~(ct_hugePageSize - 1U) };
+    const std::size_t head { alignedAddress - address };
+    if (head != 0U) {
+        munmap(mapping, head);
+    }
+    munmap(reinterpret_cast<void *>(alignedAddress + mappingSize), ct_hugePageSize - head);
+
+    return reinterpret_cast<void *>(alignedAddress);
+}
+#endif
+
+} // namespace
+
+void setFramePageConfig(const FramePageConfig &config) noexcept
+{
+    g_hugePages = config.hugePages;
+    g_prefault = config.prefault;
+}
+
+void *allocateFrameMemory(const std::size_t size)
+{
+#ifdef __linux__
+    if (size >= ct_hugePageSize) {
+        const std::size_t mappingSize { getMappingSize(size) };
+        const int flags { MAP_PRIVATE | MAP_ANONYMOUS | (g_prefault ? MAP_POPULATE : 0) };
+        void *ret { nullptr };
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        if (g_hugePages) {
+            // Only succeeds if huge pages are reserved in /proc/sys/vm/nr_hugepages
+            ret = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+            ret = (ret == MAP_FAILED) ? nullptr : ret;
+        }
+#endif
+
+        if (ret == nullptr) {
+            // Transparent huge pages must be advised before the pages are populated
+            ret = mapAligned(mappingSize, flags & ~MAP_POPULATE);
+            if (ret == nullptr) {
+                throw std::bad_alloc();
+            }
+            if (g_hugePages) {
+                // Best effort, without transparent huge pages the mapping keeps regular pages
+                static_cast<void>(madvise(ret, mappingSize, MADV_HUGEPAGE));
+            }
+            if (g_prefault) {
+#ifdef MADV_POPULATE_WRITE
+                const bool populated { madvise(ret, mappingSize, MADV_POPULATE_WRITE) == 0 };
+#else
+                // Headers before glibc 2.35 do not define MADV_POPULATE_WRITE
+                const bool populated { false };
+#endif
+                if (!populated) {
+                    // Kernels before 5.14 lack MADV_POPULATE_WRITE, fault in every page by hand
+                    constexpr std::size_t pageSize { 4096U };
+                    for (std::size_t offset { 0U }; offset < mappingSize; offset += pageSize)
+                    {
+                        static_cast<volatile std::uint8_t *>(ret)[offset] = 0U;
+                    }
+                }
+            }
+        }
+
+        return ret;
+    }
+#endif
+
+    return ::operator new(size, std::align_val_t { ct_alignment });
+}
+
+void deallocateFrameMemory(void *pointer, const std::size_t size) noexcept
+{
+#ifdef __linux__
+    if (size >= ct_hugePageSize) {
+        munmap(pointer, getMappingSize(size));
+        return;
+    }
+#endif
+
+    ::operator delete(pointer, std::align_val_t { ct_alignment });
+}
+
+} // namespace rgb2yuv
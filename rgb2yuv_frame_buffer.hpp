@@ -0,0 +1,135 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace rgb2yuv
+{
+
+///
+/// @brief Page backing of the frame allocations made by @ref allocateFrameMemory
+///
+struct FramePageConfig
+{
+    bool hugePages; ///< Back large allocations with 2 MiB pages if available
+    bool prefault; ///< Fault in the pages of large allocations when they are made, rather than on first write
+};
+
+constexpr std::size_t ct_hugePageSize { 2U << 20U }; ///< Size of a huge page, allocations from this size on are mapped directly
+
+///
+/// @brief Sets the @ref FramePageConfig used by later frame allocations
+///
+void setFramePageConfig(const FramePageConfig &config) noexcept;
+
+///
+/// @brief Allocates @p size bytes of frame memory, aligned to at least 64 bytes
+///
+/// @throws std::bad_alloc if no memory is available
+///
+/// Design:
+/// -# Allocate with aligned operator new if @p size is below @ref ct_hugePageSize
+/// -# Else map anonymous memory, rounded up to a multiple of @ref ct_hugePageSize:
+///    -# If @ref FramePageConfig::hugePages is set and the headers define MAP_HUGETLB, first try a MAP_HUGETLB
+///       mapping of reserved huge pages. Else, or if none are reserved, map regular pages aligned to
+///       @ref ct_hugePageSize and madvise(MADV_HUGEPAGE) them so that transparent huge pages are used where enabled.
+///    -# If @ref FramePageConfig::prefault is set, add MAP_POPULATE to the MAP_HUGETLB mapping, or populate the
+///       regular mapping with madvise(MADV_POPULATE_WRITE). Touch every page instead if the headers or the
+///       kernel lack MADV_POPULATE_WRITE
+///
+void *allocateFrameMemory(const std::size_t size);
+
+///
+/// @brief Releases @p size bytes of frame memory at @p pointer allocated by @ref allocateFrameMemory
+///
+void deallocateFrameMemory(void *pointer, const std::size_t size) noexcept;
+
+///
+/// @brief Allocator for image data that leaves newly allocated elements uninitialized
+///
+/// std::allocator value-initializes (zero fills) elements on resize, which first-touches every page
+/// on the resizing thread. Leaving them uninitialized lets the worker that later writes a band of the
+/// image fault in its pages, so they are placed on that worker's NUMA node. Memory comes from
+/// @ref allocateFrameMemory, so that large frames may be backed by huge pages.
+///
+template<typename T>
+class FrameAllocator
+{
+    public:
+        using value_type = T;
+        static constexpr std::size_t ct_alignment { 64U }; ///< Alignment of allocations (cache line)
+
+        FrameAllocator() noexcept = default;
+
+        template<typename U>
+        FrameAllocator(const FrameAllocator<U> &) noexcept
+        {
+        }
+
+        T *allocate(const std::size_t count)
+        {
+            return static_cast<T *>(allocateFrameMemory(count * sizeof(T)));
+        }
+
+        void deallocate(T *pointer, const std::size_t count) noexcept
+        {
+            deallocateFrameMemory(pointer, count * sizeof(T));
+        }
+
+        ///
+        /// @brief Default-initializes the element at @p pointer (no zero fill for trivial types)
+        ///
+        template<typename U>
+        void construct(U *pointer) noexcept
+        {
+            ::new (static_cast<void *>(pointer)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U *pointer, Args &&...args)
+        {
+            ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        bool operator==(const FrameAllocator<U> &) const noexcept
+        {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const FrameAllocator<U> &) const noexcept
+        {
+            return false;
+        }
+};
+
+///
+/// @brief Container for decoded and converted image data
+///
+using FrameBuffer = std::vector<std::uint8_t, FrameAllocator<std::uint8_t>>;
+
+} // namespace rgb2yuv
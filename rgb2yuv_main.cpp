@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "rgb2yuv.hpp"
+#include "rgb2yuv_batch.hpp"
+#include "rgb2yuv_utils.hpp"
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const rgb2yuv::utils::InputArguments args { rgb2yuv::utils::InputParser::parseAndVerifyArgs(argc, argv) };
+        if (!args.batch.empty()) {
+            rgb2yuv::Batch batch(args);
+            batch.init();
+            const std::uint32_t numFailed { batch.run() };
+            batch.deinit();
+            if (numFailed != 0U) {
+                std::cerr << "rgb2yuv: " << numFailed << " batch input(s) failed" << std::endl;
+                return -1;
+            }
+        } else {
+            rgb2yuv::Context context(args);
+            context.init();
+            context.run();
+            context.deinit();
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "rgb2yuv: FATAL EXCEPTION: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
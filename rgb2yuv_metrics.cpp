@@ -0,0 +1,228 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_metrics.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+///
+/// @brief Formats @p ns nanoseconds as seconds
+///
+std::string toSeconds(const std::uint64_t ns)
+{
+    char buffer[32] { };
+    std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(ns) * 1e-9);
+    return buffer;
+}
+
+} // namespace
+
+///
+/// @brief Claims counters for its thread on construction and releases them when the thread exits
+///
+struct Metrics::ThreadSlot
+{
+    ThreadCounters *counters { nullptr }; ///< Counters of the thread
+
+    ThreadSlot() noexcept
+    {
+        Metrics &metrics { getInstance() };
+        try
+        {
+            std::lock_guard<std::mutex> lock(metrics.m_mutex);
+            if (metrics.m_freeCounters.empty()) {
+                counters = &metrics.m_counters.emplace_back();
+                metrics.m_freeCounters.reserve(metrics.m_counters.size());
+            } else {
+                counters = metrics.m_freeCounters.back();
+                metrics.m_freeCounters.pop_back();
+            }
+        }
+        catch (const std::bad_alloc &)
+        {
+            counters = &metrics.m_fallbackCounters;
+        }
+    }
+
+    ~ThreadSlot()
+    {
+        Metrics &metrics { getInstance() };
+        if (counters != &metrics.m_fallbackCounters) {
+            std::lock_guard<std::mutex> lock(metrics.m_mutex);
+            // Capacity is reserved for every counter of m_counters, so this cannot throw
+            metrics.m_freeCounters.push_back(counters);
+        }
+    }
+};
+
+Metrics::ScopedStage::~ScopedStage()
+{
+    const auto elapsed { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime) };
+    recordLatency(m_stage, static_cast<std::uint64_t>(elapsed.count()));
+}
+
+Metrics &Metrics::getInstance() noexcept
+{
+    static Metrics instance { };
+    return instance;
+}
+
+Metrics::ThreadCounters &Metrics::getThreadCounters() noexcept
+{
+    thread_local ThreadSlot slot { };
+    return *slot.counters;
+}
+
+void Metrics::recordFrame(const utils::SimdTier simdTier, const std::uint64_t pixels) noexcept
+{
+    ThreadCounters &counters { getThreadCounters() };
+    add(counters.frames[static_cast<std::uint32_t>(simdTier)], 1U);
+    add(counters.pixels[static_cast<std::uint32_t>(simdTier)], pixels);
+}
+
+void Metrics::recordBytes(const Stage stage, const std::uint64_t bytes) noexcept
+{
+    add(getThreadCounters().bytes[static_cast<std::uint32_t>(stage)], bytes);
+}
+
+void Metrics::recordLatency(const Stage stage, const std::uint64_t latencyNs) noexcept
+{
+    std::uint32_t bucketIdx { 0U };
+    while ((bucketIdx < ct_numLatencyBuckets) && (latencyNs > (ct_firstBucketNs << bucketIdx)))
+    {
+        ++bucketIdx;
+    }
+
+    ThreadCounters &counters { getThreadCounters() };
+    add(counters.latencyCounts[static_cast<std::uint32_t>(stage)][bucketIdx], 1U);
+    add(counters.latencySumNs[static_cast<std::uint32_t>(stage)], latencyNs);
+}
+
+std::string Metrics::format() const
+{
+    std::array<std::uint64_t, ct_numSimdTiers> frames { };
+    std::array<std::uint64_t, ct_numSimdTiers> pixels { };
+    std::array<std::uint64_t, Stats::ct_numStages> bytes { };
+    std::array<std::array<std::uint64_t, ct_numLatencyBuckets + 1U>, Stats::ct_numStages> latencyCounts { };
+    std::array<std::uint64_t, Stats::ct_numStages> latencySumNs { };
+    const auto accumulate { [&](const ThreadCounters &counters)
+    {
+        for (std::uint32_t tierIdx { 0U }; tierIdx < ct_numSimdTiers; ++tierIdx)
+        {
+            frames[tierIdx] += counters.frames[tierIdx].load(std::memory_order_relaxed);
+            pixels[tierIdx] += counters.pixels[tierIdx].load(std::memory_order_relaxed);
+        }
+
+        for (std::uint32_t stageIdx { 0U }; stageIdx < Stats::ct_numStages; ++stageIdx)
+        {
+            bytes[stageIdx] += counters.bytes[stageIdx].load(std::memory_order_relaxed);
+            latencySumNs[stageIdx] += counters.latencySumNs[stageIdx].load(std::memory_order_relaxed);
+            for (std::uint32_t bucketIdx { 0U }; bucketIdx <= ct_numLatencyBuckets; ++bucketIdx)
+            {
+                latencyCounts[stageIdx][bucketIdx] += counters.latencyCounts[stageIdx][bucketIdx].load(std::memory_order_relaxed);
+            }
+        }
+    } };
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const ThreadCounters &counters : m_counters)
+        {
+            accumulate(counters);
+        }
+    }
+    accumulate(m_fallbackCounters);
+
+    std::string out { };
+    out += "# HELP rgb2yuv_frames_total Frames converted, by SIMD tier.\n";
+    out += "# TYPE rgb2yuv_frames_total counter\n";
+    for (std::uint32_t tierIdx { 0U }; tierIdx < ct_numSimdTiers; ++tierIdx)
+    {
+        out += std::string("rgb2yuv_frames_total{simd=\"") + utils::toString(static_cast<utils::SimdTier>(tierIdx)) +
+               "\"} " + std::to_string(frames[tierIdx]) + "\n";
+    }
+
+    out += "# HELP rgb2yuv_pixels_total Pixels converted, by SIMD tier.\n";
+    out += "# TYPE rgb2yuv_pixels_total counter\n";
+    for (std::uint32_t tierIdx { 0U }; tierIdx < ct_numSimdTiers; ++tierIdx)
+    {
+        out += std::string("rgb2yuv_pixels_total{simd=\"") + utils::toString(static_cast<utils::SimdTier>(tierIdx)) +
+               "\"} " + std::to_string(pixels[tierIdx]) + "\n";
+    }
+
+    out += "# HELP rgb2yuv_stage_bytes_total Bytes processed, by pipeline stage.\n";
+    out += "# TYPE rgb2yuv_stage_bytes_total counter\n";
+    for (std::uint32_t stageIdx { 0U }; stageIdx < Stats::ct_numStages; ++stageIdx)
+    {
+        out += std::string("rgb2yuv_stage_bytes_total{stage=\"") + toString(static_cast<Stage>(stageIdx)) + "\"} " +
+               std::to_string(bytes[stageIdx]) + "\n";
+    }
+
+    out += "# HELP rgb2yuv_stage_latency_seconds Latency of pipeline stages.\n";
+    out += "# TYPE rgb2yuv_stage_latency_seconds histogram\n";
+    for (std::uint32_t stageIdx { 0U }; stageIdx < Stats::ct_numStages; ++stageIdx)
+    {
+        const std::string stage { toString(static_cast<Stage>(stageIdx)) };
+        std::uint64_t count { 0U };
+        for (std::uint32_t bucketIdx { 0U }; bucketIdx <= ct_numLatencyBuckets; ++bucketIdx)
+        {
+            count += latencyCounts[stageIdx][bucketIdx];
+            const std::string upperBound { (bucketIdx < ct_numLatencyBuckets) ?
+                                           toSeconds(ct_firstBucketNs << bucketIdx) : std::string("+Inf") };
+            out += "rgb2yuv_stage_latency_seconds_bucket{stage=\"" + stage + "\",le=\"" + upperBound + "\"} " +
+                   std::to_string(count) + "\n";
+        }
+        out += "rgb2yuv_stage_latency_seconds_sum{stage=\"" + stage + "\"} " + toSeconds(latencySumNs[stageIdx]) + "\n";
+        out += "rgb2yuv_stage_latency_seconds_count{stage=\"" + stage + "\"} " + std::to_string(count) + "\n";
+    }
+
+    return out;
+}
+
+void Metrics::dump(const std::string &metricsFile) const
+{
+    const std::string temporaryFile { metricsFile + ".tmp" };
+    {
+        std::ofstream stream(temporaryFile, std::ios::out | std::ios::trunc);
+        stream << format();
+        stream.flush();
+        if (!stream) {
+            throw std::runtime_error("Failed to write metrics file");
+        }
+    }
+
+    std::error_code error { };
+    std::filesystem::rename(temporaryFile, metricsFile, error);
+    if (error) {
+        throw std::runtime_error("Failed to write metrics file");
+    }
+}
+
+} // namespace rgb2yuv
@@ -0,0 +1,174 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rgb2yuv_stats.hpp"
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+///
+/// @brief Process wide conversion metrics, exported in the Prometheus text exposition format
+///
+/// Every thread records into its own cache line padded @ref Metrics::ThreadCounters, with relaxed loads
+/// and stores and without read-modify-write instructions or locks. Only the first record of a thread takes
+/// a lock, to claim its counters, and @ref Metrics::format sums the counters of all threads. A daemon serves
+/// @ref Metrics::format from its own endpoint; rgb2yuv writes it to a file with @ref Metrics::dump.
+///
+class Metrics
+{
+    public:
+        static constexpr std::uint32_t ct_numSimdTiers { static_cast<std::uint32_t>(utils::SimdTier::last) + 1U }; ///< Number of @ref utils::SimdTier values
+        static constexpr std::uint32_t ct_numLatencyBuckets { 16U }; ///< Number of finite latency histogram buckets
+        static constexpr std::uint64_t ct_firstBucketNs { 100000U }; ///< Upper bound of the first latency bucket, doubled by every further one
+
+        ///
+        /// @brief Counters of a single thread, padded to a cache line to avoid false sharing
+        ///
+        struct alignas(64) ThreadCounters
+        {
+            std::array<std::atomic<std::uint64_t>, ct_numSimdTiers> frames { }; ///< Frames converted per SIMD tier
+            std::array<std::atomic<std::uint64_t>, ct_numSimdTiers> pixels { }; ///< Pixels converted per SIMD tier
+            std::array<std::atomic<std::uint64_t>, Stats::ct_numStages> bytes { }; ///< Bytes processed per stage
+            std::array<std::array<std::atomic<std::uint64_t>, ct_numLatencyBuckets + 1U>,
+                       Stats::ct_numStages> latencyCounts { }; ///< Latencies per stage and bucket, the last one unbounded
+            std::array<std::atomic<std::uint64_t>, Stats::ct_numStages> latencySumNs { }; ///< Sum of the latencies per stage
+        };
+
+        ///
+        /// @brief RAII helper recording the latency of a @ref Stage into @ref Metrics
+        ///
+        class ScopedStage
+        {
+            private:
+                const Stage m_stage; ///< Stage being timed
+                const std::chrono::steady_clock::time_point m_startTime; ///< Time of construction
+
+            public:
+                ///
+                /// @brief Sole parameterized constructor
+                ///
+                /// Design: Sample the steady clock
+                ///
+                explicit ScopedStage(const Stage stage) noexcept : m_stage(stage),
+                                                                   m_startTime(std::chrono::steady_clock::now())
+                {
+                }
+
+                ///
+                /// @brief Sole destructor
+                ///
+                /// Design: Invoke @ref Metrics::recordLatency with the time elapsed since construction
+                ///
+                ~ScopedStage();
+
+                ScopedStage(const ScopedStage &) = delete;
+                ScopedStage &operator=(const ScopedStage &) = delete;
+        };
+
+    private:
+        struct ThreadSlot;
+
+        mutable std::mutex m_mutex { }; ///< Protects @ref Metrics::m_counters and @ref Metrics::m_freeCounters
+        std::deque<ThreadCounters> m_counters { }; ///< Counters of every thread that recorded, never moved
+        std::vector<ThreadCounters *> m_freeCounters { }; ///< Counters released by exited threads, reused by new ones
+        ThreadCounters m_fallbackCounters { }; ///< Shared by threads that failed to claim counters
+
+        Metrics() = default;
+
+        ///
+        /// @brief Returns the counters of the calling thread
+        ///
+        /// Design: On the first call of a thread, claim counters released by an exited thread, or append new ones
+        ///         to @ref Metrics::m_counters, under @ref Metrics::m_mutex. Counters accumulate across the threads
+        ///         owning them, so reused ones keep their values. Fall back to @ref Metrics::m_fallbackCounters if
+        ///         the allocation fails.
+        ///
+        static ThreadCounters &getThreadCounters() noexcept;
+
+        ///
+        /// @brief Adds @p value to @p counter, which only the calling thread writes
+        ///
+        static void add(std::atomic<std::uint64_t> &counter, const std::uint64_t value) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+    public:
+        ///
+        /// @brief Returns the process wide instance
+        ///
+        static Metrics &getInstance() noexcept;
+
+        Metrics(const Metrics &) = delete;
+        Metrics &operator=(const Metrics &) = delete;
+
+        ///
+        /// @brief Records a frame of @p pixels pixels converted with @p simdTier
+        ///
+        static void recordFrame(const utils::SimdTier simdTier, const std::uint64_t pixels) noexcept;
+
+        ///
+        /// @brief Records @p bytes bytes processed by @p stage
+        ///
+        static void recordBytes(const Stage stage, const std::uint64_t bytes) noexcept;
+
+        ///
+        /// @brief Records an execution of @p stage lasting @p latencyNs nanoseconds
+        ///
+        /// Design: Count it in the first bucket whose upper bound, @ref Metrics::ct_firstBucketNs doubled per bucket,
+        ///         is at least @p latencyNs, else in the unbounded last bucket
+        ///
+        static void recordLatency(const Stage stage, const std::uint64_t latencyNs) noexcept;
+
+        ///
+        /// @brief Returns the sum of the counters of all threads in the Prometheus text exposition format
+        ///
+        /// Design:
+        /// -# Sum the counters of @ref Metrics::m_counters and @ref Metrics::m_fallbackCounters with relaxed loads
+        /// -# Write the counters rgb2yuv_frames_total and rgb2yuv_pixels_total labelled by SIMD tier,
+        ///    rgb2yuv_stage_bytes_total labelled by stage, and the histogram rgb2yuv_stage_latency_seconds
+        ///    labelled by stage, with cumulative buckets
+        ///
+        std::string format() const;
+
+        ///
+        /// @brief Writes @ref Metrics::format to @p metricsFile
+        ///
+        /// @throws std::runtime_error if the file cannot be written
+        ///
+        /// Design: Write to a temporary file next to @p metricsFile and rename it over @p metricsFile, so that a
+        ///         scraper never reads a partial file
+        ///
+        void dump(const std::string &metricsFile) const;
+};
+
+} // namespace rgb2yuv
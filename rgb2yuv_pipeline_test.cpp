@@ -0,0 +1,659 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of the stages around the rgb2yuv::Converter kernels.
+//
+// Large ASCII PPM payloads with random whitespace are decoded in parallel chunks and compared against a
+// single chunk parse. Small randomized images are converted by rgb2yuv::AsyncContext, by rgb2yuv::Batch from
+// a manifest and a glob, and by rgb2yuv::Context with a conversion cache. The outputs and cache entries are
+// compared byte for byte against the scalar converter. The Prometheus metrics are checked to count every
+// record of concurrent threads. The tuner selection rules are checked with fixed timings, and its tune file
+// against a hand-written one.
+//
+// Usage: rgb2yuv_pipeline_test [seed]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rgb2yuv.hpp"
+#include "rgb2yuv_async.hpp"
+#include "rgb2yuv_batch.hpp"
+#include "rgb2yuv_cache.hpp"
+#include "rgb2yuv_converter.hpp"
+#include "rgb2yuv_decoder.hpp"
+#include "rgb2yuv_metrics.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+#include "rgb2yuv_tuner.hpp"
+
+namespace
+{
+
+using rgb2yuv::utils::ColorFormat;
+using rgb2yuv::utils::ColorMatrix;
+using rgb2yuv::utils::SimdTier;
+
+std::uint32_t g_numFailures { 0U };
+
+template<typename Expected, typename Actual>
+void expectEqual(const Expected &expected, const Actual &actual,
+                 const char *what, const SimdTier simdTier, const std::uint32_t width, const std::uint32_t height,
+                 const std::uint32_t format)
+{
+    if (expected.size() != actual.size()) {
+        std::cerr << "FAIL " << what << " tier=" << rgb2yuv::utils::toString(simdTier) << " " << width << "x" << height
+                  << " format=" << format << ": size " << actual.size() << " != " << expected.size() << "\n";
+        ++g_numFailures;
+        return;
+    }
+
+    const auto mismatch { std::mismatch(expected.begin(), expected.end(), actual.begin()) };
+    if (mismatch.first != expected.end()) {
+        std::cerr << "FAIL " << what << " tier=" << rgb2yuv::utils::toString(simdTier) << " " << width << "x" << height
+                  << " format=" << format << ": byte " << (mismatch.first - expected.begin()) << " is "
+                  << static_cast<std::uint32_t>(*mismatch.second) << ", expected "
+                  << static_cast<std::uint32_t>(*mismatch.first) << "\n";
+        ++g_numFailures;
+    }
+}
+
+void testPpmChunks(std::mt19937 &rng)
+{
+    using rgb2yuv::utils::FileFormat;
+
+    constexpr std::uint32_t width { 640U };
+    constexpr std::uint32_t height { 480U };
+    constexpr char whitespace[] { ' ', '\t', '\n', '\r', '\v', '\f' };
+    std::uniform_int_distribution<std::uint32_t> whitespaceDist(0U, 5U);
+    std::uniform_int_distribution<std::uint32_t> runDist(1U, 4U);
+    rgb2yuv::ThreadPool threadPool(4U);
+
+    // 8bit samples are compared with the P6 of the same values, 10bit samples with a single chunk parse
+    for (const std::uint32_t maxColorValue : { 255U, 1023U })
+    {
+        const ColorFormat colorFormat { (maxColorValue == 255U) ? ColorFormat::rgb888 : ColorFormat::rgb161616 };
+        std::uniform_int_distribution<std::uint32_t> valueDist(0U, maxColorValue);
+        std::string p3 { "P3\n" + std::to_string(width) + " " + std::to_string(height) + "\n" +
+                         std::to_string(maxColorValue) + "\n" };
+        std::string p6 { "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n" };
+        const std::size_t headerSize { p3.size() };
+        std::size_t lastValuePos { 0U };
+        for (std::size_t idx { 0U }; idx < static_cast<std::size_t>(width) * height * 3U; ++idx)
+        {
+            const std::uint32_t value { valueDist(rng) };
+            // Runs of mixed whitespace, so that chunk boundaries land within runs and within values
+            for (std::uint32_t run { runDist(rng) }; run != 0U; --run)
+            {
+                p3 += whitespace[whitespaceDist(rng)];
+            }
+            lastValuePos = p3.size();
+            p3 += std::to_string(value);
+            p6 += static_cast<char>(value);
+        }
+        p3 += "\n";
+
+        // Below two chunks of the payload the chunked parse is never reached
+        if (p3.size() - headerSize < 2U * rgb2yuv::Decoder::ct_minChunkSize) {
+            std::cerr << "FAIL ppm chunks: payload of " << p3.size() - headerSize << " bytes is a single chunk\n";
+            ++g_numFailures;
+        }
+
+        const auto decode = [&](const std::string &file, rgb2yuv::ThreadPool *pool) -> std::vector<std::uint8_t>
+        {
+            rgb2yuv::Decoder decoder("", FileFormat::ppm, colorFormat, 0U, 0U, pool);
+            try
+            {
+                const rgb2yuv::FrameBuffer &decodedData { decoder.decode(reinterpret_cast<const std::uint8_t *>(file.data()),
+                                                                         file.size()) };
+                return { decodedData.begin(), decodedData.end() };
+            }
+            catch (const std::invalid_argument &)
+            {
+                return { };
+            }
+        };
+
+        const std::vector<std::uint8_t> chunked { decode(p3, &threadPool) };
+        const std::vector<std::uint8_t> expected { (maxColorValue == 255U) ? decode(p6, nullptr) : decode(p3, nullptr) };
+        expectEqual(expected, chunked, "ppm chunks", SimdTier::scalar, width, height, maxColorValue);
+
+        // A missing or an extra value only shows in the total of the per chunk counts
+        const std::string truncated { p3.substr(0U, lastValuePos) + "\n" };
+        const std::string overLong { p3 + "7\n" };
+        if (expected.empty() || !decode(truncated, &threadPool).empty() || !decode(overLong, &threadPool).empty()) {
+            std::cerr << "FAIL ppm chunks: maximum " << maxColorValue << " decoded " << expected.size()
+                      << " bytes, truncated or over-long payload accepted\n";
+            ++g_numFailures;
+        }
+    }
+}
+
+void testAsync(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<std::uint32_t> dimensionDist(1U, 64U);
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    const std::filesystem::path directory { std::filesystem::temp_directory_path() /
+                                            ("rgb2yuv_async_test_" + std::to_string(rng())) };
+    std::filesystem::create_directories(directory);
+
+    rgb2yuv::AsyncContext context(3U, false);
+    context.init();
+    rgb2yuv::ThreadPool threadPool(1U);
+    rgb2yuv::Converter scalar(ColorFormat::rgb888, ColorFormat::yuv420_nv12, ColorMatrix::bt709, SimdTier::scalar,
+                              threadPool);
+    scalar.init();
+
+    // Many small images converted by a single band each, and one spread over all workers
+    constexpr std::uint32_t numJobs { 64U };
+    std::vector<std::vector<std::uint8_t>> expected(numJobs);
+    std::vector<std::future<void>> futures { };
+    std::atomic<std::uint32_t> numCallbacks { 0U };
+    for (std::uint32_t jobIdx { 0U }; jobIdx < numJobs; ++jobIdx)
+    {
+        const std::uint32_t width { (jobIdx == 0U) ? 1024U : 2U * dimensionDist(rng) };
+        const std::uint32_t height { (jobIdx == 0U) ? 512U : 2U * dimensionDist(rng) };
+        std::vector<std::uint8_t> src(static_cast<std::size_t>(width) * height * 3U);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+        const rgb2yuv::FrameBuffer &converted { scalar.convert(src.data(), width * 3U, width, height) };
+        expected[jobIdx].assign(converted.begin(), converted.end());
+
+        rgb2yuv::utils::InputArguments args { };
+        args.inputFile = (directory / ("in" + std::to_string(jobIdx) + ".rgb")).string();
+        args.outputFile = (directory / ("out" + std::to_string(jobIdx) + ".yuv")).string();
+        args.inputFileFormat = rgb2yuv::utils::FileFormat::raw;
+        args.outputFileFormat = rgb2yuv::utils::FileFormat::raw;
+        args.inputColorFormat = ColorFormat::rgb888;
+        args.outputColorFormat = ColorFormat::yuv420_nv12;
+        args.colorMatrix = ColorMatrix::bt709;
+        args.width = width;
+        args.height = height;
+        std::ofstream(args.inputFile, std::ios::binary).write(reinterpret_cast<const char *>(src.data()),
+                                                               static_cast<std::streamsize>(src.size()));
+        futures.push_back(context.submit(args, [&](const std::exception_ptr error)
+        {
+            if (!error) {
+                ++numCallbacks;
+            }
+        }));
+    }
+
+    // A missing input fails its job only
+    rgb2yuv::utils::InputArguments missing { };
+    missing.inputFile = (directory / "missing.rgb").string();
+    missing.outputFile = (directory / "missing.yuv").string();
+    missing.inputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    missing.outputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    missing.inputColorFormat = ColorFormat::rgb888;
+    missing.outputColorFormat = ColorFormat::yuv420_nv12;
+    missing.width = 2U;
+    missing.height = 2U;
+    std::future<void> missingFuture { context.submit(missing) };
+
+    for (std::uint32_t jobIdx { 0U }; jobIdx < numJobs; ++jobIdx)
+    {
+        futures[jobIdx].get();
+        std::ifstream file(directory / ("out" + std::to_string(jobIdx) + ".yuv"), std::ios::binary);
+        const std::vector<std::uint8_t> actual { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        expectEqual(expected[jobIdx], actual, "async", context.getSimdTier(), jobIdx, 0U,
+                    static_cast<std::uint32_t>(ColorFormat::yuv420_nv12));
+    }
+
+    bool hasFailed { false };
+    try
+    {
+        missingFuture.get();
+    }
+    catch (const std::exception &)
+    {
+        hasFailed = true;
+    }
+    context.deinit();
+
+    if (!hasFailed || (numCallbacks.load() != numJobs)) {
+        std::cerr << "FAIL async: missing input failed=" << hasFailed << ", " << numCallbacks.load() << " of "
+                  << numJobs << " callbacks\n";
+        ++g_numFailures;
+    }
+    std::filesystem::remove_all(directory);
+}
+
+void testBatch(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    const std::filesystem::path directory { std::filesystem::temp_directory_path() /
+                                            ("rgb2yuv_batch_test_" + std::to_string(rng())) };
+    std::filesystem::create_directories(directory / "out");
+
+    constexpr std::uint32_t width { 96U };
+    constexpr std::uint32_t height { 64U };
+    constexpr std::uint32_t numInputs { 12U };
+    constexpr ColorFormat outputColorFormats[] { ColorFormat::yuv420_nv12, ColorFormat::yuyv };
+    rgb2yuv::ThreadPool threadPool(1U);
+    std::vector<std::vector<std::uint8_t>> expected { };
+    std::ofstream manifest(directory / "manifest.txt");
+    manifest << "# Every input fanned out to nv12 and yuyv\n\n";
+    for (std::uint32_t inputIdx { 0U }; inputIdx < numInputs; ++inputIdx)
+    {
+        std::vector<std::uint8_t> src(static_cast<std::size_t>(width) * height * 3U);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+        const std::filesystem::path inputFile { directory / ("in" + std::to_string(inputIdx) + ".rgb") };
+        std::ofstream(inputFile, std::ios::binary).write(reinterpret_cast<const char *>(src.data()),
+                                                         static_cast<std::streamsize>(src.size()));
+        manifest << inputFile.string();
+        for (const ColorFormat outputColorFormat : outputColorFormats)
+        {
+            rgb2yuv::Converter scalar(ColorFormat::rgb888, outputColorFormat, ColorMatrix::bt601, SimdTier::scalar,
+                                      threadPool);
+            scalar.init();
+            const rgb2yuv::FrameBuffer &converted { scalar.convert(src.data(), width * 3U, width, height) };
+            expected.emplace_back(converted.begin(), converted.end());
+            manifest << " " << (directory / ("out" + std::to_string(expected.size()) + ".yuv")).string() << " "
+                     << ((outputColorFormat == ColorFormat::yuyv) ? "yuyv" : "yuv420_nv12") << " raw";
+        }
+        manifest << "\n";
+    }
+
+    // A missing input fails on its own, after the others have been read ahead
+    manifest << (directory / "missing.rgb").string() << " " << (directory / "missing.yuv").string()
+             << " yuv420_nv12 raw\n";
+    manifest.close();
+
+    rgb2yuv::utils::InputArguments args { };
+    args.batch = (directory / "manifest.txt").string();
+    args.inputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    args.inputColorFormat = ColorFormat::rgb888;
+    args.width = width;
+    args.height = height;
+    args.numThreads = 2U;
+    rgb2yuv::Batch batch(args);
+    batch.init();
+    const std::uint32_t numFailed { batch.run() };
+    batch.deinit();
+
+    for (std::size_t outputIdx { 0U }; outputIdx < expected.size(); ++outputIdx)
+    {
+        std::ifstream file(directory / ("out" + std::to_string(outputIdx + 1U) + ".yuv"), std::ios::binary);
+        const std::vector<std::uint8_t> actual { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        expectEqual(expected[outputIdx], actual, "batch", SimdTier::scalar, static_cast<std::uint32_t>(outputIdx), 0U,
+                    static_cast<std::uint32_t>(outputColorFormats[outputIdx % 2U]));
+    }
+
+    // A glob writes <stem>.yuv into the output directory
+    args.batch = (directory / "in1?.rgb").string();
+    args.outputDir = (directory / "out").string();
+    args.outputColorFormat = ColorFormat::yuv420_nv12;
+    args.outputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    rgb2yuv::Batch glob(args);
+    glob.init();
+    const std::uint32_t numGlobFailed { glob.run() };
+    glob.deinit();
+    const std::uint32_t numGlobOutputs { static_cast<std::uint32_t>(std::distance(
+        std::filesystem::directory_iterator(directory / "out"), std::filesystem::directory_iterator())) };
+
+    if ((numFailed != 1U) || (numGlobFailed != 0U) || (numGlobOutputs != 2U) ||
+        !std::filesystem::exists(directory / "out" / "in11.yuv")) {
+        std::cerr << "FAIL batch: " << numFailed << " manifest inputs failed, " << numGlobFailed << " of "
+                  << numGlobOutputs << " glob outputs failed\n";
+        ++g_numFailures;
+    }
+    std::filesystem::remove_all(directory);
+}
+
+std::vector<std::uint8_t> readFile(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+void testCache(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<std::uint32_t> byteDist(0U, 255U);
+    const std::filesystem::path directory { std::filesystem::temp_directory_path() /
+                                            ("rgb2yuv_cache_test_" + std::to_string(rng())) };
+    std::filesystem::create_directories(directory);
+
+    constexpr std::uint32_t width { 64U };
+    constexpr std::uint32_t height { 32U };
+    constexpr std::uint32_t numInputs { 3U };
+    rgb2yuv::ThreadPool threadPool(1U);
+    rgb2yuv::utils::InputArguments args { };
+    args.inputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    args.inputColorFormat = ColorFormat::rgb888;
+    args.outputFileFormat = rgb2yuv::utils::FileFormat::raw;
+    args.outputColorFormat = ColorFormat::yuv420_nv12;
+    args.width = width;
+    args.height = height;
+    args.numThreads = 1U;
+    args.cacheDir = (directory / "cache").string();
+    args.cacheSizeLimit = static_cast<std::uint64_t>(width) * height * 3U;
+
+    std::vector<std::vector<std::uint8_t>> sources { };
+    std::vector<std::filesystem::path> entries { };
+    for (std::uint32_t inputIdx { 0U }; inputIdx < numInputs; ++inputIdx)
+    {
+        std::vector<std::uint8_t> src(static_cast<std::size_t>(width) * height * 3U);
+        std::generate(src.begin(), src.end(), [&] { return static_cast<std::uint8_t>(byteDist(rng)); });
+        std::ofstream(directory / ("in" + std::to_string(inputIdx) + ".rgb"), std::ios::binary)
+            .write(reinterpret_cast<const char *>(src.data()), static_cast<std::streamsize>(src.size()));
+        entries.push_back(directory / "cache" /
+                          (rgb2yuv::ConversionCache::makeKey(src.data(), src.size(), args) + ".bin"));
+        sources.push_back(std::move(src));
+    }
+
+    const auto expectedOf = [&](const std::uint32_t inputIdx, const ColorMatrix colorMatrix)
+    {
+        rgb2yuv::Converter scalar(ColorFormat::rgb888, ColorFormat::yuv420_nv12, colorMatrix, SimdTier::scalar,
+                                  threadPool);
+        scalar.init();
+        const rgb2yuv::FrameBuffer &converted { scalar.convert(sources[inputIdx].data(), width * 3U, width, height) };
+        return std::vector<std::uint8_t>(converted.begin(), converted.end());
+    };
+    const auto run = [&](const std::uint32_t inputIdx, const std::string &outputFile, const ColorMatrix colorMatrix,
+                         const bool useCache)
+    {
+        rgb2yuv::utils::InputArguments runArgs { args };
+        runArgs.inputFile = (directory / ("in" + std::to_string(inputIdx) + ".rgb")).string();
+        runArgs.outputFile = (directory / outputFile).string();
+        runArgs.colorMatrix = colorMatrix;
+        runArgs.cacheDir = useCache ? args.cacheDir : std::string { };
+        rgb2yuv::Context context(runArgs);
+        context.init();
+        context.run();
+        context.deinit();
+        return readFile(directory / outputFile);
+    };
+    const auto check = [&](const std::vector<std::uint8_t> &expected, const std::vector<std::uint8_t> &actual,
+                           const std::uint32_t step)
+    {
+        expectEqual(expected, actual, "cache step", SimdTier::scalar, width, height, step);
+    };
+
+    const std::vector<std::uint8_t> expected601 { expectedOf(0U, ColorMatrix::bt601) };
+    const std::vector<std::uint8_t> expected709 { expectedOf(0U, ColorMatrix::bt709) };
+
+    // Miss, stores a read-only entry
+    check(expected601, run(0U, "out.yuv", ColorMatrix::bt601, true), 0U);
+    check(expected601, readFile(entries[0U]), 1U);
+    const bool isReadOnly { (std::filesystem::status(entries[0U]).permissions() & std::filesystem::perms::owner_write) ==
+                            std::filesystem::perms::none };
+
+    // Overwriting the output of a cache hit or miss without the cache must leave the entry intact
+    check(expected709, run(0U, "out.yuv", ColorMatrix::bt709, false), 2U);
+    check(expected601, readFile(entries[0U]), 3U);
+    check(expected601, run(0U, "out2.yuv", ColorMatrix::bt601, true), 4U);
+    check(expected709, readFile(directory / "out.yuv"), 5U);
+
+    // A hit is served from the entry, marked here so that it cannot be mistaken for a new conversion
+    std::vector<std::uint8_t> marked { expected601 };
+    marked[0U] ^= 0xFFU;
+    std::filesystem::permissions(entries[0U], std::filesystem::perms::owner_write, std::filesystem::perm_options::add);
+    std::ofstream(entries[0U], std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char *>(marked.data()), static_cast<std::streamsize>(marked.size()));
+    check(marked, run(0U, "out3.yuv", ColorMatrix::bt601, true), 6U);
+
+    // The limit fits two entries. A hit refreshes entry 0, so the miss of input 2 evicts entry 1
+    check(expectedOf(1U, ColorMatrix::bt601), run(1U, "out4.yuv", ColorMatrix::bt601, true), 7U);
+    const std::filesystem::file_time_type now { std::filesystem::file_time_type::clock::now() };
+    std::filesystem::last_write_time(entries[0U], now - std::chrono::hours(2));
+    std::filesystem::last_write_time(entries[1U], now - std::chrono::hours(1));
+    check(marked, run(0U, "out5.yuv", ColorMatrix::bt601, true), 8U);
+    check(expectedOf(2U, ColorMatrix::bt601), run(2U, "out6.yuv", ColorMatrix::bt601, true), 9U);
+
+    if (!isReadOnly || !std::filesystem::exists(entries[0U]) || std::filesystem::exists(entries[1U]) ||
+        !std::filesystem::exists(entries[2U])) {
+        std::cerr << "FAIL cache: read-only " << isReadOnly << ", entries present " << std::filesystem::exists(entries[0U])
+                  << std::filesystem::exists(entries[1U]) << std::filesystem::exists(entries[2U]) << "\n";
+        ++g_numFailures;
+    }
+    std::filesystem::remove_all(directory);
+}
+
+std::uint64_t getMetric(const std::string &metrics, const std::string &series)
+{
+    const std::size_t pos { metrics.find("\n" + series + " ") };
+    return (pos == std::string::npos) ? 0U : std::strtoull(metrics.c_str() + pos + series.size() + 2U, nullptr, 10);
+}
+
+void testMetrics()
+{
+    const std::string frames { "rgb2yuv_frames_total{simd=\"sse4_1\"}" };
+    const std::string pixels { "rgb2yuv_pixels_total{simd=\"sse4_1\"}" };
+    const std::string bucket { "rgb2yuv_stage_latency_seconds_bucket{stage=\"encode\",le=\"0.0004\"}" };
+    const std::string count { "rgb2yuv_stage_latency_seconds_count{stage=\"encode\"}" };
+    const std::string before { rgb2yuv::Metrics::getInstance().format() };
+
+    // The second round of threads reuses the counters released by the first one
+    constexpr std::uint32_t numThreads { 8U };
+    constexpr std::uint32_t numRecords { 1000U };
+    for (std::uint32_t round { 0U }; round < 2U; ++round)
+    {
+        std::vector<std::thread> threads { };
+        for (std::uint32_t threadIdx { 0U }; threadIdx < numThreads; ++threadIdx)
+        {
+            threads.emplace_back([]()
+            {
+                for (std::uint32_t recordIdx { 0U }; recordIdx < numRecords; ++recordIdx)
+                {
+                    rgb2yuv::Metrics::recordFrame(SimdTier::sse4_1, 10U);
+                    rgb2yuv::Metrics::recordLatency(rgb2yuv::Stage::encode, 300000U);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    const std::string after { rgb2yuv::Metrics::getInstance().format() };
+    constexpr std::uint64_t numExpected { 2U * numThreads * numRecords };
+    if ((getMetric(after, frames) - getMetric(before, frames) != numExpected) ||
+        (getMetric(after, pixels) - getMetric(before, pixels) != 10U * numExpected) ||
+        (getMetric(after, bucket) - getMetric(before, bucket) != numExpected) ||
+        (getMetric(after, count) - getMetric(before, count) != numExpected)) {
+        std::cerr << "FAIL metrics: expected " << numExpected << " records\n" << after;
+        ++g_numFailures;
+    }
+}
+
+void testTunerSelection()
+{
+    using rgb2yuv::Tuner;
+
+    // Fixed timings of a host with maxThreads logical processors
+    struct TunerCase
+    {
+        const char *what;
+        std::uint32_t maxThreads;
+        std::map<std::uint32_t, double> bandwidths; // MB/s by number of workers
+        std::map<std::uint32_t, double> mpixPerS; // Mpixel/s by number of workers with regular stores
+        double streamingGain; // Speedup of non-temporal stores
+        std::map<std::uint32_t, double> bandRowsGains; // Speedup by band height
+        std::uint32_t expectedThreads;
+        std::uint32_t maxTimedThreads;
+        bool expectStreaming;
+        std::uint32_t expectedBandRows;
+    };
+
+    const std::map<std::uint32_t, double> noBandRowsGains { { 0U, 1.0 }, { 16U, 1.0 }, { 64U, 1.0 }, { 256U, 1.0 } };
+    const TunerCase tunerCases[] {
+        // 4 workers reach ct_saturation of the peak, so 16 are never timed although they would be fastest
+        { "saturated at 4", 16U,
+          { { 1U, 10000.0 }, { 2U, 18000.0 }, { 4U, 27100.0 }, { 8U, 29000.0 }, { 16U, 30000.0 } },
+          { { 1U, 100.0 }, { 2U, 190.0 }, { 4U, 300.0 }, { 8U, 400.0 }, { 16U, 1000.0 } }, 1.0, noBandRowsGains,
+          8U, 8U, false, 0U },
+        // Just below the cutoff 8 workers saturate, which lifts the cap to 16
+        { "saturated at 8", 16U,
+          { { 1U, 10000.0 }, { 2U, 18000.0 }, { 4U, 26900.0 }, { 8U, 29000.0 }, { 16U, 30000.0 } },
+          { { 1U, 100.0 }, { 2U, 190.0 }, { 4U, 300.0 }, { 8U, 400.0 }, { 16U, 1000.0 } }, 1.0, noBandRowsGains,
+          16U, 16U, false, 0U },
+        // A single worker saturates. 2 workers are 2.5% faster, short of ct_minGain, and 4 are beyond the cap.
+        // Band heights only win by ct_minGain over the best one so far.
+        { "below min gain", 4U, { { 1U, 10000.0 }, { 2U, 10000.0 }, { 4U, 10000.0 } },
+          { { 1U, 100.0 }, { 2U, 102.5 }, { 4U, 500.0 } }, 1.1,
+          { { 0U, 1.0 }, { 16U, 1.02 }, { 64U, 1.05 }, { 256U, 1.06 } }, 1U, 2U, true, 64U },
+        { "above min gain", 4U, { { 1U, 10000.0 }, { 2U, 10000.0 }, { 4U, 10000.0 } },
+          { { 1U, 100.0 }, { 2U, 104.0 }, { 4U, 500.0 } }, 1.0, noBandRowsGains, 2U, 2U, false, 0U },
+    };
+
+    constexpr std::size_t lastLevelCacheSize { static_cast<std::size_t>(32U) << 20U };
+    const Tuner tuner("", SimdTier::scalar, ColorFormat::rgb888, ColorFormat::yuv420_nv12, lastLevelCacheSize);
+    for (const TunerCase &tunerCase : tunerCases)
+    {
+        std::uint32_t maxTimedThreads { 0U };
+        Tuner::Measurements measurements { };
+        measurements.maxThreads = tunerCase.maxThreads;
+        measurements.probeBandwidth = [&](const std::uint32_t numThreads)
+        {
+            return tunerCase.bandwidths.at(numThreads);
+        };
+        measurements.timeConversion = [&](const std::uint32_t numThreads, const std::uint32_t bandRows,
+                                          const std::size_t streamingThreshold)
+        {
+            maxTimedThreads = std::max(maxTimedThreads, numThreads);
+            const bool isStreaming { streamingThreshold != std::numeric_limits<std::size_t>::max() };
+            return tunerCase.mpixPerS.at(numThreads) * (isStreaming ? tunerCase.streamingGain : 1.0) *
+                   tunerCase.bandRowsGains.at(bandRows);
+        };
+
+        const Tuner::Settings settings { tuner.calibrate(measurements) };
+        const std::size_t expectedThreshold { tunerCase.expectStreaming ? lastLevelCacheSize :
+                                                                          std::numeric_limits<std::size_t>::max() };
+        if ((settings.numThreads != tunerCase.expectedThreads) || (maxTimedThreads != tunerCase.maxTimedThreads) ||
+            (settings.streamingThreshold != expectedThreshold) || (settings.bandRows != tunerCase.expectedBandRows) ||
+            (settings.bandwidth != tunerCase.bandwidths.at(tunerCase.expectedThreads))) {
+            std::cerr << "FAIL tuner " << tunerCase.what << ": " << settings.numThreads << " threads, timed up to "
+                      << maxTimedThreads << ", streaming threshold " << settings.streamingThreshold << ", "
+                      << settings.bandRows << " band rows\n";
+            ++g_numFailures;
+        }
+    }
+}
+
+void testTunerFile(std::mt19937 &rng)
+{
+    using rgb2yuv::Tuner;
+
+    const std::filesystem::path tuneFile { std::filesystem::temp_directory_path() /
+                                           ("rgb2yuv_tune_test_" + std::to_string(rng())) / "tune.txt" };
+    std::filesystem::create_directories(tuneFile.parent_path());
+    const Tuner nv12(tuneFile.string(), SimdTier::avx2, ColorFormat::rgb888, ColorFormat::yuv420_nv12, 0U);
+    const Tuner yuyv(tuneFile.string(), SimdTier::avx2, ColorFormat::rgb888, ColorFormat::yuyv, 0U);
+    const std::string hostKey { Tuner::getHostKey() };
+    const std::string nv12Fields { " " + std::to_string(static_cast<std::uint32_t>(SimdTier::avx2)) + " " +
+                                   std::to_string(static_cast<std::uint32_t>(ColorFormat::rgb888)) + " " +
+                                   std::to_string(static_cast<std::uint32_t>(ColorFormat::yuv420_nv12)) + " " };
+    const auto isEqual = [](const Tuner::Settings &lhs, const Tuner::Settings &rhs)
+    {
+        return (lhs.numThreads == rhs.numThreads) && (lhs.bandRows == rhs.bandRows) &&
+               (lhs.streamingThreshold == rhs.streamingThreshold) && (lhs.bandwidth == rhs.bandwidth) &&
+               (lhs.mpixPerS == rhs.mpixPerS);
+    };
+
+    // Another host with the same conversion comes first and must be skipped, as must the comment
+    std::ofstream(tuneFile) << "# host simd input output threads bandRows streamingThreshold MB/s Mpixel/s\n"
+                            << "Foreign_CPU_64" << nv12Fields << "32 256 0 90000 2000\n"
+                            << hostKey << nv12Fields << "3 16 1048576 12500.5 87.25\n";
+    Tuner::Settings handWritten { };
+    handWritten.numThreads = 3U;
+    handWritten.bandRows = 16U;
+    handWritten.streamingThreshold = 1048576U;
+    handWritten.bandwidth = 12500.5;
+    handWritten.mpixPerS = 87.25;
+    Tuner::Settings loaded { };
+    Tuner::Settings unknown { };
+    const bool isLoaded { nv12.load(loaded) && isEqual(loaded, handWritten) };
+    const bool isUnknownLoaded { yuyv.load(unknown) };
+
+    // Storing replaces the entry of this host and conversion only
+    Tuner::Settings stored { handWritten };
+    stored.numThreads = 2U;
+    stored.streamingThreshold = std::numeric_limits<std::size_t>::max();
+    nv12.store(stored);
+    Tuner::Settings yuyvStored { handWritten };
+    yuyvStored.bandRows = 256U;
+    yuyv.store(yuyvStored);
+    Tuner::Settings reloaded { };
+    Tuner::Settings yuyvReloaded { };
+    const bool isReloaded { nv12.load(reloaded) && isEqual(reloaded, stored) && yuyv.load(yuyvReloaded) &&
+                            isEqual(yuyvReloaded, yuyvStored) };
+
+    std::ifstream file(tuneFile);
+    std::uint32_t numComments { 0U };
+    std::uint32_t numForeign { 0U };
+    std::uint32_t numNv12 { 0U };
+    std::string line { };
+    while (std::getline(file, line))
+    {
+        numComments += (line.rfind("#", 0U) == 0U) ? 1U : 0U;
+        numForeign += (line.rfind("Foreign_CPU_64 ", 0U) == 0U) ? 1U : 0U;
+        numNv12 += (line.rfind(hostKey + nv12Fields, 0U) == 0U) ? 1U : 0U;
+    }
+
+    if (!isLoaded || isUnknownLoaded || !isReloaded || (numComments != 1U) || (numForeign != 1U) ||
+        (numNv12 != 1U)) {
+        std::cerr << "FAIL tuner file: loaded " << isLoaded << ", unknown conversion loaded " << isUnknownLoaded
+                  << ", reloaded " << isReloaded << ", " << numComments << " comments, " << numForeign
+                  << " foreign and " << numNv12 << " nv12 entries\n";
+        ++g_numFailures;
+    }
+    std::filesystem::remove_all(tuneFile.parent_path());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const std::uint32_t seed { (argc > 1) ? static_cast<std::uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 5489U };
+    std::mt19937 rng(seed);
+    std::cout << "seed=" << seed << "\n";
+
+    testPpmChunks(rng);
+    testAsync(rng);
+    testBatch(rng);
+    testCache(rng);
+    testMetrics();
+    testTunerSelection();
+    testTunerFile(rng);
+
+    if (g_numFailures != 0U) {
+        std::cerr << g_numFailures << " failures\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "All pipeline stages passed\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_stats.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "rgb2yuv_metrics.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+#include "rgb2yuv_utils_asm.hpp"
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+void append(std::string &out, const char *format, ...)
+{
+    char buffer[512] { };
+    va_list args;
+    va_start(args, format);
+    const int written { std::vsnprintf(buffer, sizeof(buffer), format, args) };
+    va_end(args);
+    if (written > 0) {
+        out.append(buffer, (static_cast<std::size_t>(written) < sizeof(buffer)) ? static_cast<std::size_t>(written) : sizeof(buffer) - 1U);
+    }
+}
+
+} // namespace
+
+const char *toString(const Stage stage) noexcept
+{
+    const char *ret { "decode" };
+
+    switch (stage)
+    {
+        case(Stage::convert):
+            ret = "convert";
+            break;
+        case(Stage::encode):
+            ret = "encode";
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
+Stats::ScopedStage::ScopedStage(Stats &stats, const Stage stage) noexcept : m_stats(stats),
+                                                                            m_stage(stage),
+                                                                            m_startTicks(utils_asm::readTsc()),
+                                                                            m_startClocks(std::clock()),
+                                                                            m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+Stats::ScopedStage::~ScopedStage()
+{
+    StageRecord &record { m_stats.m_stages[static_cast<std::uint32_t>(m_stage)] };
+    record.wallTicks += utils_asm::readTsc() - m_startTicks;
+    record.cpuClocks += std::clock() - m_startClocks;
+    const auto elapsed { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime) };
+    Metrics::recordLatency(m_stage, static_cast<std::uint64_t>(elapsed.count()));
+}
+
+Stats::Stats() noexcept : m_startTicks(utils_asm::readTsc()), m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+double Stats::getTicksPerNs() const noexcept
+{
+    const std::uint64_t ticks { utils_asm::readTsc() - m_startTicks };
+    const auto elapsed { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime) };
+
+    return (elapsed.count() > 0) ? static_cast<double>(ticks) / static_cast<double>(elapsed.count()) : 1.0;
+}
+
+void Stats::addVolume(const Stage stage, const std::uint64_t bytes, const std::uint64_t pixels) noexcept
+{
+    StageRecord &record { m_stages[static_cast<std::uint32_t>(stage)] };
+    record.bytes += bytes;
+    record.pixels += pixels;
+    Metrics::recordBytes(stage, bytes);
+}
+
+void Stats::setThreadRecords(const ThreadPool &threadPool)
+{
+    const std::vector<ThreadPool::WorkerCounters> &counters { threadPool.getCounters() };
+    m_threads.resize(counters.size());
+    for (std::size_t idx { 0U }; idx < counters.size(); ++idx)
+    {
+        m_threads[idx].busyTicks = counters[idx].busyTicks;
+        m_threads[idx].idleTicks = counters[idx].idleTicks;
+    }
+}
+
+std::string Stats::format(const utils::StatsFormat format) const
+{
+    const double msPerTick { 1.0 / (getTicksPerNs() * 1e6) };
+    const double msPerClock { 1e3 / static_cast<double>(CLOCKS_PER_SEC) };
+    const bool json { format == utils::StatsFormat::json };
+    std::string out { };
+
+    if (json) {
+        append(out, "{\"simd\":\"%s\",\"stages\":{", utils::toString(m_simdTier));
+    } else {
+        append(out, "rgb2yuv stats: simd=%s", utils::toString(m_simdTier));
+    }
+
+    for (std::uint32_t idx { 0U }; idx < ct_numStages; ++idx)
+    {
+        const StageRecord &record { m_stages[idx] };
+        const double wallMs { static_cast<double>(record.wallTicks) * msPerTick };
+        const double cpuMs { static_cast<double>(record.cpuClocks) * msPerClock };
+        const double mpixPerS { (wallMs > 0.0) ? static_cast<double>(record.pixels) / (wallMs * 1e3) : 0.0 };
+        const double mbPerS { (wallMs > 0.0) ? static_cast<double>(record.bytes) / (wallMs * 1e3) : 0.0 };
+        if (json) {
+            append(out, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"bytes\":%llu,\"pixels\":%llu,"
+                   "\"mpix_per_s\":%.2f,\"mb_per_s\":%.2f}", (idx > 0U) ? "," : "",
+                   toString(static_cast<Stage>(idx)), wallMs, cpuMs,
+                   static_cast<unsigned long long>(record.bytes), static_cast<unsigned long long>(record.pixels),
+                   mpixPerS, mbPerS);
+        } else {
+            append(out, " | %s wall=%.3fms cpu=%.3fms bytes=%llu pixels=%llu %.2fMpix/s %.2fMB/s",
+                   toString(static_cast<Stage>(idx)), wallMs, cpuMs,
+                   static_cast<unsigned long long>(record.bytes), static_cast<unsigned long long>(record.pixels),
+                   mpixPerS, mbPerS);
+        }
+    }
+
+    if (json) {
+        append(out, "},\"threads\":[");
+    } else {
+        append(out, " | threads");
+    }
+
+    for (std::size_t idx { 0U }; idx < m_threads.size(); ++idx)
+    {
+        const double busyMs { static_cast<double>(m_threads[idx].busyTicks) * msPerTick };
+        const double idleMs { static_cast<double>(m_threads[idx].idleTicks) * msPerTick };
+        if (json) {
+            append(out, "%s{\"busy_ms\":%.3f,\"idle_ms\":%.3f}", (idx > 0U) ? "," : "", busyMs, idleMs);
+        } else {
+            append(out, " %zu:busy=%.3fms,idle=%.3fms", idx, busyMs, idleMs);
+        }
+    }
+
+    if (json) {
+        append(out, "]}");
+    }
+
+    return out;
+}
+
+} // namespace rgb2yuv
@@ -0,0 +1,195 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+class ThreadPool;
+
+///
+/// @brief Pipeline stages instrumented by @ref Stats
+///
+enum class Stage : std::uint32_t
+{
+    decode = 0U, ///< @ref rgb2yuv::Decoder::decode
+    convert, ///< @ref rgb2yuv::Converter::convert
+    encode, ///< @ref rgb2yuv::Encoder::encode
+    last = encode
+};
+
+///
+/// @brief Converts a @ref Stage to its name
+///
+/// @returns Null terminated name of @p stage ("decode", "convert" or "encode")
+///
+const char *toString(const Stage stage) noexcept;
+
+class Stats
+{
+    public:
+        static constexpr std::uint32_t ct_numStages { static_cast<std::uint32_t>(Stage::last) + 1U }; ///< Number of @ref Stage values
+
+        ///
+        /// @brief Timing and volume of a single @ref Stage
+        ///
+        struct StageRecord
+        {
+            std::uint64_t wallTicks { 0U }; ///< TSC ticks between the start and the end of the stage
+            std::clock_t cpuClocks { 0 }; ///< Process CPU time consumed by the stage (all threads)
+            std::uint64_t bytes { 0U }; ///< Bytes processed by the stage
+            std::uint64_t pixels { 0U }; ///< Pixels processed by the stage
+        };
+
+        ///
+        /// @brief Per worker busy and idle time
+        ///
+        struct ThreadRecord
+        {
+            std::uint64_t busyTicks { 0U }; ///< TSC ticks spent executing tasks
+            std::uint64_t idleTicks { 0U }; ///< TSC ticks spent waiting for other workers
+        };
+
+        ///
+        /// @brief RAII helper recording the wall and CPU time of a @ref Stage into @ref Stats, and its latency
+        ///        into @ref rgb2yuv::Metrics
+        ///
+        class ScopedStage
+        {
+            private:
+                Stats &m_stats; ///< Instance the stage is recorded into
+                const Stage m_stage; ///< Stage being timed
+                const std::uint64_t m_startTicks; ///< TSC value at construction
+                const std::clock_t m_startClocks; ///< Process CPU time at construction
+                const std::chrono::steady_clock::time_point m_startTime; ///< Wall clock at construction
+
+            public:
+                ///
+                /// @brief Sole parameterized constructor
+                ///
+                /// Design: Sample the TSC, the process CPU time and the steady clock
+                ///
+                ScopedStage(Stats &stats, const Stage stage) noexcept;
+
+                ///
+                /// @brief Sole destructor
+                ///
+                /// Design: Accumulate the elapsed TSC ticks and CPU time into the @ref StageRecord of @ref ScopedStage::m_stage
+                ///         and record the elapsed steady clock time with @ref rgb2yuv::Metrics::recordLatency
+                ///
+                ~ScopedStage();
+
+                ScopedStage(const ScopedStage &) = delete;
+                ScopedStage &operator=(const ScopedStage &) = delete;
+        };
+
+    private:
+        std::array<StageRecord, ct_numStages> m_stages { }; ///< Records of each @ref Stage
+        std::vector<ThreadRecord> m_threads { }; ///< Records of each worker of the conversion @ref ThreadPool
+        utils::SimdTier m_simdTier { utils::SimdTier::scalar }; ///< SIMD tier selected by @ref rgb2yuv::Context::init
+        const std::uint64_t m_startTicks; ///< TSC value at construction, used for calibration
+        const std::chrono::steady_clock::time_point m_startTime; ///< Wall clock at construction, used for calibration
+
+        ///
+        /// @brief Returns the number of TSC ticks per nanosecond measured since construction
+        ///
+        double getTicksPerNs() const noexcept;
+
+    public:
+        ///
+        /// @brief Default constructor
+        ///
+        /// Design: Sample the TSC and the steady clock for later calibration of the TSC frequency
+        ///
+        Stats() noexcept;
+
+        ///
+        /// @brief Records the SIMD tier selected for conversion
+        ///
+        void setSimdTier(const utils::SimdTier simdTier) noexcept
+        {
+            m_simdTier = simdTier;
+        }
+
+        ///
+        /// @brief Accumulates the volume of data processed by @p stage, and records its bytes into @ref rgb2yuv::Metrics
+        ///
+        /// @param[in] stage Stage that processed the data
+        /// @param[in] bytes Number of bytes processed
+        /// @param[in] pixels Number of pixels processed
+        ///
+        void addVolume(const Stage stage, const std::uint64_t bytes, const std::uint64_t pixels) noexcept;
+
+        ///
+        /// @brief Snapshots the busy and idle time of every worker of @p threadPool
+        ///
+        void setThreadRecords(const ThreadPool &threadPool);
+
+        ///
+        /// @brief Returns the record of @p stage
+        ///
+        const StageRecord &getStageRecord(const Stage stage) const noexcept
+        {
+            return m_stages[static_cast<std::uint32_t>(stage)];
+        }
+
+        ///
+        /// @brief Returns the records of the conversion workers
+        ///
+        const std::vector<ThreadRecord> &getThreadRecords() const noexcept
+        {
+            return m_threads;
+        }
+
+        ///
+        /// @brief Returns the SIMD tier selected for conversion
+        ///
+        utils::SimdTier getSimdTier() const noexcept
+        {
+            return m_simdTier;
+        }
+
+        ///
+        /// @brief Formats the collected statistics
+        ///
+        /// @param[in] format @ref utils::StatsFormat::text for a single summary line,
+        ///                   @ref utils::StatsFormat::json for a single line JSON object
+        ///
+        /// Design:
+        /// -# Calibrate the TSC against the steady clock
+        /// -# For every @ref Stage, print wall time, CPU time, bytes, pixels and throughput
+        /// -# For every worker, print busy and idle time
+        ///
+        /// @returns The formatted statistics without a trailing newline
+        ///
+        std::string format(const utils::StatsFormat format) const;
+};
+
+} // namespace rgb2yuv
@@ -0,0 +1,302 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_thread_pool.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "rgb2yuv_utils_asm.hpp"
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+// Parses a sysfs list such as "0-3,8,10-11"
+std::vector<std::uint32_t> parseList(const std::string &list)
+{
+    std::vector<std::uint32_t> ret { };
+    std::size_t pos { 0U };
+
+    while (pos < list.size())
+    {
+        std::size_t end { list.find(',', pos) };
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        const std::string range { list.substr(pos, end - pos) };
+        const std::size_t dash { range.find('-') };
+        try
+        {
+            const std::uint32_t first { static_cast<std::uint32_t>(std::stoul(range.substr(0U, dash))) };
+            const std::uint32_t last { (dash == std::string::npos) ? first :
+                                       static_cast<std::uint32_t>(std::stoul(range.substr(dash + 1U))) };
+            for (std::uint32_t value { first }; value <= last; ++value)
+            {
+                ret.push_back(value);
+            }
+        }
+        catch (const std::exception &)
+        {
+            // Ignore malformed entries
+        }
+        pos = end + 1U;
+    }
+
+    return ret;
+}
+
+std::string readFirstLine(const std::string &path)
+{
+    std::ifstream file(path);
+    std::string ret { };
+    std::getline(file, ret);
+    return ret;
+}
+
+// Returns the CPUs of every NUMA node that the process may run on
+std::vector<std::vector<std::uint32_t>> readNumaTopology()
+{
+    std::vector<std::vector<std::uint32_t>> ret { };
+
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    const bool hasAffinity { sched_getaffinity(0, sizeof(allowed), &allowed) == 0 };
+
+    for (const std::uint32_t node : parseList(readFirstLine("/sys/devices/system/node/online")))
+    {
+        std::vector<std::uint32_t> cpus { };
+        const std::string path { "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist" };
+        for (const std::uint32_t cpu : parseList(readFirstLine(path)))
+        {
+            if (!hasAffinity || ((cpu < CPU_SETSIZE) && CPU_ISSET(cpu, &allowed))) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            ret.push_back(std::move(cpus));
+        }
+    }
+
+    if (ret.empty() && hasAffinity) {
+        std::vector<std::uint32_t> cpus { };
+        for (std::uint32_t cpu { 0U }; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        ret.push_back(std::move(cpus));
+    }
+#endif
+
+    return ret;
+}
+
+void pinCurrentThread(const std::uint32_t cpu) noexcept
+{
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    // Best effort, an unpinned worker is still correct
+    static_cast<void>(pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet));
+#else
+    static_cast<void>(cpu);
+#endif
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(const std::uint32_t numThreads, const bool pinThreads) : m_numThreads(numThreads > 0U ? numThreads : 1U),
+                                                                                m_pinThreads(pinThreads),
+                                                                                m_counters(m_numThreads),
+                                                                                m_workerNodes(m_numThreads, 0U)
+{
+    if (m_pinThreads) {
+        assignWorkers();
+    }
+
+    for (std::uint32_t workerIdx { m_pinThreads ? 0U : 1U }; workerIdx < m_numThreads; ++workerIdx)
+    {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, workerIdx);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_jobCondition.notify_all();
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::assignWorkers()
+{
+    const std::vector<std::vector<std::uint32_t>> nodes { readNumaTopology() };
+    if (nodes.empty()) {
+        return;
+    }
+
+    m_workerCpus.resize(m_numThreads);
+    const std::uint32_t numNodes { static_cast<std::uint32_t>(nodes.size()) };
+    for (std::uint32_t workerIdx { 0U }; workerIdx < m_numThreads; ++workerIdx)
+    {
+        const std::uint32_t node { static_cast<std::uint32_t>((static_cast<std::uint64_t>(workerIdx) * numNodes) / m_numThreads) };
+        const std::uint32_t firstWorkerOfNode { static_cast<std::uint32_t>((static_cast<std::uint64_t>(node) * m_numThreads +
+                                                                            numNodes - 1U) / numNodes) };
+        m_workerNodes[workerIdx] = node;
+        m_workerCpus[workerIdx] = nodes[node][(workerIdx - firstWorkerOfNode) % nodes[node].size()];
+    }
+}
+
+void ThreadPool::runTask(const std::uint32_t taskIdx, const std::uint32_t workerIdx) noexcept
+{
+    const std::uint64_t start { utils_asm::readTsc() };
+    try
+    {
+        (*m_task)(taskIdx, workerIdx);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_exception) {
+            m_exception = std::current_exception();
+        }
+    }
+    m_counters[workerIdx].busyTicks += utils_asm::readTsc() - start;
+    ++m_counters[workerIdx].numTasks;
+}
+
+void ThreadPool::runTasks(const std::uint32_t workerIdx) noexcept
+{
+    if (m_schedule == Schedule::fixed) {
+        for (std::uint32_t taskIdx { workerIdx }; taskIdx < m_numTasks; taskIdx += m_numThreads)
+        {
+            runTask(taskIdx, workerIdx);
+        }
+    } else {
+        for (std::uint32_t taskIdx { m_nextTask.fetch_add(1U) }; taskIdx < m_numTasks; taskIdx = m_nextTask.fetch_add(1U))
+        {
+            runTask(taskIdx, workerIdx);
+        }
+    }
+}
+
+void ThreadPool::workerLoop(const std::uint32_t workerIdx)
+{
+    if (!m_workerCpus.empty()) {
+        pinCurrentThread(m_workerCpus[workerIdx]);
+    }
+
+    std::uint64_t lastGeneration { 0U };
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCondition.wait(lock, [&] { return m_shutdown || (m_jobGeneration != lastGeneration); });
+            if (m_shutdown) {
+                return;
+            }
+            lastGeneration = m_jobGeneration;
+        }
+
+        runTasks(workerIdx);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_numActive == 0U) {
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(const std::uint32_t numTasks, const Task &task, const Schedule schedule)
+{
+    const std::uint64_t start { utils_asm::readTsc() };
+    std::vector<std::uint64_t> busyBefore(m_numThreads);
+    for (std::uint32_t workerIdx { 0U }; workerIdx < m_numThreads; ++workerIdx)
+    {
+        busyBefore[workerIdx] = m_counters[workerIdx].busyTicks;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_numTasks = numTasks;
+        m_schedule = schedule;
+        m_nextTask.store(0U);
+        m_numActive = static_cast<std::uint32_t>(m_threads.size());
+        m_exception = nullptr;
+        ++m_jobGeneration;
+    }
+    m_jobCondition.notify_all();
+
+    if (!m_pinThreads) {
+        runTasks(0U);
+    }
+
+    std::exception_ptr exception { };
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [&] { return m_numActive == 0U; });
+        m_task = nullptr;
+        exception = m_exception;
+    }
+
+    const std::uint64_t jobTicks { utils_asm::readTsc() - start };
+    for (std::uint32_t workerIdx { 0U }; workerIdx < m_numThreads; ++workerIdx)
+    {
+        const std::uint64_t busy { m_counters[workerIdx].busyTicks - busyBefore[workerIdx] };
+        m_counters[workerIdx].idleTicks += (jobTicks > busy) ? (jobTicks - busy) : 0U;
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+std::pair<std::uint32_t, std::uint32_t> ThreadPool::getBand(const std::uint32_t numRows, const std::uint32_t numBands,
+                                                            const std::uint32_t bandIdx,
+                                                            const std::uint32_t alignment) noexcept
+{
+    const std::uint64_t numUnits { (static_cast<std::uint64_t>(numRows) + alignment - 1U) / alignment };
+    const std::uint64_t firstUnit { numUnits * bandIdx / numBands };
+    const std::uint64_t lastUnit { numUnits * (bandIdx + 1U) / numBands };
+    const std::uint32_t firstRow { static_cast<std::uint32_t>(std::min<std::uint64_t>(firstUnit * alignment, numRows)) };
+    const std::uint32_t lastRow { static_cast<std::uint32_t>(std::min<std::uint64_t>(lastUnit * alignment, numRows)) };
+
+    return { firstRow, lastRow };
+}
+
+} // namespace rgb2yuv
@@ -0,0 +1,206 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rgb2yuv
+{
+
+class ThreadPool
+{
+    public:
+        ///
+        /// @brief Per worker counters, padded to a cache line to avoid false sharing
+        ///
+        struct alignas(64) WorkerCounters
+        {
+            std::uint64_t busyTicks { 0U }; ///< TSC ticks spent executing tasks
+            std::uint64_t idleTicks { 0U }; ///< TSC ticks spent waiting within @ref ThreadPool::parallelFor
+            std::uint64_t numTasks { 0U }; ///< Number of tasks executed
+        };
+
+        ///
+        /// @brief Assignment of tasks to workers in @ref ThreadPool::parallelFor
+        ///
+        enum class Schedule : std::uint32_t
+        {
+            dynamic = 0U, ///< Workers claim the next unclaimed task, balancing uneven tasks
+            fixed ///< Task i is executed by worker i % @ref ThreadPool::getNumThreads
+        };
+
+        ///
+        /// @brief Signature of a task executed by @ref ThreadPool::parallelFor
+        ///
+        /// @param[in] taskIdx Index of the task in [0, numTasks)
+        /// @param[in] workerIdx Index of the worker executing the task in [0, @ref ThreadPool::getNumThreads)
+        ///
+        using Task = std::function<void(const std::uint32_t taskIdx, const std::uint32_t workerIdx)>;
+
+    private:
+        const std::uint32_t m_numThreads; ///< Number of workers
+        const bool m_pinThreads; ///< Specifies if workers are pinned to cores
+        std::vector<std::thread> m_threads { }; ///< Background workers
+        std::vector<WorkerCounters> m_counters; ///< Counters of each worker
+        std::vector<std::uint32_t> m_workerNodes; ///< NUMA node of each worker
+        std::vector<std::uint32_t> m_workerCpus; ///< CPU each worker is pinned to, if @ref ThreadPool::m_pinThreads
+        std::mutex m_mutex { }; ///< Protects the job state below
+        std::condition_variable m_jobCondition { }; ///< Signalled when a new job is posted or on shutdown
+        std::condition_variable m_doneCondition { }; ///< Signalled when the last worker finishes a job
+        const Task *m_task { nullptr }; ///< Task of the current job
+        std::uint32_t m_numTasks { 0U }; ///< Number of tasks in the current job
+        Schedule m_schedule { Schedule::dynamic }; ///< Schedule of the current job
+        std::atomic<std::uint32_t> m_nextTask { 0U }; ///< Next unclaimed task index of the current job
+        std::uint64_t m_jobGeneration { 0U }; ///< Incremented for every job posted
+        std::uint32_t m_numActive { 0U }; ///< Number of background workers still working on the current job
+        std::exception_ptr m_exception { }; ///< First exception thrown by a task of the current job
+        bool m_shutdown { false }; ///< Set by the destructor to stop the background workers
+
+        ///
+        /// @brief Main loop of a background worker
+        ///
+        /// @param[in] workerIdx Index of the worker
+        ///
+        void workerLoop(const std::uint32_t workerIdx);
+
+        ///
+        /// @brief Executes tasks of the current job according to @ref ThreadPool::m_schedule
+        ///
+        /// @param[in] workerIdx Index of the worker
+        ///
+        void runTasks(const std::uint32_t workerIdx) noexcept;
+
+        ///
+        /// @brief Executes a single task, recording its duration and any exception thrown
+        ///
+        void runTask(const std::uint32_t taskIdx, const std::uint32_t workerIdx) noexcept;
+
+        ///
+        /// @brief Assigns a NUMA node and CPU to every worker
+        ///
+        /// Design:
+        /// -# Read the CPUs of every online node from /sys/devices/system/node, restricted to the
+        ///    CPUs the process may run on. Fall back to a single node if sysfs is not available.
+        /// -# Assign contiguous ranges of workers to each node, so that neighbouring bands of an
+        ///    image are processed on the same node
+        /// -# Assign the workers of a node round-robin to the CPUs of the node
+        ///
+        void assignWorkers();
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// @param[in] numThreads Number of workers, clamped to at least 1
+        /// @param[in] pinThreads Pin each worker to a core of its NUMA node
+        ///
+        /// Design:
+        /// -# If @p pinThreads is set, invoke @ref ThreadPool::assignWorkers and spawn @p numThreads
+        ///    pinned background workers. The thread invoking @ref ThreadPool::parallelFor only waits,
+        ///    its affinity is left untouched.
+        /// -# Else spawn @p numThreads - 1 background workers. The thread invoking
+        ///    @ref ThreadPool::parallelFor acts as worker 0.
+        ///
+        explicit ThreadPool(const std::uint32_t numThreads, const bool pinThreads = false);
+
+        ///
+        /// @brief Sole destructor
+        ///
+        /// Design: Signal shutdown and join all background workers
+        ///
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ///
+        /// @brief Executes @p task for every task index in [0, @p numTasks) and waits for completion
+        ///
+        /// @param[in] numTasks Number of tasks to execute
+        /// @param[in] task Callable invoked once per task index
+        /// @param[in] schedule Assignment of tasks to workers
+        ///
+        /// @throws Rethrows the first exception thrown by @p task
+        ///
+        /// Design:
+        /// -# Post the job and wake the background workers
+        /// -# Unless workers are pinned, execute tasks on the calling thread as worker 0
+        /// -# Wait for the background workers to finish and account busy/idle ticks
+        ///
+        void parallelFor(const std::uint32_t numTasks, const Task &task, const Schedule schedule = Schedule::dynamic);
+
+        ///
+        /// @brief Returns the number of workers
+        ///
+        std::uint32_t getNumThreads() const noexcept
+        {
+            return m_numThreads;
+        }
+
+        ///
+        /// @brief Returns @true if workers are pinned to cores of their NUMA node
+        ///
+        bool isPinned() const noexcept
+        {
+            return m_pinThreads;
+        }
+
+        ///
+        /// @brief Returns the NUMA node of @p workerIdx (0 if workers are not pinned)
+        ///
+        std::uint32_t getNumaNode(const std::uint32_t workerIdx) const noexcept
+        {
+            return m_workerNodes[workerIdx];
+        }
+
+        ///
+        /// @brief Returns the counters of all workers
+        ///
+        const std::vector<WorkerCounters> &getCounters() const noexcept
+        {
+            return m_counters;
+        }
+
+        ///
+        /// @brief Splits @p numRows rows into @p numBands bands and returns band @p bandIdx
+        ///
+        /// @param[in] numRows Number of rows to split
+        /// @param[in] numBands Number of bands
+        /// @param[in] bandIdx Index of the band
+        /// @param[in] alignment Every band but the last starts and ends on a multiple of @p alignment rows
+        ///
+        /// @returns Pair of the first row and one past the last row of the band (empty if there are
+        ///          fewer aligned rows than bands)
+        ///
+        static std::pair<std::uint32_t, std::uint32_t> getBand(const std::uint32_t numRows, const std::uint32_t numBands,
+                                                               const std::uint32_t bandIdx,
+                                                               const std::uint32_t alignment) noexcept;
+};
+
+} // namespace rgb2yuv
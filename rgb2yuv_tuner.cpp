@@ -0,0 +1,322 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rgb2yuv_tuner.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "rgb2yuv_converter.hpp"
+#include "rgb2yuv_thread_pool.hpp"
+#include "rgb2yuv_utils_asm.hpp"
+
+namespace rgb2yuv
+{
+
+namespace
+{
+
+///
+/// @brief Returns the fastest of @ref Tuner::ct_numRepetitions runs of @p run in seconds
+///
+template<typename Run>
+double timeFastest(const Run &run)
+{
+    double ret { std::numeric_limits<double>::max() };
+    for (std::uint32_t repetition { 0U }; repetition < Tuner::ct_numRepetitions; ++repetition)
+    {
+        const std::chrono::steady_clock::time_point start { std::chrono::steady_clock::now() };
+        run();
+        ret = std::min(ret, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    return ret;
+}
+
+} // namespace
+
+std::string Tuner::getHostKey()
+{
+    std::array<std::uint32_t, utils_asm::ct_numCpuIdRegisters> regs { };
+    std::string brand { };
+
+    utils_asm::cpuId(0x80000000U, 0U, regs);
+    if (regs[utils_asm::ct_eax] >= 0x80000004U) {
+        for (std::uint32_t leaf { 0x80000002U }; leaf <= 0x80000004U; ++leaf)
+        {
+            utils_asm::cpuId(leaf, 0U, regs);
+            char chars[sizeof(regs)] { };
+            std::memcpy(chars, regs.data(), sizeof(regs));
+            brand.append(chars, strnlen(chars, sizeof(chars)));
+        }
+    }
+
+    std::string ret { };
+    for (const char c : brand)
+    {
+        if (std::isspace(static_cast<unsigned char>(c)) == 0) {
+            ret += c;
+        } else if (!ret.empty() && (ret.back() != '_')) {
+            ret += '_';
+        }
+    }
+
+    if (ret.empty() || (ret.back() != '_')) {
+        ret += '_';
+    }
+
+    return ret + std::to_string(std::max(1U, std::thread::hardware_concurrency()));
+}
+
+double Tuner::probeBandwidth(const std::uint32_t numThreads)
+{
+    ThreadPool threadPool(numThreads);
+    std::vector<std::uint8_t> src(ct_probeSize, 1U);
+    std::vector<std::uint8_t> dst(ct_probeSize, 0U);
+    const std::size_t chunkSize { ct_probeSize / threadPool.getNumThreads() };
+
+    const double seconds { timeFastest([&]()
+    {
+        threadPool.parallelFor(threadPool.getNumThreads(), [&](const std::uint32_t taskIdx, const std::uint32_t)
+        {
+            std::memcpy(dst.data() + taskIdx * chunkSize, src.data() + taskIdx * chunkSize, chunkSize);
+        }, ThreadPool::Schedule::fixed);
+    }) };
+
+    return (2.0 * static_cast<double>(ct_probeSize)) / (seconds * 1e6);
+}
+
+double Tuner::timeConversion(const std::uint32_t numThreads, const std::uint32_t bandRows,
+                             const std::size_t streamingThreshold) const
+{
+    const std::size_t srcStride { static_cast<std::size_t>(ct_calibrationWidth) *
+                                  Converter::getBytesPerPixel(m_inputColorFormat) };
+    std::vector<std::uint8_t> src(srcStride * ct_calibrationHeight);
+    std::uint32_t state { 0x12345678U };
+    for (std::uint8_t &value : src)
+    {
+        // Linear congruential generator, the kernels must not see a uniform image
+        state = state * 1664525U + 1013904223U;
+        value = static_cast<std::uint8_t>(state >> 24U);
+    }
+
+    ThreadPool threadPool(numThreads);
+    Converter converter(m_inputColorFormat, m_outputColorFormat, utils::ColorMatrix::bt601, m_simdTier, threadPool,
+                        streamingThreshold, 1U, utils::AlphaMode::drop, 0U, utils::ChromaFilter::box, bandRows);
+    converter.init();
+    converter.convert(src.data(), srcStride, ct_calibrationWidth, ct_calibrationHeight);
+
+    const double seconds { timeFastest([&]()
+    {
+        converter.convert(src.data(), srcStride, ct_calibrationWidth, ct_calibrationHeight);
+    }) };
+    converter.deinit();
+
+    return (static_cast<double>(ct_calibrationWidth) * ct_calibrationHeight) / (seconds * 1e6);
+}
+
+Tuner::Settings Tuner::calibrate() const
+{
+    Measurements measurements { };
+    measurements.maxThreads = std::max(1U, std::thread::hardware_concurrency());
+    measurements.probeBandwidth = probeBandwidth;
+    measurements.timeConversion = [this](const std::uint32_t numThreads, const std::uint32_t bandRows,
+                                         const std::size_t streamingThreshold)
+    {
+        return timeConversion(numThreads, bandRows, streamingThreshold);
+    };
+
+    return calibrate(measurements);
+}
+
+Tuner::Settings Tuner::calibrate(const Measurements &measurements) const
+{
+    std::vector<std::uint32_t> threadCounts { };
+    for (std::uint32_t numThreads { 1U }; numThreads < measurements.maxThreads; numThreads *= 2U)
+    {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(std::max(1U, measurements.maxThreads));
+
+    std::vector<double> bandwidths { };
+    for (const std::uint32_t numThreads : threadCounts)
+    {
+        bandwidths.push_back(measurements.probeBandwidth(numThreads));
+    }
+
+    const double peakBandwidth { *std::max_element(bandwidths.begin(), bandwidths.end()) };
+    std::size_t saturatedIdx { 0U };
+    while (bandwidths[saturatedIdx] < ct_saturation * peakBandwidth)
+    {
+        ++saturatedIdx;
+    }
+
+    // Workers beyond twice the saturating count only add contention
+    Settings ret { };
+    const std::size_t defaultThreshold { (m_lastLevelCacheSize != 0U) ? m_lastLevelCacheSize :
+                                                                        std::numeric_limits<std::size_t>::max() };
+    for (std::size_t idx { 0U }; idx < threadCounts.size(); ++idx)
+    {
+        if (threadCounts[idx] > 2U * threadCounts[saturatedIdx]) {
+            break;
+        }
+
+        const double mpixPerS { measurements.timeConversion(threadCounts[idx], 0U, defaultThreshold) };
+        if ((idx == 0U) || (mpixPerS > ct_minGain * ret.mpixPerS)) {
+            ret.numThreads = threadCounts[idx];
+            ret.bandwidth = bandwidths[idx];
+            ret.mpixPerS = mpixPerS;
+        }
+    }
+
+    const double regular { measurements.timeConversion(ret.numThreads, 0U, std::numeric_limits<std::size_t>::max()) };
+    const double streaming { measurements.timeConversion(ret.numThreads, 0U, 0U) };
+    if (streaming > regular) {
+        const std::size_t workingSet { static_cast<std::size_t>(ct_calibrationWidth) * ct_calibrationHeight *
+                                       Converter::getBytesPerPixel(m_inputColorFormat) };
+        ret.streamingThreshold = (m_lastLevelCacheSize != 0U) ? m_lastLevelCacheSize : workingSet;
+    } else {
+        ret.streamingThreshold = std::numeric_limits<std::size_t>::max();
+    }
+    ret.mpixPerS = std::max(regular, streaming);
+
+    for (const std::uint32_t bandRows : ct_bandRows)
+    {
+        if (bandRows == 0U) {
+            continue;
+        }
+
+        const double mpixPerS { measurements.timeConversion(ret.numThreads, bandRows, ret.streamingThreshold) };
+        if (mpixPerS > ct_minGain * ret.mpixPerS) {
+            ret.bandRows = bandRows;
+            ret.mpixPerS = mpixPerS;
+        }
+    }
+
+    return ret;
+}
+
+bool Tuner::load(Settings &settings) const
+{
+    std::ifstream stream(m_tuneFile);
+    const std::string hostKey { getHostKey() };
+    std::string line { };
+    while (std::getline(stream, line))
+    {
+        std::istringstream fields(line);
+        std::string key { };
+        std::uint32_t simdTier { 0U };
+        std::uint32_t inputColorFormat { 0U };
+        std::uint32_t outputColorFormat { 0U };
+        Settings candidate { };
+        if ((fields >> key >> simdTier >> inputColorFormat >> outputColorFormat >> candidate.numThreads >>
+             candidate.bandRows >> candidate.streamingThreshold >> candidate.bandwidth >> candidate.mpixPerS) &&
+            (key == hostKey) && (simdTier == static_cast<std::uint32_t>(m_simdTier)) &&
+            (inputColorFormat == static_cast<std::uint32_t>(m_inputColorFormat)) &&
+            (outputColorFormat == static_cast<std::uint32_t>(m_outputColorFormat)) && (candidate.numThreads != 0U)) {
+            settings = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Tuner::store(const Settings &settings) const noexcept
+{
+    try
+    {
+        const std::string hostKey { getHostKey() };
+        std::ostringstream entry { };
+        entry << hostKey << " " << static_cast<std::uint32_t>(m_simdTier) << " "
+              << static_cast<std::uint32_t>(m_inputColorFormat) << " " << static_cast<std::uint32_t>(m_outputColorFormat)
+              << " " << settings.numThreads << " " << settings.bandRows << " " << settings.streamingThreshold << " "
+              << settings.bandwidth << " " << settings.mpixPerS;
+        const std::string prefix { hostKey + " " + std::to_string(static_cast<std::uint32_t>(m_simdTier)) + " " +
+                                   std::to_string(static_cast<std::uint32_t>(m_inputColorFormat)) + " " +
+                                   std::to_string(static_cast<std::uint32_t>(m_outputColorFormat)) + " " };
+
+        std::string contents { "# host simd input output threads bandRows streamingThreshold MB/s Mpixel/s\n" };
+        std::ifstream previous(m_tuneFile);
+        std::string line { };
+        while (std::getline(previous, line))
+        {
+            if (!line.empty() && (line.front() != '#') && (line.compare(0U, prefix.size(), prefix) != 0)) {
+                contents += line + "\n";
+            }
+        }
+        contents += entry.str() + "\n";
+
+        const std::filesystem::path tuneFile { m_tuneFile };
+        std::error_code error { };
+        if (tuneFile.has_parent_path()) {
+            std::filesystem::create_directories(tuneFile.parent_path(), error);
+        }
+
+        const std::string temporaryFile { m_tuneFile + ".tmp" };
+        std::ofstream(temporaryFile, std::ios::out | std::ios::trunc) << contents;
+        std::filesystem::rename(temporaryFile, tuneFile, error);
+    }
+    catch (...)
+    {
+        // The next run calibrates again
+    }
+}
+
+Tuner::Settings Tuner::getSettings() const
+{
+    Settings ret { };
+    if (!m_tuneFile.empty() && load(ret)) {
+        return ret;
+    }
+
+    ret = calibrate();
+    if (!m_tuneFile.empty()) {
+        store(ret);
+    }
+
+    return ret;
+}
+
+std::string Tuner::getDefaultTuneFile()
+{
+    const char *cacheHome { std::getenv("XDG_CACHE_HOME") };
+    if ((cacheHome != nullptr) && (*cacheHome != '\0')) {
+        return (std::filesystem::path(cacheHome) / "rgb2yuv_tune.txt").string();
+    }
+
+    const char *home { std::getenv("HOME") };
+    if ((home != nullptr) && (*home != '\0')) {
+        return (std::filesystem::path(home) / ".cache" / "rgb2yuv_tune.txt").string();
+    }
+
+    return { };
+}
+
+} // namespace rgb2yuv
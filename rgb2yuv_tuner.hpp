@@ -0,0 +1,187 @@
+// Copyright (c) 2024 Sruthik P
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "rgb2yuv_utils.hpp"
+
+namespace rgb2yuv
+{
+
+///
+/// @brief Selects the number of workers, the band height and the store type that convert fastest on this host
+///
+/// Colour conversion is bound by memory bandwidth long before it runs out of cores, so one worker per logical
+/// processor oversubscribes the memory channels and the siblings of every core. The calibration measures, rather
+/// than guesses, and is cached per host, SIMD tier and conversion in a text file, so it runs once per machine.
+///
+class Tuner
+{
+    public:
+        ///
+        /// @brief Conversion settings selected by @ref Tuner::calibrate
+        ///
+        struct Settings
+        {
+            std::uint32_t numThreads { 1U }; ///< Number of workers of the @ref rgb2yuv::ThreadPool
+            std::uint32_t bandRows { 0U }; ///< Rows per band of @ref rgb2yuv::Converter::convert, 0 for the default
+            std::size_t streamingThreshold { 0U }; ///< Working set size in bytes from which non-temporal stores are used
+            double bandwidth { 0.0 }; ///< Copy bandwidth in MB/s of @ref Settings::numThreads workers
+            double mpixPerS { 0.0 }; ///< Conversion throughput in Mpixel/s with these settings
+        };
+
+        ///
+        /// @brief Measurements @ref Tuner::calibrate selects the settings from, replaced by fixed timings in tests
+        ///
+        struct Measurements
+        {
+            using ProbeBandwidthFn = std::function<double(const std::uint32_t numThreads)>;
+            using TimeConversionFn = std::function<double(const std::uint32_t numThreads, const std::uint32_t bandRows,
+                                                          const std::size_t streamingThreshold)>;
+
+            std::uint32_t maxThreads { 1U }; ///< Number of logical processors, the most workers tried
+            ProbeBandwidthFn probeBandwidth { }; ///< Returns the copy bandwidth in MB/s of a number of workers
+            TimeConversionFn timeConversion { }; ///< Returns the conversion throughput in Mpixel/s of the settings
+        };
+
+        static constexpr std::uint32_t ct_calibrationWidth { 1920U }; ///< Width in pixels of the calibration image
+        static constexpr std::uint32_t ct_calibrationHeight { 1088U }; ///< Height in pixels of the calibration image
+        static constexpr std::uint32_t ct_numRepetitions { 3U }; ///< Timed runs per measurement, the fastest is kept
+        static constexpr std::size_t ct_probeSize { static_cast<std::size_t>(32U) << 20U }; ///< Bytes copied by the bandwidth probe
+        static constexpr double ct_saturation { 0.9 }; ///< Fraction of the peak bandwidth considered saturated
+        static constexpr double ct_minGain { 1.03 }; ///< Speedup required to prefer more workers or a non default setting
+        static constexpr std::array<std::uint32_t, 4U> ct_bandRows { 0U, 16U, 64U, 256U }; ///< Band heights tried
+
+    private:
+        const std::string m_tuneFile; ///< File caching the calibrations, empty to calibrate every time
+        const utils::SimdTier m_simdTier; ///< SIMD tier of the conversion
+        const utils::ColorFormat m_inputColorFormat; ///< Input format of the conversion
+        const utils::ColorFormat m_outputColorFormat; ///< Output format of the conversion
+        const std::size_t m_lastLevelCacheSize; ///< Size of the highest level cache, 0 if unknown
+
+        ///
+        /// @brief Returns the copy bandwidth in MB/s of @p numThreads workers
+        ///
+        /// Design: Every worker copies its share of two @ref Tuner::ct_probeSize buffers. Count the bytes read
+        ///         and written by the fastest of @ref Tuner::ct_numRepetitions runs.
+        ///
+        static double probeBandwidth(const std::uint32_t numThreads);
+
+        ///
+        /// @brief Returns the throughput in Mpixel/s of the conversion with the given settings
+        ///
+        /// Design: Convert a pseudo random @ref Tuner::ct_calibrationWidth x @ref Tuner::ct_calibrationHeight image
+        ///         once to fault in the output, then keep the fastest of @ref Tuner::ct_numRepetitions conversions
+        ///
+        double timeConversion(const std::uint32_t numThreads, const std::uint32_t bandRows,
+                              const std::size_t streamingThreshold) const;
+
+    public:
+        ///
+        /// @brief Sole parameterized constructor
+        ///
+        /// Design: Assign the input parameters to the members of the same name
+        ///
+        Tuner(const std::string &tuneFile, const utils::SimdTier simdTier, const utils::ColorFormat inputColorFormat,
+              const utils::ColorFormat outputColorFormat, const std::size_t lastLevelCacheSize) :
+              m_tuneFile(tuneFile),
+              m_simdTier(simdTier),
+              m_inputColorFormat(inputColorFormat),
+              m_outputColorFormat(outputColorFormat),
+              m_lastLevelCacheSize(lastLevelCacheSize)
+        {
+        }
+
+        ///
+        /// @brief Measures the fastest settings of the conversion on this host
+        ///
+        /// @throws std::invalid_argument if the conversion is not supported by @ref rgb2yuv::Converter
+        ///
+        /// Design: Invoke @ref Tuner::calibrate with one worker per logical processor at most,
+        ///         @ref Tuner::probeBandwidth and @ref Tuner::timeConversion
+        ///
+        /// @returns The selected settings
+        ///
+        Settings calibrate() const;
+
+        ///
+        /// @brief Selects the fastest settings of the conversion from @p measurements
+        ///
+        /// Design:
+        /// -# Probe the bandwidth of 1, 2, 4, ... workers and of @ref Measurements::maxThreads workers. The fewest
+        ///    workers reaching @ref Tuner::ct_saturation of the peak saturate the memory.
+        /// -# Time the conversion with each of these worker counts up to twice the saturating one, keeping more
+        ///    workers only if they are @ref Tuner::ct_minGain faster
+        /// -# Time regular against non-temporal stores. If the latter win, stream working sets from the size of
+        ///    the highest level cache, or of the calibration image if unknown, else never stream.
+        /// -# Time every band height of @ref Tuner::ct_bandRows, keeping a non default one only if it is
+        ///    @ref Tuner::ct_minGain faster
+        ///
+        /// @returns The selected settings
+        ///
+        Settings calibrate(const Measurements &measurements) const;
+
+        ///
+        /// @brief Looks up the calibration of this host and conversion in @ref Tuner::m_tuneFile
+        ///
+        /// Design: Skip lines that do not parse, such as comments, and those of other hosts or conversions
+        ///
+        /// @returns @true and sets @p settings if found, else @false
+        ///
+        bool load(Settings &settings) const;
+
+        ///
+        /// @brief Adds @p settings to @ref Tuner::m_tuneFile, replacing an older calibration of the same key
+        ///
+        /// Design: Rewrite the file to a temporary file renamed over it. Failures are ignored, the settings
+        ///         are then calibrated again next time.
+        ///
+        void store(const Settings &settings) const noexcept;
+
+        ///
+        /// @brief Returns the cached settings of this host and conversion, calibrating them if there are none
+        ///
+        /// Design: Invoke @ref Tuner::load, else invoke @ref Tuner::calibrate and @ref Tuner::store
+        ///
+        Settings getSettings() const;
+
+        ///
+        /// @brief Returns the default path of the calibration cache
+        ///
+        /// Design: $XDG_CACHE_HOME/rgb2yuv_tune.txt, else $HOME/.cache/rgb2yuv_tune.txt, else empty
+        ///
+        static std::string getDefaultTuneFile();
+
+        ///
+        /// @brief Returns the key identifying this host in @ref Tuner::m_tuneFile
+        ///
+        /// Design: The processor brand string from CPUID leaves 0x80000002 to 0x80000004 with whitespace replaced
+        ///         by '_', followed by the number of logical processors
+        ///
+        static std::string getHostKey();
+};
+
+} // namespace rgb2yuv
@@ -20,7 +20,14 @@
 
 #include "rgb2yuv_utils.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 namespace rgb2yuv
 {
@@ -38,7 +45,7 @@ void InputParser::printHelpMessage() noexcept
     std::cout << "                    NOTE: Not all file formats may be supported for input file\n";
     std::cout << "-inputColorFormat:  Format of the color data in the input file\n";
     std::cout << "                    Valid values: rgb888, rgba8888, uyvy, yuv420_nv12, yuv444_packed,\n";
-    std::cout << "                                  yuv444_planar, yuyv\n";
+    std::cout << "                                  yuv444_planar, yuyv, rgb161616, yuv420_p010, yuv420_p016\n";
     std::cout << "                    NOTE: Not all color formats may be supported for input file\n";
     std::cout << "-outputFile :       Output file containing the converted YUV data\n";
     std::cout << "-outputFileFormat:  Format of the output file\n";
@@ -46,15 +53,86 @@ void InputParser::printHelpMessage() noexcept
     std::cout << "                    NOTE: Not all file formats may be supported for output file\n";
     std::cout << "-outputColorFormat: Format of the color data in the input file\n";
     std::cout << "                    Valid values: rgb888, rgba8888, uyvy, yuv420_nv12, yuv444_packed,\n";
-    std::cout << "                                  yuv444_planar, yuyv\n";
+    std::cout << "                                  yuv444_planar, yuyv, rgb161616, yuv420_p010, yuv420_p016\n";
     std::cout << "                    NOTE: Not all color formats may be supported for output file\n";
     std::cout << "\nOptional input arguments:\n\n";
+    std::cout << "-colorMatrix:       Matrix used for the RGB to YUV conversion\n";
+    std::cout << "                    Valid values: bt601, bt709, bt601_full\n";
+    std::cout << "                    Default: bt601\n";
+    std::cout << "-width:             Width of the image in pixels. Mandatory for raw input files\n";
+    std::cout << "-height:            Height of the image in pixels. Mandatory for raw input files\n";
     std::cout << "-j:                 Number of threads to use for the conversion process\n";
-    std::cout << "                    Default: Number of logical processors present\n";
+    std::cout << "                    Default: Number of logical processors present, or as calibrated by -autoTune\n";
     std::cout << "-disableSimd:       Disable any form of SIMD usage during the conversion process\n";
+    std::cout << "-numaAware:         Pin threads to cores of their NUMA node and first-touch every band of the\n";
+    std::cout << "                    image on the thread converting it\n";
+    std::cout << "-hugePages:         Back frame buffers of 2 MiB and more with huge pages and prefault them. Falls\n";
+    std::cout << "                    back to transparent huge pages, or regular pages, if none are reserved\n";
+    std::cout << "-sequence:          The raw input file holds a sequence of frames. Only tiles that changed since\n";
+    std::cout << "                    the previous frame are reconverted. Frames are written one after another\n";
+    std::cout << "-pyramidLevels:     Number of resolution levels to write for yuv420_nv12 output, each half the size\n";
+    std::cout << "                    of the previous one. Level k is written to <outputFile stem>_L<k><extension>\n";
+    std::cout << "                    Default: 1\n";
+    std::cout << "-stats:             Print per-stage timing and throughput statistics on stderr\n";
+    std::cout << "-statsFormat:       Format of the statistics printed with -stats\n";
+    std::cout << "                    Valid values: text, json\n";
+    std::cout << "                    Default: text\n";
+    std::cout << "-cacheDir:          Directory of an on-disk cache of converted outputs. Inputs converted before\n";
+    std::cout << "                    with the same arguments are linked from the cache instead of converted\n";
+    std::cout << "-cacheSize:         Maximum size of the cache in MiB, least recently used outputs are evicted\n";
+    std::cout << "                    Default: 1024\n";
+    std::cout << "-alpha:             Handling of the alpha component of rgba8888 input, within the conversion pass\n";
+    std::cout << "                    Valid values: drop, composite (over -background), plane (appended after the\n";
+    std::cout << "                    YUV data as a full resolution plane)\n";
+    std::cout << "                    Default: drop\n";
+    std::cout << "-background:        Background color RRGGBB (hexadecimal) for -alpha composite. 000000 premultiplies\n";
+    std::cout << "                    Default: 000000\n";
+    std::cout << "-chromaFilter:      Filter subsampling chroma for uyvy, yuyv and yuv420 outputs, within the\n";
+    std::cout << "                    conversion pass\n";
+    std::cout << "                    Valid values: box (centered), cosited ([1 2 1], MPEG-2/H.264 siting),\n";
+    std::cout << "                    lanczos (Lanczos-2, MPEG-2/H.264 siting)\n";
+    std::cout << "                    Default: box\n";
+    std::cout << "-batch:             Convert many files through a shared pool of workers, reading the next files\n";
+    std::cout << "                    ahead while the current ones convert. Replaces -inputFile and -outputFile.\n";
+    std::cout << "                    Either a glob of input files (e.g. frames/*.ppm), written to -outputDir in\n";
+    std::cout << "                    -outputColorFormat and -outputFileFormat, or a manifest file with one input\n";
+    std::cout << "                    per line followed by one or more '<outputFile> <outputColorFormat>\n";
+    std::cout << "                    <outputFileFormat>' triples, all written from a single decode\n";
+    std::cout << "-outputDir:         Directory of the outputs of a glob -batch, named <input stem>.yuv (.h for c_header)\n";
+    std::cout << "-metricsFile:       Write frame, byte, SIMD tier and stage latency metrics to this file in the\n";
+    std::cout << "                    Prometheus text format (e.g. for the node_exporter textfile collector).\n";
+    std::cout << "                    Written once the conversion completes, and every second during a -batch\n";
+    std::cout << "-autoTune:          Calibrate the number of threads, band height and store type that convert fastest\n";
+    std::cout << "                    on this host (memory bandwidth probe and kernel timing, about a second) and\n";
+    std::cout << "                    cache the result in -tuneFile. An explicit -j still sets the number of threads\n";
+    std::cout << "-tuneFile:          File caching the -autoTune calibrations, one line per host and conversion\n";
+    std::cout << "                    Default: $XDG_CACHE_HOME/rgb2yuv_tune.txt or $HOME/.cache/rgb2yuv_tune.txt\n";
     std::cout << "-help:              Print this help message\n";
 }
 
+const char *toString(const SimdTier simdTier) noexcept
+{
+    const char *ret { "scalar" };
+
+    switch (simdTier)
+    {
+        case(SimdTier::sse4_1):
+            ret = "sse4_1";
+            break;
+        case(SimdTier::avx2):
+            ret = "avx2";
+            break;
+        case(SimdTier::avx512):
+            ret = "avx512";
+            break;
+        default:
+            // Do nothing
+            break;
+    }
+
+    return ret;
+}
+
 ColorFormat InputParser::toColorFormat(const std::string &inputString) noexcept
 {
     ColorFormat ret { };
@@ -75,6 +153,12 @@ ColorFormat InputParser::toColorFormat(const std::string &inputString) noexcept
         ret = ColorFormat::yuv444_planar;
     } else if (inputString == "yuyv") {
         ret = ColorFormat::yuyv;
+    } else if (inputString == "rgb161616") {
+        ret = ColorFormat::rgb161616;
+    } else if (inputString == "yuv420_p010") {
+        ret = ColorFormat::yuv420_p010;
+    } else if (inputString == "yuv420_p016") {
+        ret = ColorFormat::yuv420_p016;
     } else {
         ret = ColorFormat::unrecognized;
     }
@@ -101,6 +185,72 @@ FileFormat InputParser::toFileFormat(const std::string &inputString) noexcept
     return ret;
 }
 
+StatsFormat InputParser::toStatsFormat(const std::string &inputString) noexcept
+{
+    StatsFormat ret { };
+
+    if (inputString == "text") {
+        ret = StatsFormat::text;
+    } else if (inputString == "json") {
+        ret = StatsFormat::json;
+    } else {
+        ret = StatsFormat::unrecognized;
+    }
+
+    return ret;
+}
+
+AlphaMode InputParser::toAlphaMode(const std::string &inputString) noexcept
+{
+    AlphaMode ret { };
+
+    if (inputString == "drop") {
+        ret = AlphaMode::drop;
+    } else if (inputString == "composite") {
+        ret = AlphaMode::composite;
+    } else if (inputString == "plane") {
+        ret = AlphaMode::plane;
+    } else {
+        ret = AlphaMode::unrecognized;
+    }
+
+    return ret;
+}
+
+ChromaFilter InputParser::toChromaFilter(const std::string &inputString) noexcept
+{
+    ChromaFilter ret { };
+
+    if (inputString == "box") {
+        ret = ChromaFilter::box;
+    } else if (inputString == "cosited") {
+        ret = ChromaFilter::cosited;
+    } else if (inputString == "lanczos") {
+        ret = ChromaFilter::lanczos;
+    } else {
+        ret = ChromaFilter::unrecognized;
+    }
+
+    return ret;
+}
+
+ColorMatrix InputParser::toColorMatrix(const std::string &inputString) noexcept
+{
+    ColorMatrix ret { };
+
+    if (inputString == "bt601") {
+        ret = ColorMatrix::bt601;
+    } else if (inputString == "bt709") {
+        ret = ColorMatrix::bt709;
+    } else if (inputString == "bt601_full") {
+        ret = ColorMatrix::bt601_full;
+    } else {
+        ret = ColorMatrix::unrecognized;
+    }
+
+    return ret;
+}
+
 utils::InputArguments InputParser::parseArgs(const std::int32_t argc, char **argv)
 {
     utils::InputArguments ret { };
@@ -121,10 +271,48 @@ utils::InputArguments InputParser::parseArgs(const std::int32_t argc, char **arg
             ret.outputColorFormat = toColorFormat(std::string(argv[++idx]));
         } else if (!strcmp(argv[idx], "-outputFileFormat") && (idx != argc - 1U)) {
             ret.outputFileFormat = toFileFormat(std::string(argv[++idx]));
+        } else if (!strcmp(argv[idx], "-colorMatrix") && (idx != argc - 1U)) {
+            ret.colorMatrix = toColorMatrix(std::string(argv[++idx]));
+        } else if (!strcmp(argv[idx], "-width") && (idx != argc - 1U)) {
+            ret.width = strtol(argv[++idx], nullptr, 10U);
+        } else if (!strcmp(argv[idx], "-height") && (idx != argc - 1U)) {
+            ret.height = strtol(argv[++idx], nullptr, 10U);
         } else if (!strcmp(argv[idx], "-j") && (idx != argc - 1U)){
             ret.numThreads = strtol(argv[++idx], nullptr, 10U);
         } else if (!strcmp(argv[idx], "-disableSimd")) {
             ret.disableSimd = true;
+        } else if (!strcmp(argv[idx], "-numaAware")) {
+            ret.numaAware = true;
+        } else if (!strcmp(argv[idx], "-hugePages")) {
+            ret.hugePages = true;
+        } else if (!strcmp(argv[idx], "-sequence")) {
+            ret.sequence = true;
+        } else if (!strcmp(argv[idx], "-pyramidLevels") && (idx != argc - 1U)) {
+            ret.pyramidLevels = strtol(argv[++idx], nullptr, 10U);
+        } else if (!strcmp(argv[idx], "-stats")) {
+            ret.enableStats = true;
+        } else if (!strcmp(argv[idx], "-statsFormat") && (idx != argc - 1U)) {
+            ret.statsFormat = toStatsFormat(std::string(argv[++idx]));
+        } else if (!strcmp(argv[idx], "-cacheDir") && (idx != argc - 1U)) {
+            ret.cacheDir = argv[++idx];
+        } else if (!strcmp(argv[idx], "-cacheSize") && (idx != argc - 1U)) {
+            ret.cacheSizeLimit = static_cast<std::uint64_t>(strtoull(argv[++idx], nullptr, 10U)) << 20U;
+        } else if (!strcmp(argv[idx], "-alpha") && (idx != argc - 1U)) {
+            ret.alphaMode = toAlphaMode(std::string(argv[++idx]));
+        } else if (!strcmp(argv[idx], "-background") && (idx != argc - 1U)) {
+            ret.background = static_cast<std::uint32_t>(strtoul(argv[++idx], nullptr, 16U));
+        } else if (!strcmp(argv[idx], "-chromaFilter") && (idx != argc - 1U)) {
+            ret.chromaFilter = toChromaFilter(std::string(argv[++idx]));
+        } else if (!strcmp(argv[idx], "-batch") && (idx != argc - 1U)) {
+            ret.batch = argv[++idx];
+        } else if (!strcmp(argv[idx], "-outputDir") && (idx != argc - 1U)) {
+            ret.outputDir = argv[++idx];
+        } else if (!strcmp(argv[idx], "-metricsFile") && (idx != argc - 1U)) {
+            ret.metricsFile = argv[++idx];
+        } else if (!strcmp(argv[idx], "-autoTune")) {
+            ret.autoTune = true;
+        } else if (!strcmp(argv[idx], "-tuneFile") && (idx != argc - 1U)) {
+            ret.tuneFile = argv[++idx];
         } else {
             throw std::invalid_argument("Unrecognized argument specified! Run with '-help' to see the list of accepted arguments.");
         }
@@ -135,7 +323,26 @@ utils::InputArguments InputParser::parseArgs(const std::int32_t argc, char **arg
 
 void InputParser::verifyArgs(const utils::InputArguments &args)
 {
-    if (args.inputFile.empty()) {
+    const bool isBatch { !args.batch.empty() };
+    const bool isManifest { isBatch && !isGlob(args.batch) };
+
+    if (isBatch) {
+        if (!args.inputFile.empty() || !args.outputFile.empty()) {
+            throw std::invalid_argument("Input and output files cannot be combined with a batch");
+        }
+
+        if (args.sequence || !args.cacheDir.empty()) {
+            throw std::invalid_argument("Batches cannot be combined with frame sequences or the conversion cache");
+        }
+
+        if (!isManifest && args.outputDir.empty()) {
+            throw std::invalid_argument("No output directory specified for the batch glob!");
+        }
+
+        if (args.autoTune) {
+            throw std::invalid_argument("Auto-tuning applies to single conversions, not to batches");
+        }
+    } else if (args.inputFile.empty()) {
         throw std::invalid_argument("No input file specified!");
     }
 
@@ -155,25 +362,209 @@ void InputParser::verifyArgs(const utils::InputArguments &args)
         throw std::invalid_argument("No input file format specified");
     }
 
-    if (args.outputFile.empty()) {
+    if (!isBatch && args.outputFile.empty()) {
         throw std::invalid_argument("No output file specified!");
     }
 
-    if (args.outputColorFormat == ColorFormat::unrecognized) {
-        throw std::invalid_argument("Unrecognized output color format specified");
+    // The outputs of a manifest carry their own formats, checked by parseManifest
+    if (!isManifest) {
+        if (args.outputColorFormat == ColorFormat::unrecognized) {
+            throw std::invalid_argument("Unrecognized output color format specified");
+        }
+
+        if (args.outputColorFormat == ColorFormat::unspecified) {
+            throw std::invalid_argument("No output color format specified!");
+        }
+
+        if (args.outputFileFormat == FileFormat::unrecognized) {
+            throw std::invalid_argument("Unrecognized output file format specified");
+        }
+
+        if (args.outputFileFormat == FileFormat::unspecified) {
+            throw std::invalid_argument("No output file format specified");
+        }
+    }
+
+    if (args.colorMatrix == ColorMatrix::unrecognized) {
+        throw std::invalid_argument("Unrecognized color matrix specified");
+    }
+
+    if ((args.inputFileFormat == FileFormat::raw) && ((args.width == 0U) || (args.height == 0U))) {
+        throw std::invalid_argument("Width and height must be specified for raw input files");
+    }
+
+    if (args.sequence && ((args.inputFileFormat != FileFormat::raw) || (args.outputFileFormat != FileFormat::raw))) {
+        throw std::invalid_argument("Frame sequences require raw input and output files");
+    }
+
+    if ((args.pyramidLevels > 1U) && !isManifest && (args.outputColorFormat != ColorFormat::yuv420_nv12)) {
+        throw std::invalid_argument("Pyramids require yuv420_nv12 output");
     }
 
-    if (args.outputColorFormat == ColorFormat::unspecified) {
-        throw std::invalid_argument("No output color format specified!");
+    if ((args.pyramidLevels > 1U) && (args.sequence || !args.cacheDir.empty())) {
+        throw std::invalid_argument("Pyramids cannot be combined with frame sequences or the conversion cache");
     }
 
-    if (args.outputFileFormat == FileFormat::unrecognized) {
-        throw std::invalid_argument("Unrecognized output file format specified");
+    if (args.statsFormat == StatsFormat::unrecognized) {
+        throw std::invalid_argument("Unrecognized statistics format specified");
     }
 
-    if (args.outputFileFormat == FileFormat::unspecified) {
-        throw std::invalid_argument("No output file format specified");
+    if (args.alphaMode == AlphaMode::unrecognized) {
+        throw std::invalid_argument("Unrecognized alpha mode specified");
     }
+
+    if ((args.alphaMode != AlphaMode::drop) && (args.inputColorFormat != ColorFormat::rgba8888)) {
+        throw std::invalid_argument("Alpha modes other than drop require rgba8888 input");
+    }
+
+    if ((args.alphaMode == AlphaMode::plane) && (args.pyramidLevels > 1U)) {
+        throw std::invalid_argument("Alpha planes cannot be combined with pyramids");
+    }
+
+    if (args.background > 0xFFFFFFU) {
+        throw std::invalid_argument("Background color must be specified as RRGGBB");
+    }
+
+    if (args.chromaFilter == ChromaFilter::unrecognized) {
+        throw std::invalid_argument("Unrecognized chroma filter specified");
+    }
+
+    if ((args.chromaFilter != ChromaFilter::box) && (args.pyramidLevels > 1U)) {
+        throw std::invalid_argument("Chroma filters other than box cannot be combined with pyramids");
+    }
+}
+
+bool InputParser::isGlob(const std::string &batch) noexcept
+{
+    return batch.find_first_of("*?") != std::string::npos;
+}
+
+bool InputParser::matchesGlob(const std::string &name, const std::string &pattern) noexcept
+{
+    std::size_t nameIdx { 0U };
+    std::size_t patternIdx { 0U };
+    std::size_t starIdx { std::string::npos };
+    std::size_t starNameIdx { 0U };
+
+    while (nameIdx < name.size())
+    {
+        if ((patternIdx < pattern.size()) && ((pattern[patternIdx] == '?') || (pattern[patternIdx] == name[nameIdx]))) {
+            ++nameIdx;
+            ++patternIdx;
+        } else if ((patternIdx < pattern.size()) && (pattern[patternIdx] == '*')) {
+            starIdx = patternIdx++;
+            starNameIdx = nameIdx;
+        } else if (starIdx != std::string::npos) {
+            // Let the last '*' swallow one more character and retry
+            patternIdx = starIdx + 1U;
+            nameIdx = ++starNameIdx;
+        } else {
+            return false;
+        }
+    }
+
+    while ((patternIdx < pattern.size()) && (pattern[patternIdx] == '*'))
+    {
+        ++patternIdx;
+    }
+
+    return patternIdx == pattern.size();
+}
+
+std::vector<BatchEntry> InputParser::expandGlob(const utils::InputArguments &args)
+{
+    const std::filesystem::path glob { args.batch };
+    const std::filesystem::path directory { glob.has_parent_path() ? glob.parent_path() : std::filesystem::path(".") };
+    const std::string pattern { glob.filename().string() };
+    if (isGlob(glob.parent_path().string())) {
+        throw std::invalid_argument("Wildcards are only supported in the file name of a batch glob");
+    }
+
+    std::vector<std::filesystem::path> inputFiles { };
+    std::error_code errorCode { };
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory, errorCode))
+    {
+        if (entry.is_regular_file() && matchesGlob(entry.path().filename().string(), pattern)) {
+            inputFiles.push_back(glob.has_parent_path() ? entry.path() : entry.path().filename());
+        }
+    }
+
+    if (errorCode) {
+        throw std::invalid_argument("Failed to list the directory of the batch glob");
+    }
+
+    if (inputFiles.empty()) {
+        throw std::invalid_argument("No input files match the batch glob");
+    }
+
+    std::sort(inputFiles.begin(), inputFiles.end());
+    const char *extension { (args.outputFileFormat == FileFormat::c_header) ? ".h" : ".yuv" };
+    std::vector<BatchEntry> ret { };
+    ret.reserve(inputFiles.size());
+    for (const std::filesystem::path &inputFile : inputFiles)
+    {
+        const std::filesystem::path outputFile { std::filesystem::path(args.outputDir) /
+                                                 (inputFile.stem().string() + extension) };
+        ret.push_back({ inputFile.string(), { { outputFile.string(), args.outputColorFormat, args.outputFileFormat } } });
+    }
+
+    return ret;
+}
+
+std::vector<BatchEntry> InputParser::parseManifest(const utils::InputArguments &args)
+{
+    std::ifstream manifest(args.batch);
+    if (!manifest.is_open()) {
+        throw std::invalid_argument("Failed to open batch manifest");
+    }
+
+    std::vector<BatchEntry> ret { };
+    std::string line { };
+    for (std::uint32_t lineIdx { 1U }; std::getline(manifest, line); ++lineIdx)
+    {
+        std::istringstream fields(line);
+        BatchEntry entry { };
+        if (!(fields >> entry.inputFile) || (entry.inputFile.front() == '#')) {
+            continue;
+        }
+
+        std::string outputFile { };
+        std::string outputColorFormat { };
+        std::string outputFileFormat { };
+        while (fields >> outputFile)
+        {
+            if (!(fields >> outputColorFormat >> outputFileFormat)) {
+                throw std::invalid_argument("Incomplete output in line " + std::to_string(lineIdx) +
+                                            " of the batch manifest");
+            }
+
+            const OutputSpec output { outputFile, toColorFormat(outputColorFormat), toFileFormat(outputFileFormat) };
+            if ((output.outputColorFormat == ColorFormat::unrecognized) ||
+                (output.outputFileFormat == FileFormat::unrecognized)) {
+                throw std::invalid_argument("Unrecognized output format in line " + std::to_string(lineIdx) +
+                                            " of the batch manifest");
+            }
+
+            entry.outputs.push_back(output);
+        }
+
+        if (entry.outputs.empty()) {
+            throw std::invalid_argument("No outputs in line " + std::to_string(lineIdx) + " of the batch manifest");
+        }
+
+        ret.push_back(std::move(entry));
+    }
+
+    if (ret.empty()) {
+        throw std::invalid_argument("Batch manifest lists no input files");
+    }
+
+    return ret;
+}
+
+std::vector<BatchEntry> InputParser::parseBatch(const utils::InputArguments &args)
+{
+    return isGlob(args.batch) ? expandGlob(args) : parseManifest(args);
 }
 
 utils::InputArguments InputParser::parseAndVerifyArgs(std::int32_t argc, char **argv)
@@ -22,6 +22,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace rgb2yuv
 {
@@ -42,6 +43,9 @@ enum class ColorFormat : std::uint32_t
     yuv444_packed, ///< Packed YUV444
     yuv444_planar, ///< Triple plane YUV444
     yuyv, ///< Packed YUYV
+    rgb161616, ///< 48bit RGB with 16 native endian bits for each of R, G, B and no alpha component
+    yuv420_p010, ///< Semi-planar YUV420 with 10 significant bits in the MSBs of 16bit little endian samples
+    yuv420_p016, ///< Semi-planar YUV420 with 16bit little endian samples
     unrecognized, ///< Unrecognized format
     last = unrecognized
 };
@@ -59,6 +63,74 @@ enum class FileFormat : std::uint32_t
     last = unrecognized
 };
 
+///
+/// @brief Supported RGB to YUV conversion matrices
+///
+enum class ColorMatrix : std::uint32_t
+{
+    bt601 = 0U, ///< ITU-R BT.601, limited range (default)
+    bt709, ///< ITU-R BT.709, limited range
+    bt601_full, ///< ITU-R BT.601, full range (JPEG)
+    unrecognized, ///< Unrecognized color matrix
+    last = unrecognized
+};
+
+///
+/// @brief Handling of the alpha component of @ref ColorFormat::rgba8888 input
+///
+enum class AlphaMode : std::uint32_t
+{
+    drop = 0U, ///< Ignore alpha and convert the color as is (default)
+    composite, ///< Composite the color over a background color. A black background yields premultiplied color.
+    plane, ///< Convert the color as is and append alpha as a full resolution plane after the YUV data
+    unrecognized, ///< Unrecognized alpha mode
+    last = unrecognized
+};
+
+///
+/// @brief Filters used to subsample chroma for 4:2:2 and 4:2:0 outputs
+///
+enum class ChromaFilter : std::uint32_t
+{
+    box = 0U, ///< Average of every 2 (4:2:2) or 2x2 (4:2:0) samples, chroma centered between them (default)
+    cosited, ///< [1 2 1] horizontally, chroma cosited with the even luma columns as in MPEG-2 and H.264
+    lanczos, ///< 7 tap horizontally and 6 tap vertically windowed sinc (Lanczos-2), cosited as @ref ChromaFilter::cosited
+    unrecognized, ///< Unrecognized chroma filter
+    last = unrecognized
+};
+
+///
+/// @brief SIMD instruction set tiers that @ref rgb2yuv::Converter can dispatch to
+///
+enum class SimdTier : std::uint32_t
+{
+    scalar = 0U, ///< Plain C++ without any SIMD intrinsics
+    sse4_1, ///< SSE4.1 (and SSSE3) 128bit kernels
+    avx2, ///< AVX2 256bit kernels
+    avx512, ///< AVX512F + AVX512BW 512bit kernels
+    last = avx512
+};
+
+///
+/// @brief Output formats of the statistics collected by @ref rgb2yuv::Stats
+///
+enum class StatsFormat : std::uint32_t
+{
+    text = 0U, ///< Single human readable summary line
+    json, ///< Single line JSON object
+    unrecognized, ///< Unrecognized statistics format
+    last = unrecognized
+};
+
+///
+/// @brief Returns a printable name for @p simdTier
+///
+/// @param[in] simdTier The @ref SimdTier to be converted
+///
+/// @returns Null terminated name of @p simdTier ("scalar", "sse4_1", "avx2" or "avx512")
+///
+const char *toString(const SimdTier simdTier) noexcept;
+
 ///
 /// @brief Input arguments specified by the client
 ///
@@ -70,8 +142,46 @@ struct InputArguments
     ColorFormat outputColorFormat; ///< The color format of image data to be written in @ref InputArguments::outputFile
     FileFormat inputFileFormat; ///< The file format of @ref InputArguments::inputFile
     FileFormat outputFileFormat; ///< The file format of @ref InputArguments::outputFile
+    ColorMatrix colorMatrix; ///< The matrix used for conversion by @ref rgb2yuv::Converter
+    std::uint32_t width; ///< Width in pixels of a @ref FileFormat::raw @ref InputArguments::inputFile
+    std::uint32_t height; ///< Height in pixels of a @ref FileFormat::raw @ref InputArguments::inputFile
     uint32_t numThreads; ///< The number of threads to be used for conversion by @ref rgb2yuv::Converter
     bool disableSimd; ///< Specifies if usage of SIMD extensions by @ref rgb2yuv::Converter should be disabled.
+    bool numaAware; ///< Specifies if worker threads should be pinned to cores of their NUMA node
+    bool hugePages; ///< Specifies if large frame buffers should be backed by prefaulted 2 MiB pages
+    bool sequence; ///< Specifies if @ref InputArguments::inputFile is a raw sequence of frames, converted incrementally
+    std::uint32_t pyramidLevels; ///< Number of resolution levels written, including full resolution. 0 or 1 for none
+    bool enableStats; ///< Specifies if per-stage statistics should be printed after the conversion
+    StatsFormat statsFormat; ///< The format in which statistics are printed if @ref InputArguments::enableStats is set
+    std::string cacheDir; ///< Directory of the conversion cache, empty if caching is disabled
+    std::uint64_t cacheSizeLimit; ///< Maximum size in bytes of the conversion cache in @ref InputArguments::cacheDir
+    AlphaMode alphaMode; ///< Handling of the alpha component of @ref ColorFormat::rgba8888 input
+    std::uint32_t background; ///< Background color 0xRRGGBB for @ref AlphaMode::composite
+    ChromaFilter chromaFilter; ///< Filter used to subsample chroma for 4:2:2 and 4:2:0 outputs
+    std::string batch; ///< Manifest file, or glob of input files, converted as a batch. Empty for a single conversion
+    std::string outputDir; ///< Directory of the outputs of a glob @ref InputArguments::batch
+    std::string metricsFile; ///< File the metrics are written to in the Prometheus text format, empty if not exported
+    bool autoTune; ///< Specifies if the number of threads, band height and store type are calibrated for the host
+    std::string tuneFile; ///< File caching the calibration of @ref InputArguments::autoTune, empty for the default
+};
+
+///
+/// @brief Output file and formats of one output of a conversion
+///
+struct OutputSpec
+{
+    std::string outputFile; ///< The output file to store the converted image data
+    ColorFormat outputColorFormat; ///< The color format of image data to be written in @ref OutputSpec::outputFile
+    FileFormat outputFileFormat; ///< The file format of @ref OutputSpec::outputFile
+};
+
+///
+/// @brief Input file of a batch conversion and every output written from it
+///
+struct BatchEntry
+{
+    std::string inputFile; ///< The input file containing image data to be converted
+    std::vector<OutputSpec> outputs; ///< Outputs written from a single decode of @ref BatchEntry::inputFile
 };
 
 ///
@@ -95,6 +205,9 @@ class InputParser
         ///    -# Input string: "yuv444_packed" - Return @ref ColorFormat::yuv444_packed
         ///    -# Input string: "yuv444_planar" - Return @ref ColorFormat::yuv444_planar
         ///    -# Input string: "yuyv" - Return @ref ColorFormat::yuyv
+        ///    -# Input string: "rgb161616" - Return @ref ColorFormat::rgb161616
+        ///    -# Input string: "yuv420_p010" - Return @ref ColorFormat::yuv420_p010
+        ///    -# Input string: "yuv420_p016" - Return @ref ColorFormat::yuv420_p016
         ///    -# Input string: None of the above - Return @ref ColorFormat::unrecognized
         ///
         /// @returns @ref ColorFormat converted from @p inputString
@@ -118,6 +231,114 @@ class InputParser
         ///
         static FileFormat toFileFormat(const std::string &inputString) noexcept;
 
+        ///
+        /// @brief Converts the input std::string to @ref StatsFormat
+        ///
+        /// @param[in] inputString String to be converted
+        ///
+        /// Design:
+        /// -# Perform the conversion as below:
+        ///    -# Input string: text - Return @ref StatsFormat::text
+        ///    -# Input string: json - Return @ref StatsFormat::json
+        ///    -# Input string: None of the above - Return @ref StatsFormat::unrecognized
+        ///
+        /// @returns @ref StatsFormat converted from @p inputString
+        ///
+        static StatsFormat toStatsFormat(const std::string &inputString) noexcept;
+
+        ///
+        /// @brief Converts the input std::string to @ref AlphaMode
+        ///
+        /// @param[in] inputString String to be converted
+        ///
+        /// Design:
+        /// -# Perform the conversion as below:
+        ///    -# Input string: drop - Return @ref AlphaMode::drop
+        ///    -# Input string: composite - Return @ref AlphaMode::composite
+        ///    -# Input string: plane - Return @ref AlphaMode::plane
+        ///    -# Input string: None of the above - Return @ref AlphaMode::unrecognized
+        ///
+        /// @returns @ref AlphaMode converted from @p inputString
+        ///
+        static AlphaMode toAlphaMode(const std::string &inputString) noexcept;
+
+        ///
+        /// @brief Converts the input std::string to @ref ChromaFilter
+        ///
+        /// @param[in] inputString String to be converted
+        ///
+        /// Design:
+        /// -# Perform the conversion as below:
+        ///    -# Input string: box - Return @ref ChromaFilter::box
+        ///    -# Input string: cosited - Return @ref ChromaFilter::cosited
+        ///    -# Input string: lanczos - Return @ref ChromaFilter::lanczos
+        ///    -# Input string: None of the above - Return @ref ChromaFilter::unrecognized
+        ///
+        /// @returns @ref ChromaFilter converted from @p inputString
+        ///
+        static ChromaFilter toChromaFilter(const std::string &inputString) noexcept;
+
+        ///
+        /// @brief Converts the input std::string to @ref ColorMatrix
+        ///
+        /// @param[in] inputString String to be converted
+        ///
+        /// Design:
+        /// -# Perform the conversion as below:
+        ///    -# Input string: bt601 - Return @ref ColorMatrix::bt601
+        ///    -# Input string: bt709 - Return @ref ColorMatrix::bt709
+        ///    -# Input string: bt601_full - Return @ref ColorMatrix::bt601_full
+        ///    -# Input string: None of the above - Return @ref ColorMatrix::unrecognized
+        ///
+        /// @returns @ref ColorMatrix converted from @p inputString
+        ///
+        static ColorMatrix toColorMatrix(const std::string &inputString) noexcept;
+
+        ///
+        /// @brief Checks if @p batch is a glob of input files rather than a manifest file
+        ///
+        /// Design: Return @true if @p batch contains '*' or '?'
+        ///
+        static bool isGlob(const std::string &batch) noexcept;
+
+        ///
+        /// @brief Matches the file name @p name against the wildcard @p pattern
+        ///
+        /// Design: '*' matches any sequence of characters, '?' any single character and every other character
+        ///         itself. Backtrack to the last '*' on a mismatch.
+        ///
+        /// @returns @true if @p pattern matches the whole of @p name, else @false
+        ///
+        static bool matchesGlob(const std::string &name, const std::string &pattern) noexcept;
+
+        ///
+        /// @brief Expands the glob @ref InputArguments::batch into one @ref BatchEntry per matching file
+        ///
+        /// @throws std::invalid_argument if the directory part of the glob contains wildcards or cannot be listed,
+        ///         or if no file matches
+        ///
+        /// Design:
+        /// -# List the regular files of the directory part of the glob whose name matches its file name part,
+        ///    with @ref InputParser::matchesGlob, sorted by name
+        /// -# Write every file to <@ref InputArguments::outputDir>/<stem><extension> in
+        ///    @ref InputArguments::outputColorFormat and @ref InputArguments::outputFileFormat, where the extension
+        ///    is .h for @ref FileFormat::c_header and .yuv otherwise
+        ///
+        static std::vector<BatchEntry> expandGlob(const utils::InputArguments &args);
+
+        ///
+        /// @brief Parses the manifest file @ref InputArguments::batch
+        ///
+        /// @throws std::invalid_argument if the manifest cannot be read, or if a line is malformed
+        ///
+        /// Design:
+        /// -# Skip empty lines and lines starting with '#'
+        /// -# Split every other line at whitespace into an input file followed by one or more triples of
+        ///    output file, output color format and output file format
+        /// -# Throw std::invalid_argument naming the line if a triple is incomplete or holds an unrecognized format
+        ///
+        static std::vector<BatchEntry> parseManifest(const utils::InputArguments &args);
+
         ///
         /// @brief Verifies the input @p args
         ///
@@ -133,9 +354,28 @@ class InputParser
         ///    -# @ref InputArguments::outputFile is not empty
         ///    -# @ref InputArguments::outputColorFormat is not @ref ColorFormat::unrecognized and @ref ColorFormat::unspecified
         ///    -# @ref InputArguments::outputFileFormat is not @ref FileFormat::unrecognized and @ref FileFormat::unspecified
+        ///    -# @ref InputArguments::width and @ref InputArguments::height are not 0 if
+        ///       @ref InputArguments::inputFileFormat is @ref FileFormat::raw
+        ///    -# @ref InputArguments::colorMatrix is not @ref ColorMatrix::unrecognized
+        ///    -# @ref InputArguments::inputFileFormat and @ref InputArguments::outputFileFormat are
+        ///       @ref FileFormat::raw if @ref InputArguments::sequence is set
+        ///    -# @ref InputArguments::pyramidLevels is above 1 only for @ref ColorFormat::yuv420_nv12 output, without
+        ///       @ref InputArguments::sequence and @ref InputArguments::cacheDir
+        ///    -# @ref InputArguments::statsFormat is not @ref StatsFormat::unrecognized
+        ///    -# @ref InputArguments::alphaMode is not @ref AlphaMode::unrecognized, and is @ref AlphaMode::drop unless
+        ///       @ref InputArguments::inputColorFormat is @ref ColorFormat::rgba8888
+        ///    -# @ref InputArguments::alphaMode is not @ref AlphaMode::plane if @ref InputArguments::pyramidLevels is above 1
+        ///    -# @ref InputArguments::background is at most 0xFFFFFF
+        ///    -# @ref InputArguments::chromaFilter is not @ref ChromaFilter::unrecognized, and is @ref ChromaFilter::box
+        ///       if @ref InputArguments::pyramidLevels is above 1
+        /// -# If @ref InputArguments::batch is set, the input and output files come from the batch instead:
+        ///    -# @ref InputArguments::inputFile and @ref InputArguments::outputFile are empty
+        ///    -# @ref InputArguments::sequence and @ref InputArguments::cacheDir are not set
+        ///    -# A glob batch requires @ref InputArguments::outputDir, a manifest ignores the output formats
+        ///    -# @ref InputArguments::autoTune is not set, batches run on the workers of @ref rgb2yuv::AsyncContext
         /// -# Else, throw std::invalid_argument exception
         ///
-        static void InputParser::verifyArgs(const utils::InputArguments &args);
+        static void verifyArgs(const utils::InputArguments &args);
 
         ///
         /// @brief Parse command line arguments and construct a @ref InputArguments object
@@ -171,18 +411,74 @@ class InputParser
         ///       -# Verify that a value for the argument is specified and store the argument
         ///          in @ref InputArguments::outputFileFormat
         ///          (Note: Use @ref InputParser::toFileFormat)
+        ///    -# Argument: -colorMatrix
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::colorMatrix
+        ///          (Note: Use @ref InputParser::toColorMatrix)
+        ///    -# Argument: -width
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::width
+        ///    -# Argument: -height
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::height
         ///    -# Argument: -j
         ///       -# Verify that a value for the argument is specified and store the argument
         ///          in @ref InputArguments::numThreads
         ///    -# Argument: -disableSimd
         ///       -# If specified, set @ref InputArguments::disableSimd to @true
+        ///    -# Argument: -numaAware
+        ///       -# If specified, set @ref InputArguments::numaAware to @true
+        ///    -# Argument: -hugePages
+        ///       -# If specified, set @ref InputArguments::hugePages to @true
+        ///    -# Argument: -sequence
+        ///       -# If specified, set @ref InputArguments::sequence to @true
+        ///    -# Argument: -pyramidLevels
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::pyramidLevels
+        ///    -# Argument: -stats
+        ///       -# If specified, set @ref InputArguments::enableStats to @true
+        ///    -# Argument: -statsFormat
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::statsFormat
+        ///          (Note: Use @ref InputParser::toStatsFormat)
+        ///    -# Argument: -cacheDir
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::cacheDir
+        ///    -# Argument: -cacheSize
+        ///       -# Verify that a value for the argument is specified and store the argument, converted
+        ///          from MiB to bytes, in @ref InputArguments::cacheSizeLimit
+        ///    -# Argument: -alpha
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::alphaMode
+        ///          (Note: Use @ref InputParser::toAlphaMode)
+        ///    -# Argument: -background
+        ///       -# Verify that a value for the argument is specified and store the argument, parsed as
+        ///          hexadecimal RRGGBB, in @ref InputArguments::background
+        ///    -# Argument: -chromaFilter
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::chromaFilter
+        ///          (Note: Use @ref InputParser::toChromaFilter)
+        ///    -# Argument: -batch
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::batch
+        ///    -# Argument: -outputDir
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::outputDir
+        ///    -# Argument: -metricsFile
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::metricsFile
+        ///    -# Argument: -autoTune
+        ///       -# If specified, set @ref InputArguments::autoTune to @true
+        ///    -# Argument: -tuneFile
+        ///       -# Verify that a value for the argument is specified and store the argument
+        ///          in @ref InputArguments::tuneFile
         ///    -# Argument: None of the above
         ///       -# Throw std::invalid_argument
         /// -# Construct and return a pair of @c parseError and the constructed @ref InputArguments
         ///
         /// @returns @ref utils::InputArguments containing verified input values
         ///
-        static utils::InputArguments InputParser::parseArgs(const std::int32_t argc, char **argv);
+        static utils::InputArguments parseArgs(const std::int32_t argc, char **argv);
 
         ///
         /// @brief Print a help message on stdout
@@ -214,7 +510,22 @@ class InputParser
         ///
         /// @returns @ref InputArguments containing the parsed and verified input arguments
         ///
-        static utils::InputArguments InputParser::parseAndVerifyArgs(int32_t argc, char **argv);
+        static utils::InputArguments parseAndVerifyArgs(int32_t argc, char **argv);
+
+        ///
+        /// @brief Lists the input files and outputs of the batch conversion described by @p args
+        ///
+        /// @param[in] args Arguments verified by @ref InputParser::parseAndVerifyArgs with
+        ///            @ref InputArguments::batch set
+        ///
+        /// @throws std::invalid_argument (Indirectly via @ref InputParser::expandGlob or @ref InputParser::parseManifest)
+        ///
+        /// Design: Invoke @ref InputParser::expandGlob if @ref InputParser::isGlob holds for
+        ///         @ref InputArguments::batch, else @ref InputParser::parseManifest
+        ///
+        /// @returns One @ref BatchEntry per input file, in the order they should be converted
+        ///
+        static std::vector<BatchEntry> parseBatch(const utils::InputArguments &args);
 };
 
 } // namespace utils
@@ -53,6 +53,24 @@ class utils_asm
     static void cpuId(const std::uint32_t inputEAX,
                       const std::uint32_t inputECX,
                       std::array<std::uint32_t , ct_numCpuIdRegisters> &out) noexcept;
+
+    ///
+    /// @brief Invokes the XGETBV assembly function with ECX set to 0 and returns the
+    ///        value of the XCR0 extended control register
+    ///
+    /// Note: Must only be invoked if CPUID leaf 1 reports OSXSAVE support
+    ///
+    /// @return Value of XCR0 (EDX:EAX)
+    ///
+    static std::uint64_t getXcr0() noexcept;
+
+    ///
+    /// @brief Invokes the RDTSC assembly function and returns the current value of the
+    ///        time stamp counter
+    ///
+    /// @return Value of the time stamp counter (EDX:EAX)
+    ///
+    static std::uint64_t readTsc() noexcept;
 };
 
 } // namespace rgb2yuv
@@ -18,16 +18,32 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cpuid.h>
+#include <x86intrin.h>
+
 #include "rgb2yuv_utils_asm.hpp"
 
 namespace rgb2yuv
 {
 
-inline void utils_asm::cpuId(const std::uint32_t inputEAX,
-                             const std::uint32_t inputECX,
-                             std::array<std::uint32_t, ct_numRegisters> &out) noexcept
+void utils_asm::cpuId(const std::uint32_t inputEAX,
+                      const std::uint32_t inputECX,
+                      std::array<std::uint32_t, ct_numCpuIdRegisters> &out) noexcept
+{
+    __cpuid_count(inputEAX, inputECX, out[ct_eax], out[ct_ebx], out[ct_ecx], out[ct_edx]);
+}
+
+std::uint64_t utils_asm::getXcr0() noexcept
+{
+    std::uint32_t eax { 0U };
+    std::uint32_t edx { 0U };
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0U));
+    return (static_cast<std::uint64_t>(edx) << 32U) | eax;
+}
+
+std::uint64_t utils_asm::readTsc() noexcept
 {
-    // TODO
+    return __rdtsc();
 }
 
 } // namespace rgb2yuv
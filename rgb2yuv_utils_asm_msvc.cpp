@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <immintrin.h>
 #include <intrin.h>
 
 #include "rgb2yuv_utils_asm.hpp"
@@ -37,4 +38,14 @@ void utils_asm::cpuId(const std::uint32_t inputEAX,
     }
 }
 
+std::uint64_t utils_asm::getXcr0() noexcept
+{
+    return _xgetbv(0U);
+}
+
+std::uint64_t utils_asm::readTsc() noexcept
+{
+    return __rdtsc();
+}
+
 } // namespace rgb2yuv